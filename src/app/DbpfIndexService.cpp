@@ -2,16 +2,58 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <functional>
+#include <limits>
 #include <ranges>
 #include <utility>
 
 #include "DBPFReader.h"
 #include "ParseTypes.h"
+#include "PluginIndexStore.hpp"
 
-DbpfIndexService::DbpfIndexService(PluginLocator locator) : locator_(std::move(locator)) {}
+namespace {
+    thread_local std::vector<DBPF::Tgi>* tRecordedDependencies = nullptr;
+}
+
+DbpfIndexService::DependencyScope::DependencyScope(std::vector<DBPF::Tgi>& out)
+    : out_(&out)
+    , previous_(tRecordedDependencies) {
+    tRecordedDependencies = &out;
+}
+
+DbpfIndexService::DependencyScope::~DependencyScope() {
+    tRecordedDependencies = previous_;
+    if (previous_) {
+        previous_->insert(previous_->end(), out_->begin(), out_->end());
+    }
+}
+
+auto DbpfIndexService::recordDependencies(const std::span<const DBPF::Tgi> tgis) -> void {
+    if (tRecordedDependencies) {
+        tRecordedDependencies->insert(tRecordedDependencies->end(), tgis.begin(), tgis.end());
+    }
+}
+
+DbpfIndexService::DbpfIndexService(PluginLocator locator, const size_t indexThreads,
+                                   const ReaderCacheLimits readerCacheLimits)
+    : locator_(std::move(locator))
+    , indexThreads_(indexThreads)
+    , readerCacheLimits_(readerCacheLimits) {}
 
 DbpfIndexService::~DbpfIndexService() { shutdown(); }
 
+void DbpfIndexService::setPreviousIndex(PluginIndex previous) {
+    std::unique_lock lock(mutex_);
+    previousFiles_.clear();
+    previousFiles_.reserve(previous.files.size());
+    for (auto& info : previous.files) {
+        auto key = info.filePath;
+        previousFiles_.insert_or_assign(std::move(key), PreviousFile{.info = std::move(info)});
+    }
+    hasPreviousIndex_ = true;
+}
+
 void DbpfIndexService::start() {
     if (running_) {
         return;
@@ -23,13 +65,25 @@ void DbpfIndexService::start() {
     processedFiles_ = 0;
     entriesIndexed_ = 0;
     errorCount_ = 0;
+    reusedFiles_ = 0;
+    bytesRead_ = 0;
 
     {
         std::unique_lock lock(mutex_);
         currentFile_.clear();
-        files_.clear();
-        tgiToFileIndices_.clear();
-        pathToIndex_.clear();
+        sealedIndex_.store(nullptr, std::memory_order_release);
+        sealedSnapshot_.reset();
+        readerSlots_.clear();
+    }
+    for (auto& shard : exemplarCache_) {
+        std::unique_lock shardLock(shard.mutex);
+        shard.exemplars.clear();
+    }
+    {
+        std::lock_guard cacheLock(readerCacheMutex_);
+        readerLru_.clear();
+        openReaderBytes_ = 0;
+        readerCacheStats_ = {};
     }
 
     running_ = true;
@@ -55,224 +109,557 @@ auto DbpfIndexService::snapshot() const -> ScanProgress {
         .processedFiles = processedFiles_,
         .entriesIndexed = entriesIndexed_,
         .errorCount = errorCount_,
+        .reusedFiles = reusedFiles_,
+        .bytesRead = bytesRead_,
         .currentFile = currentFile_,
         .done = done_
     };
 }
 
-auto DbpfIndexService::lookupFiles(const DBPF::Tgi& tgi) const -> std::vector<std::filesystem::path> {
+auto DbpfIndexService::indexSnapshot() const -> std::shared_ptr<const IndexSnapshot> {
     std::shared_lock lock(mutex_);
-    auto it = tgiToFileIndices_.find(tgi);
-    if (it == tgiToFileIndices_.end()) {
-        return {};
-    }
-    std::vector<std::filesystem::path> result;
-    result.reserve(it->second.size());
-    for (const auto idx : it->second) {
-        result.push_back(files_[idx]);
-    }
-    return result;
+    return sealedSnapshot_;
+}
+
+auto DbpfIndexService::sealed_() const -> const IndexSnapshot* {
+    return sealedIndex_.load(std::memory_order_acquire);
+}
+
+auto DbpfIndexService::lookupFiles(const DBPF::Tgi& tgi) const -> std::span<const uint32_t> {
+    recordDependency_(tgi);
+    const auto* index = sealed_();
+    return index ? index->tgiIndex.find(tgi) : std::span<const uint32_t>{};
 }
 
 auto DbpfIndexService::containsTgi(const DBPF::Tgi& tgi) const -> bool {
-    std::shared_lock lock(mutex_);
-    return tgiToFileIndices_.contains(tgi);
+    recordDependency_(tgi);
+    const auto* index = sealed_();
+    return index && index->tgiIndex.contains(tgi);
+}
+
+auto DbpfIndexService::winningFile(const DBPF::Tgi& tgi) const -> std::optional<uint32_t> {
+    recordDependency_(tgi);
+    const auto* index = sealed_();
+    return index ? index->tgiIndex.winner(tgi) : std::nullopt;
 }
 
 auto DbpfIndexService::typeIndex() const -> const std::unordered_map<uint32_t, std::vector<DBPF::Tgi>>& {
-    std::shared_lock lock(mutex_);
-    return typeToTgis_;
+    static const std::unordered_map<uint32_t, std::vector<DBPF::Tgi>> kEmpty;
+    const auto* index = sealed_();
+    return index ? index->typeToTgis : kEmpty;
 }
 
 auto DbpfIndexService::typeIndex(const uint32_t type) const -> std::span<const DBPF::Tgi> {
-    std::shared_lock lock(mutex_);
-    auto it = typeToTgis_.find(type);
-    if (it != typeToTgis_.end()) {
+    const auto* index = sealed_();
+    if (!index) {
+        return {};
+    }
+    auto it = index->typeToTgis.find(type);
+    if (it != index->typeToTgis.end()) {
         return it->second;
     }
     return {};
 }
 
 auto DbpfIndexService::dbpfFiles() const -> const std::vector<std::filesystem::path>& {
-    return files_;
+    static const std::vector<std::filesystem::path> kEmpty;
+    const auto* index = sealed_();
+    return index ? index->files : kEmpty;
+}
+
+auto DbpfIndexService::filePath(const uint32_t fileIndex) const -> const std::filesystem::path& {
+    return sealed_()->files[fileIndex];
 }
 
 auto DbpfIndexService::pluginLocator() const -> const PluginLocator& {
     return locator_;
 }
 
+auto DbpfIndexService::exportIndex() const -> PluginIndex {
+    PluginIndex index;
+    index.version = kPluginIndexVersion;
+    index.buildTime = CurrentIndexTimestamp();
+    index.pluginsDirectory = PluginPathKey(locator_.config().userPluginsRoot);
+    const auto* sealed = sealed_();
+    if (!sealed) {
+        return index;
+    }
+    index.files.reserve(sealed->fileInfos.size());
+    for (const auto& info : sealed->fileInfos) {
+        // Files that could not be stat'ed have no entry and are re-read next time
+        if (!info.filePath.empty()) {
+            index.files.push_back(info);
+        }
+    }
+    return index;
+}
+
+auto DbpfIndexService::fileInfo(const std::filesystem::path& filePath) const -> const PluginFileInfo* {
+    const auto* index = sealed_();
+    if (!index) {
+        return nullptr;
+    }
+    const auto it = index->pathToIndex.find(filePath);
+    if (it == index->pathToIndex.end() || index->fileInfos[it->second].filePath.empty()) {
+        return nullptr;
+    }
+    return &index->fileInfos[it->second];
+}
+
+auto DbpfIndexService::changedTgis() const -> const std::unordered_set<DBPF::Tgi, DBPF::TgiHash>* {
+    const auto* index = sealed_();
+    return index && index->hasPreviousIndex ? &index->changedTgis : nullptr;
+}
+
 ParseExpected<const Exemplar::Record*> DbpfIndexService::loadExemplar(const DBPF::Tgi& tgi) const {
-    // Check cache first (with read lock)
+    recordDependency_(tgi);
+
+    // Check cache first (with read lock on this TGI's shard)
+    auto& shard = exemplarCache_[DBPF::TgiHash{}(tgi) % kExemplarCacheShards];
     {
-        std::shared_lock readLock(mutex_);
-        auto cacheIt = exemplarCache_.find(tgi);
-        if (cacheIt != exemplarCache_.end()) {
+        std::shared_lock readLock(shard.mutex);
+        auto cacheIt = shard.exemplars.find(tgi);
+        if (cacheIt != shard.exemplars.end()) {
             return &cacheIt->second;
         }
     }
 
-    // Not in cache - need to load it
-    // Find which file(s) contain this TGI, resolve indices to paths
-    std::vector<std::filesystem::path> filePaths;
-    {
-        std::shared_lock readLock(mutex_);
-        auto tgiIt = tgiToFileIndices_.find(tgi);
-        if (tgiIt == tgiToFileIndices_.end() || tgiIt->second.empty()) {
-            return Fail("TGI not found in index");
-        }
-        filePaths.reserve(tgiIt->second.size());
-        for (const auto idx : tgiIt->second) {
-            filePaths.push_back(files_[idx]);
-        }
+    // Not in cache - load it from the file that wins in load order, as the game does
+    const auto* index = sealed_();
+    const auto fileIndex = index ? index->tgiIndex.winner(tgi) : std::nullopt;
+    if (!fileIndex) {
+        return Fail("TGI not found in index");
     }
 
-    // Try to load from the last file that has it
-    for (const auto& filePath : std::ranges::reverse_view(filePaths)) {
-        auto* reader = getReader(filePath);
-        if (!reader) {
-            continue;
-        }
+    const auto reader = getReader(*fileIndex);
+    if (!reader) {
+        return Fail("Failed to open the file containing the exemplar");
+    }
 
-        auto exemplar = reader->LoadExemplar(tgi);
-        if (exemplar.has_value()) {
-            // Insert into cache and return pointer to cached version
-            std::unique_lock writeLock(mutex_);
-            auto [it, inserted] = exemplarCache_.try_emplace(tgi, std::move(*exemplar));
-            return &it->second;
-        }
+    auto exemplar = reader->LoadExemplar(tgi);
+    if (!exemplar.has_value()) {
+        return Fail("Failed to load exemplar");
     }
 
-    return Fail("Failed to load exemplar from any file");
+    // Insert into cache and return pointer to cached version
+    std::unique_lock writeLock(shard.mutex);
+    auto [it, inserted] = shard.exemplars.try_emplace(tgi, std::move(*exemplar));
+    return &it->second;
 }
 
 std::optional<std::vector<uint8_t>> DbpfIndexService::loadEntryData(const DBPF::Tgi& tgi) const {
-    // Find which file(s) contain this TGI, resolve indices to paths
-    std::vector<std::filesystem::path> filePaths;
-    {
-        std::shared_lock readLock(mutex_);
-        auto tgiIt = tgiToFileIndices_.find(tgi);
-        if (tgiIt == tgiToFileIndices_.end() || tgiIt->second.empty()) {
-            return std::nullopt;
+    recordDependency_(tgi);
+
+    // Read it from the file that wins in load order
+    const auto* index = sealed_();
+    const auto fileIndex = index ? index->tgiIndex.winner(tgi) : std::nullopt;
+    if (!fileIndex) {
+        return std::nullopt;
+    }
+
+    const auto reader = getReader(*fileIndex);
+    if (!reader) {
+        return std::nullopt;
+    }
+
+    auto data = reader->ReadEntryData(tgi);
+    if (data.has_value()) {
+        return data;
+    }
+    return std::nullopt;
+}
+
+std::shared_ptr<DBPF::Reader> DbpfIndexService::getReader(const std::filesystem::path& filePath) const {
+    // Reader slots are allocated before the snapshot is published, so they are safe to read once it is
+    ReaderSlot* slot = nullptr;
+    uint32_t fileIndex = 0;
+    if (const auto* index = sealed_()) {
+        if (const auto it = index->pathToIndex.find(filePath); it != index->pathToIndex.end()) {
+            fileIndex = it->second;
+            slot = readerSlots_[fileIndex].get();
         }
-        filePaths.reserve(tgiIt->second.size());
-        for (const auto idx : tgiIt->second) {
-            filePaths.push_back(files_[idx]);
+    }
+
+    if (!slot) {
+        // Not an indexed file, open it without caching
+        auto reader = std::make_shared<DBPF::Reader>();
+        if (!reader->LoadFile(filePath)) {
+            return nullptr;
         }
+        return reader;
     }
 
-    // Try to load from the last file that has it
-    for (const auto& filePath : std::ranges::reverse_view(filePaths)) {
-        const auto* reader = getReader(filePath);
-        if (!reader) {
-            continue;
+    return getIndexedReader_(fileIndex, *slot, filePath);
+}
+
+std::shared_ptr<DBPF::Reader> DbpfIndexService::getReader(const uint32_t fileIndex) const {
+    const auto* index = sealed_();
+    if (!index || fileIndex >= index->files.size()) {
+        return nullptr;
+    }
+    return getIndexedReader_(fileIndex, *readerSlots_[fileIndex], index->files[fileIndex]);
+}
+
+std::shared_ptr<DBPF::Reader> DbpfIndexService::getIndexedReader_(const uint32_t fileIndex,
+                                                                  ReaderSlot& slot,
+                                                                  const std::filesystem::path& filePath) const {
+    {
+        std::lock_guard cacheLock(readerCacheMutex_);
+        if (auto reader = touchReader_(fileIndex)) {
+            return reader;
         }
+    }
 
-        auto data = reader->ReadEntryData(tgi);
-        if (data.has_value()) {
-            return data;
+    // Only one thread opens a given file; others wait here and then find it in the cache
+    std::lock_guard openLock(slot.openMutex);
+    {
+        std::lock_guard cacheLock(readerCacheMutex_);
+        if (auto reader = touchReader_(fileIndex)) {
+            return reader;
         }
     }
+    if (slot.failed) {
+        return nullptr;
+    }
 
-    return std::nullopt;
+    auto reader = std::make_shared<DBPF::Reader>();
+    if (!reader->LoadFile(filePath)) {
+        slot.failed = true;
+        return nullptr;
+    }
+
+    const auto bytes = fileBytes_(fileIndex);
+    std::lock_guard cacheLock(readerCacheMutex_);
+    ++readerCacheStats_.misses;
+    readerCacheStats_.bytesOpened += bytes;
+    cacheReader_(fileIndex, reader, bytes);
+    return reader;
 }
 
-DBPF::Reader* DbpfIndexService::getReader(const std::filesystem::path& filePath) const {
-    std::unique_lock lock(mutex_);
+auto DbpfIndexService::readerCacheStats() const -> ReaderCacheStats {
+    std::lock_guard cacheLock(readerCacheMutex_);
+    auto stats = readerCacheStats_;
+    stats.openReaders = readerLru_.size();
+    stats.openBytes = openReaderBytes_;
+    return stats;
+}
 
-    // Check if we already have a reader for this file
-    auto it = readerCache_.find(filePath);
-    if (it != readerCache_.end()) {
-        return it->second.get();
+auto DbpfIndexService::fileBytes_(const uint32_t fileIndex) const -> uint64_t {
+    const auto* index = sealed_();
+    if (!index) {
+        return 0;
     }
+    if (!index->fileInfos[fileIndex].filePath.empty()) {
+        return index->fileInfos[fileIndex].fileSize;
+    }
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(index->files[fileIndex], ec);
+    return ec ? 0 : static_cast<uint64_t>(size);
+}
 
-    // Create a new reader and load the file
-    auto reader = std::make_unique<DBPF::Reader>();
-    if (!reader->LoadFile(filePath)) {
+auto DbpfIndexService::touchReader_(const uint32_t fileIndex) const -> std::shared_ptr<DBPF::Reader> {
+    auto& slot = *readerSlots_[fileIndex];
+    if (!slot.reader) {
         return nullptr;
     }
+    readerLru_.splice(readerLru_.begin(), readerLru_, slot.lruPos);
+    ++readerCacheStats_.hits;
+    return slot.reader;
+}
 
-    // Cache it and return
-    auto* readerPtr = reader.get();
-    readerCache_[filePath] = std::move(reader);
-    return readerPtr;
+auto DbpfIndexService::cacheReader_(const uint32_t fileIndex, std::shared_ptr<DBPF::Reader> reader,
+                                    const uint64_t bytes) const -> void {
+    auto& slot = *readerSlots_[fileIndex];
+    slot.reader = std::move(reader);
+    slot.bytes = bytes;
+    readerLru_.push_front(fileIndex);
+    slot.lruPos = readerLru_.begin();
+    openReaderBytes_ += bytes;
+    readerCacheStats_.peakOpenBytes = std::max(readerCacheStats_.peakOpenBytes, openReaderBytes_);
+
+    // The reader just added is at the front and always stays, even if it alone exceeds the budget.
+    // Evicted readers are only dropped from the cache; callers still holding them keep them alive.
+    const size_t maxReaders = std::max<size_t>(1, readerCacheLimits_.maxReaders);
+    while (readerLru_.size() > 1
+        && (readerLru_.size() > maxReaders || openReaderBytes_ > readerCacheLimits_.maxBytes)) {
+        auto& victim = *readerSlots_[readerLru_.back()];
+        readerLru_.pop_back();
+        victim.reader.reset();
+        openReaderBytes_ -= victim.bytes;
+        victim.bytes = 0;
+        ++readerCacheStats_.evictions;
+    }
 }
 
 void DbpfIndexService::worker_() {
     try {
         const auto pluginFiles = locator_.ListDbpfFiles();
 
-        {
-            std::unique_lock lock(mutex_);
-            files_ = pluginFiles;
-            totalFiles_ = pluginFiles.size();
-            for (uint32_t i = 0; i < pluginFiles.size(); ++i) {
-                pathToIndex_[pluginFiles[i]] = i;
+        totalFiles_ = pluginFiles.size();
+
+        size_t threadCount = indexThreads_ > 0 ? indexThreads_ : std::thread::hardware_concurrency();
+        threadCount = std::clamp<size_t>(threadCount, 1, std::max<size_t>(1, pluginFiles.size()));
+
+        // Each worker pulls the next unclaimed file and indexes it into its own shard, so the
+        // only shared state touched while indexing is the progress counters.
+        std::atomic<size_t> nextFile{0};
+        RetainedReaders retained;
+        std::vector<IndexShard> shards(threadCount);
+        if (threadCount == 1) {
+            indexFiles_(pluginFiles, nextFile, retained, shards.front());
+        }
+        else {
+            std::vector<std::thread> workers;
+            workers.reserve(threadCount);
+            for (auto& shard : shards) {
+                workers.emplace_back([this, &pluginFiles, &nextFile, &retained, &shard] {
+                    indexFiles_(pluginFiles, nextFile, retained, shard);
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
             }
         }
 
-        for (const auto& filePath : pluginFiles) {
-            if (stop_) {
-                break;
-            }
+        mergeShards_(pluginFiles, shards);
 
-            {
-                std::unique_lock lock(mutex_);
-                currentFile_ = filePath.filename().string();
-            }
+        {
+            std::unique_lock lock(mutex_);
+            previousFiles_.clear();
+            done_ = true;
+            currentFile_.clear();
+        }
 
-            try {
-                auto reader = std::make_unique<DBPF::Reader>();
-                if (!reader->LoadFile(filePath)) {
-                    spdlog::warn("Failed to load {}, not a DBPF file?", filePath.string());
-                    ++errorCount_;
-                    ++processedFiles_;
-                    continue;
-                }
+    } catch (const std::exception& error) {
+        spdlog::error("Indexing plugins failed: {}", error.what());
+        ++errorCount_;
+
+        // Lookups expect a sealed index once the scan is done, so publish an empty one if none was
+        std::unique_lock lock(mutex_);
+        if (!sealedSnapshot_) {
+            auto empty = std::make_shared<IndexSnapshot>();
+            empty->hasPreviousIndex = hasPreviousIndex_;
+            sealedSnapshot_ = std::move(empty);
+            sealedIndex_.store(sealedSnapshot_.get(), std::memory_order_release);
+        }
+        done_ = true;
+        currentFile_.clear();
+    }
+}
 
-                const auto& index = reader->GetIndex();
+void DbpfIndexService::indexFiles_(const std::vector<std::filesystem::path>& pluginFiles,
+                                   std::atomic<size_t>& nextFile,
+                                   RetainedReaders& retained,
+                                   IndexShard& shard) {
+    while (!stop_) {
+        const size_t fileIdx = nextFile.fetch_add(1);
+        if (fileIdx >= pluginFiles.size()) {
+            break;
+        }
 
-                // Accumulate entries locally, then merge under a single lock
-                std::unordered_map<uint32_t, std::vector<DBPF::Tgi>> localTypeToTgis;
-                std::vector<DBPF::Tgi> localTgis;
-                localTgis.reserve(index.size());
+        const auto& filePath = pluginFiles[fileIdx];
+        {
+            std::unique_lock lock(mutex_);
+            currentFile_ = filePath.filename().string();
+        }
 
-                for (const auto& entry : index) {
-                    if (stop_) break;
-                    localTypeToTgis[entry.tgi.type].push_back(entry.tgi);
-                    localTgis.push_back(entry.tgi);
+        try {
+            IndexShard::FileEntries entries;
+            entries.fileIndex = static_cast<uint32_t>(fileIdx);
+
+            const auto stamp = StatPluginFile(filePath);
+            if (stamp) {
+                entries.info.filePath = PluginPathKey(filePath);
+                entries.info.fileSize = stamp->fileSize;
+                entries.info.lastWriteTicks = stamp->lastWriteTicks;
+
+                // previousFiles_ is not resized while workers run and each file is claimed by one
+                // worker, so moving the matching entry out does not race with other lookups.
+                const auto previousIt = previousFiles_.find(entries.info.filePath);
+                if (previousIt != previousFiles_.end()
+                    && previousIt->second.info.fileSize == stamp->fileSize
+                    && previousIt->second.info.lastWriteTicks == stamp->lastWriteTicks) {
+                    entries.info = std::move(previousIt->second.info);
+                    previousIt->second.reused = true;
+                    entries.reused = true;
+                    entriesIndexed_ += entries.info.tgis.size() / 3;
+                    shard.files.push_back(std::move(entries));
+                    ++reusedFiles_;
+                    ++processedFiles_;
+                    continue;
                 }
 
-                {
-                    std::unique_lock lock(mutex_);
-                    for (auto& [type, tgis] : localTypeToTgis) {
-                        auto& dest = typeToTgis_[type];
-                        dest.insert(dest.end(), tgis.begin(), tgis.end());
-                    }
-                    auto fileIdx = pathToIndex_.at(filePath);
-                    for (const auto& tgi : localTgis) {
-                        tgiToFileIndices_[tgi].push_back(fileIdx);
-                    }
-                    readerCache_[filePath] = std::move(reader);
-                    entriesIndexed_ += localTgis.size();
-                    ++processedFiles_;
+                std::error_code ec;
+                const auto writeTime = std::filesystem::last_write_time(filePath, ec);
+                if (!ec) {
+                    entries.info.lastModified = ToIndexTimestamp(writeTime);
                 }
+            }
 
-            } catch ([[maybe_unused]] const std::exception& error) {
-                spdlog::error("Error loading {}", currentFile_);
+            auto reader = std::make_unique<DBPF::Reader>();
+            if (!reader->LoadFile(filePath)) {
+                spdlog::warn("Failed to load {}, not a DBPF file?", filePath.string());
                 ++errorCount_;
                 ++processedFiles_;
+                // Still recorded so an unchanged non-DBPF file does not force a rescan every run
+                shard.files.push_back(std::move(entries));
+                continue;
+            }
+
+            const auto& index = reader->GetIndex();
+
+            // Copied whole even when stopping: a partial list saved under the file's stamp would be reused
+            // as if it were complete on the next run
+            entries.info.tgis.reserve(index.size() * 3);
+            for (const auto& entry : index) {
+                entries.info.tgis.push_back(entry.tgi.type);
+                entries.info.tgis.push_back(entry.tgi.group);
+                entries.info.tgis.push_back(entry.tgi.instance);
             }
+            entries.info.resourceCount = static_cast<uint32_t>(entries.info.tgis.size() / 3);
+
+            entriesIndexed_ += entries.info.resourceCount;
+            bytesRead_ += stamp ? stamp->fileSize : 0;
+            // Keep the reader for the parse pass only while the cache budget allows, so indexing a
+            // large install does not hold every file open at once
+            if (retainIndexReader_(retained, stamp ? stamp->fileSize : 0)) {
+                entries.reader = std::move(reader);
+            }
+            shard.files.push_back(std::move(entries));
+            ++processedFiles_;
+
+        } catch ([[maybe_unused]] const std::exception& error) {
+            spdlog::error("Error loading {}", filePath.filename().string());
+            ++errorCount_;
+            ++processedFiles_;
         }
+    }
+}
 
-        {
-            std::unique_lock lock(mutex_);
-            done_ = true;
-            currentFile_.clear();
+auto DbpfIndexService::retainIndexReader_(RetainedReaders& retained, const uint64_t bytes) const -> bool {
+    if (retained.count.fetch_add(1) >= readerCacheLimits_.maxReaders) {
+        retained.count.fetch_sub(1);
+        return false;
+    }
+    if (retained.bytes.fetch_add(bytes) + bytes > readerCacheLimits_.maxBytes) {
+        retained.bytes.fetch_sub(bytes);
+        retained.count.fetch_sub(1);
+        return false;
+    }
+    return true;
+}
+
+void DbpfIndexService::mergeShards_(const std::vector<std::filesystem::path>& pluginFiles,
+                                   std::vector<IndexShard>& shards) {
+    // Locate every indexed file's entries, then replay them in the original load order so the
+    // resulting indices are identical regardless of how files were distributed over the workers.
+    constexpr auto kNotIndexed = std::numeric_limits<size_t>::max();
+    std::vector<std::pair<size_t, size_t>> fileSlots(pluginFiles.size(), {kNotIndexed, 0});
+    for (size_t shardIdx = 0; shardIdx < shards.size(); ++shardIdx) {
+        const auto& shardFiles = shards[shardIdx].files;
+        for (size_t pos = 0; pos < shardFiles.size(); ++pos) {
+            fileSlots[shardFiles[pos].fileIndex] = {shardIdx, pos};
         }
+    }
 
-    } catch (const std::exception& error) {
-        ++errorCount_;
-        done_ = true;
+    struct RetainedReader {
+        uint32_t fileIndex;
+        std::unique_ptr<DBPF::Reader> reader;
+        uint64_t bytes;
+    };
+    std::vector<RetainedReader> retainedReaders;
+
+    size_t entryCount = 0;
+    for (const auto& shard : shards) {
+        for (const auto& entries : shard.files) {
+            entryCount += entries.info.tgis.size() / 3;
+        }
+    }
+    std::vector<TgiIndex::Entry> tgiEntries;
+    tgiEntries.reserve(entryCount);
+
+    // Built without holding any lock; nothing reads it until it is published below
+    auto index = std::make_shared<IndexSnapshot>();
+    index->files = pluginFiles;
+    index->pathToIndex.reserve(pluginFiles.size());
+    for (uint32_t i = 0; i < pluginFiles.size(); ++i) {
+        index->pathToIndex.emplace(pluginFiles[i], i);
+    }
+    index->fileInfos.assign(pluginFiles.size(), PluginFileInfo{});
+    index->hasPreviousIndex = hasPreviousIndex_;
+
+    for (const auto& [shardIdx, pos] : fileSlots) {
+        if (shardIdx == kNotIndexed) {
+            continue;
+        }
+
+        auto& entries = shards[shardIdx].files[pos];
+        const auto& flatTgis = entries.info.tgis;
+        for (size_t i = 0; i + 2 < flatTgis.size(); i += 3) {
+            const DBPF::Tgi tgi{flatTgis[i], flatTgis[i + 1], flatTgis[i + 2]};
+            index->typeToTgis[tgi.type].push_back(tgi);
+            tgiEntries.push_back({tgi, entries.fileIndex});
+        }
+        if (entries.reader) {
+            retainedReaders.push_back({entries.fileIndex, std::move(entries.reader), entries.info.fileSize});
+        }
+        if (hasPreviousIndex_ && !entries.reused) {
+            for (size_t i = 0; i + 2 < flatTgis.size(); i += 3) {
+                index->changedTgis.insert(DBPF::Tgi{flatTgis[i], flatTgis[i + 1], flatTgis[i + 2]});
+            }
+        }
+        index->fileInfos[entries.fileIndex] = std::move(entries.info);
+    }
+    index->tgiIndex.build(tgiEntries);
+
+    // Overrides: the last file in load order wins, as in the game
+    std::vector<size_t> overridesWon(pluginFiles.size(), 0);
+    index->tgiIndex.forEach([&](const DBPF::Tgi&, const std::span<const uint32_t> fileIndices) {
+        if (fileIndices.size() > 1) {
+            ++index->overriddenTgis;
+            ++overridesWon[fileIndices.back()];
+        }
+    });
+    for (uint32_t i = 0; i < overridesWon.size(); ++i) {
+        if (overridesWon[i] > 0) {
+            index->overridesByFile.emplace_back(i, overridesWon[i]);
+        }
+    }
+    std::ranges::stable_sort(index->overridesByFile, std::greater{}, &std::pair<uint32_t, size_t>::second);
+
+    // Entries of changed or removed files may have resolved differently before, so they count as
+    // changed too
+    for (const auto& previous : previousFiles_ | std::views::values) {
+        if (previous.reused) {
+            continue;
+        }
+        const auto& flatTgis = previous.info.tgis;
+        for (size_t i = 0; i + 2 < flatTgis.size(); i += 3) {
+            index->changedTgis.insert(DBPF::Tgi{flatTgis[i], flatTgis[i + 1], flatTgis[i + 2]});
+        }
+    }
+
+    readerSlots_.reserve(pluginFiles.size());
+    for (size_t i = 0; i < pluginFiles.size(); ++i) {
+        readerSlots_.push_back(std::make_unique<ReaderSlot>());
+    }
+
+    // Seal: from here on the index is only read, through sealedIndex_ without taking mutex_
+    {
+        std::unique_lock lock(mutex_);
+        sealedSnapshot_ = index;
+        sealedIndex_.store(sealedSnapshot_.get(), std::memory_order_release);
+    }
+
+    std::lock_guard cacheLock(readerCacheMutex_);
+    for (auto& [fileIndex, reader, bytes] : retainedReaders) {
+        cacheReader_(fileIndex, std::move(reader), bytes);
+    }
+}
+
+void DbpfIndexService::recordDependency_(const DBPF::Tgi& tgi) {
+    if (tRecordedDependencies) {
+        tRecordedDependencies->push_back(tgi);
     }
 }
 
@@ -1,62 +1,180 @@
 #pragma once
+#include <array>
 #include <atomic>
 #include <filesystem>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
 #include <span>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "DBPFReader.h"
 #include "ExemplarReader.h"
 #include "PluginLocator.hpp"
 #include "TGI.h"
+#include "TgiIndex.hpp"
+#include "../shared/index.hpp"
 
 struct ScanProgress {
     size_t totalFiles = 0;
     size_t processedFiles = 0;
     size_t entriesIndexed = 0;
     size_t errorCount = 0;
+    size_t reusedFiles = 0;
+    uint64_t bytesRead = 0;     // Size of the files opened to index them
     std::string currentFile;
     bool done = false;
 };
 
+// Bounds on the DBPF readers kept open between lookups. Readers are evicted least recently used
+// first once either limit is exceeded; the file size stands in for a reader's memory footprint.
+struct ReaderCacheLimits {
+    size_t maxReaders = 256;
+    uint64_t maxBytes = 512ull * 1024 * 1024;
+};
+
+struct ReaderCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t openReaders = 0;
+    uint64_t openBytes = 0;
+    uint64_t peakOpenBytes = 0;
+    uint64_t bytesOpened = 0;   // Total size of the files opened on misses
+};
+
+// Immutable result of a completed scan. Published once all files are indexed and never modified
+// afterwards, so any number of threads can read it without locking.
+struct IndexSnapshot {
+    std::vector<std::filesystem::path> files;                       // In load order
+    std::unordered_map<std::filesystem::path, uint32_t> pathToIndex;
+    TgiIndex tgiIndex;
+    std::unordered_map<uint32_t, std::vector<DBPF::Tgi>> typeToTgis;
+    std::vector<PluginFileInfo> fileInfos;                          // Empty filePath if not inspectable
+    bool hasPreviousIndex = false;
+    std::unordered_set<DBPF::Tgi, DBPF::TgiHash> changedTgis;
+    // TGIs present in more than one file, and for each file how many of those it wins, most first
+    size_t overriddenTgis = 0;
+    std::vector<std::pair<uint32_t, size_t>> overridesByFile;
+};
+
 class DbpfIndexService {
 public:
-    explicit DbpfIndexService(PluginLocator  locator);
+    // While alive, every TGI looked up through a DbpfIndexService on the current thread is appended
+    // to the given vector. Used to find out which entries a parse result depends on. Nested scopes
+    // also pass what they recorded on to the enclosing scope.
+    class DependencyScope {
+    public:
+        explicit DependencyScope(std::vector<DBPF::Tgi>& out);
+        ~DependencyScope();
+        DependencyScope(const DependencyScope&) = delete;
+        DependencyScope& operator=(const DependencyScope&) = delete;
+
+    private:
+        std::vector<DBPF::Tgi>* out_;
+        std::vector<DBPF::Tgi>* previous_;
+    };
+
+    // Adds lookups to the active DependencyScope, for callers that memoise results of their own
+    static auto recordDependencies(std::span<const DBPF::Tgi> tgis) -> void;
+
+    // indexThreads == 0 picks one worker per hardware thread
+    explicit DbpfIndexService(PluginLocator locator, size_t indexThreads = 0,
+                              ReaderCacheLimits readerCacheLimits = {});
     ~DbpfIndexService();
 
+    // Files recorded in this index whose size and write time are unchanged are not re-read by the
+    // next start(); their entries are taken from the index and readers are opened on demand.
+    auto setPreviousIndex(PluginIndex previous) -> void;
     auto start() -> void;
     auto shutdown() -> void;
 
     [[nodiscard]] auto isRunning() const -> bool;
     [[nodiscard]] auto snapshot() const -> ScanProgress;
-    // Look up file paths that contain a given TGI
-    [[nodiscard]] auto lookupFiles(const DBPF::Tgi& tgi) const -> std::vector<std::filesystem::path>;
+    // The sealed index, or nullptr while scanning. Index lookups below read it without locks; until
+    // it is published they find nothing. Results stay valid until the next start().
+    [[nodiscard]] auto indexSnapshot() const -> std::shared_ptr<const IndexSnapshot>;
+    // Indices into dbpfFiles() of the files that contain a given TGI, in load order. Does not allocate;
+    // the span stays valid until the next start().
+    [[nodiscard]] auto lookupFiles(const DBPF::Tgi& tgi) const -> std::span<const uint32_t>;
     [[nodiscard]] auto containsTgi(const DBPF::Tgi& tgi) const -> bool;
+    // Index into dbpfFiles() of the file whose copy of a TGI the game uses (the last in load order)
+    [[nodiscard]] auto winningFile(const DBPF::Tgi& tgi) const -> std::optional<uint32_t>;
     auto typeIndex() const -> const std::unordered_map<uint32_t, std::vector<DBPF::Tgi>>&;
     [[nodiscard]] auto typeIndex(uint32_t type) const -> std::span<const DBPF::Tgi>;
     [[nodiscard]] auto dbpfFiles() const -> const std::vector<std::filesystem::path>&;
+    [[nodiscard]] auto filePath(uint32_t fileIndex) const -> const std::filesystem::path&;
     [[nodiscard]] auto pluginLocator() const -> const PluginLocator&;
+    // Per-file entries of the completed scan, in load order, for persisting with SavePluginIndex
+    [[nodiscard]] auto exportIndex() const -> PluginIndex;
+    // Recorded size/write time of a scanned file, or nullptr if it could not be inspected
+    [[nodiscard]] auto fileInfo(const std::filesystem::path& filePath) const -> const PluginFileInfo*;
+    // Entries of every file that was added, changed or removed relative to the previous index.
+    // Returns nullptr when the scan was not given a previous index to compare against.
+    [[nodiscard]] auto changedTgis() const -> const std::unordered_set<DBPF::Tgi, DBPF::TgiHash>*;
 
     // Load an exemplar by TGI using cached readers
-    // Returns a pointer to the cached exemplar (stays valid until shutdown)
+    // Returns a pointer to the cached exemplar (stays valid until the next start())
     [[nodiscard]] auto loadExemplar(const DBPF::Tgi& tgi) const -> ParseExpected<const Exemplar::Record*>;
 
     // Load raw entry data by TGI using cached readers
     [[nodiscard]] auto loadEntryData(const DBPF::Tgi& tgi) const -> std::optional<std::vector<uint8_t>>;
 
-    // Get or create a cached reader for a specific file
-    [[nodiscard]] auto getReader(const std::filesystem::path& filePath) const -> DBPF::Reader*;
+    // Get or create a cached reader for a specific file. The returned reader stays usable after it
+    // is evicted from the cache; files are opened outside the index lock, at most once at a time.
+    [[nodiscard]] auto getReader(const std::filesystem::path& filePath) const -> std::shared_ptr<DBPF::Reader>;
+    [[nodiscard]] auto getReader(uint32_t fileIndex) const -> std::shared_ptr<DBPF::Reader>;
+    [[nodiscard]] auto readerCacheStats() const -> ReaderCacheStats;
 
 private:
+    // Entries indexed by a single indexing worker, merged in load order once all workers finish
+    struct IndexShard {
+        struct FileEntries {
+            uint32_t fileIndex = 0;
+            PluginFileInfo info;
+            std::unique_ptr<DBPF::Reader> reader;   // Null when the entries were reused from the previous index
+            bool reused = false;
+        };
+        std::vector<FileEntries> files;
+    };
+
+    // Readers opened while indexing that still fit the reader cache budget are handed to the cache
+    struct RetainedReaders {
+        std::atomic<size_t> count{0};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    struct ReaderSlot {
+        std::mutex openMutex;                   // Held while this file is being opened
+        bool failed = false;                    // Guarded by openMutex
+        std::shared_ptr<DBPF::Reader> reader;   // Guarded by readerCacheMutex_, as are the fields below
+        uint64_t bytes = 0;
+        std::list<uint32_t>::iterator lruPos;
+    };
+
     auto worker_() -> void;
+    auto indexFiles_(const std::vector<std::filesystem::path>& pluginFiles, std::atomic<size_t>& nextFile,
+                     RetainedReaders& retained, IndexShard& shard) -> void;
+    auto retainIndexReader_(RetainedReaders& retained, uint64_t bytes) const -> bool;
+    auto mergeShards_(const std::vector<std::filesystem::path>& pluginFiles, std::vector<IndexShard>& shards) -> void;
+    [[nodiscard]] auto sealed_() const -> const IndexSnapshot*;
     auto publishProgress_() -> void;
+    static auto recordDependency_(const DBPF::Tgi& tgi) -> void;
+    auto fileBytes_(uint32_t fileIndex) const -> uint64_t;
+    auto getIndexedReader_(uint32_t fileIndex, ReaderSlot& slot, const std::filesystem::path& filePath) const
+        -> std::shared_ptr<DBPF::Reader>;
+    // Both require readerCacheMutex_ to be held
+    auto touchReader_(uint32_t fileIndex) const -> std::shared_ptr<DBPF::Reader>;
+    auto cacheReader_(uint32_t fileIndex, std::shared_ptr<DBPF::Reader> reader, uint64_t bytes) const -> void;
 
 private:
     PluginLocator locator_;
+    size_t indexThreads_;
+    ReaderCacheLimits readerCacheLimits_;
 
     mutable std::shared_mutex mutex_;
     std::thread workerThread_;
@@ -67,16 +185,35 @@ private:
     std::atomic<size_t> processedFiles_{0};
     std::atomic<size_t> entriesIndexed_{0};
     std::atomic<size_t> errorCount_{0};
+    std::atomic<size_t> reusedFiles_{0};
+    std::atomic<uint64_t> bytesRead_{0};
 
     std::string currentFile_;
-    std::vector<std::filesystem::path> files_;
-    std::unordered_map<DBPF::Tgi, std::vector<uint32_t>, DBPF::TgiHash> tgiToFileIndices_;
-    std::unordered_map<std::filesystem::path, uint32_t> pathToIndex_;
-    std::unordered_map<uint32_t, std::vector<DBPF::Tgi>> typeToTgis_;
+    // Owner of the published snapshot (guarded by mutex_) and the pointer lookups read it through
+    std::shared_ptr<const IndexSnapshot> sealedSnapshot_;
+    std::atomic<const IndexSnapshot*> sealedIndex_{nullptr};
+    // Previous index keyed by PluginPathKey, consumed by the indexing workers
+    struct PreviousFile {
+        PluginFileInfo info;
+        bool reused = false;
+    };
+    std::unordered_map<std::string, PreviousFile> previousFiles_;
+    bool hasPreviousIndex_ = false;
 
-    // Cache of DBPF readers (one per file) for fast exemplar loading
-    mutable std::unordered_map<std::filesystem::path, std::unique_ptr<DBPF::Reader>> readerCache_;
+    // LRU cache of DBPF readers for fast exemplar loading, one slot per indexed file. Allocated
+    // before the snapshot is published and not resized until the next start().
+    std::vector<std::unique_ptr<ReaderSlot>> readerSlots_;
+    mutable std::mutex readerCacheMutex_;
+    mutable std::list<uint32_t> readerLru_; // Most recently used first
+    mutable uint64_t openReaderBytes_ = 0;
+    mutable ReaderCacheStats readerCacheStats_;
 
-    // Cache of loaded exemplars
-    mutable std::unordered_map<DBPF::Tgi, Exemplar::Record, DBPF::TgiHash> exemplarCache_;
+    // Cache of loaded exemplars, sharded by TGI hash so parse threads rarely wait on each other.
+    // Entries are never erased, so returned pointers stay valid until the next start().
+    struct ExemplarCacheShard {
+        std::shared_mutex mutex;
+        std::unordered_map<DBPF::Tgi, Exemplar::Record, DBPF::TgiHash> exemplars;
+    };
+    static constexpr size_t kExemplarCacheShards = 16;
+    mutable std::array<ExemplarCacheShard, kExemplarCacheShards> exemplarCache_;
 };
@@ -1,8 +1,13 @@
 #include "ExemplarParser.hpp"
 #include "FiraMono.hpp"
 #include "LTextReader.h"
+#include "PixelKernels.hpp"
+#include "ScanMetrics.hpp"
 #include "ThumbnailRenderer.hpp"
+#include "../shared/exemplar_scan.hpp"
+#include "../shared/s3d_bounds.hpp"
 
+#include <algorithm>
 #include <array>
 #include <charconv>
 #include <cmath>
@@ -12,6 +17,7 @@
 #include <optional>
 #include <ranges>
 #include <span>
+#include <tuple>
 #include <unordered_set>
 
 #include "raylib.h"
@@ -193,12 +199,8 @@ namespace {
         return DBPF::Tgi{typeValue, *group, *instance};
     }
 
-    std::optional<std::string> loadLocalizedText(const DbpfIndexService* indexService, const DBPF::Tgi& tgi) {
-        if (!indexService) {
-            return std::nullopt;
-        }
-
-        const auto data = indexService->loadEntryData(tgi);
+    std::optional<std::string> decodeLocalizedText(const DBPF::Tgi& tgi,
+                                                   const std::optional<std::vector<uint8_t>>& data) {
         if (!data || data->empty()) {
             spdlog::trace("Failed to load localized text {}: no data", tgi.ToString());
             return std::nullopt;
@@ -221,6 +223,19 @@ namespace {
         return text;
     }
 
+    std::optional<thumb::RenderedImage> renderModelTimed(thumb::ThumbnailRenderer& renderer,
+                                                         const DBPF::Tgi& modelTgi,
+                                                         const uint32_t size,
+                                                         ScanMetrics* metrics) {
+        ScanMetrics::Timer timer(metrics, ScanPhase::ThumbnailRendering);
+        auto rendered = renderer.renderModel(modelTgi, size);
+        if (metrics) {
+            metrics->addItems(ScanPhase::ThumbnailRendering, 1);
+            metrics->recordModel(modelTgi.ToString(), timer.elapsedMs());
+        }
+        return rendered;
+    }
+
     DecodedImage decodePngToRgba32(const std::vector<uint8_t>& pngData) {
         DecodedImage result;
 
@@ -263,15 +278,9 @@ namespace {
         for (uint32_t y = 0; y < cropHeight; ++y) {
             const size_t srcOffset = (static_cast<size_t>(y) * width + kIconSkipWidth) * 4;
             const size_t dstOffset = static_cast<size_t>(y) * cropWidth * 4;
-            const auto* src = pixels + srcOffset;
-            auto* dst = result.pixels.data() + dstOffset;
-            for (uint32_t x = 0; x < cropWidth; ++x) {
-                const size_t px = x * 4;
-                dst[px + 0] = static_cast<std::byte>(src[px + 2]); // B <- R
-                dst[px + 1] = static_cast<std::byte>(src[px + 1]); // G
-                dst[px + 2] = static_cast<std::byte>(src[px + 0]); // R <- B
-                dst[px + 3] = static_cast<std::byte>(src[px + 3]); // A
-            }
+            thumb::PixelKernels::swapRedBlue(pixels + srcOffset,
+                                             reinterpret_cast<uint8_t*>(result.pixels.data() + dstOffset),
+                                             cropWidth);
         }
 
         result.width = cropWidth;
@@ -287,7 +296,8 @@ namespace fs = std::filesystem;
 ExemplarParser::ExemplarParser(const PropertyMapper& mapper,
                                const DbpfIndexService* indexService,
                                const bool renderThumbnails,
-                               const uint32_t thumbnailSize)
+                               const uint32_t thumbnailSize,
+                               const thumb::RenderBackend renderBackend)
     : propertyMapper_(mapper)
       , indexService_(indexService)
       , thumbnailSize_(thumbnailSize)
@@ -318,9 +328,29 @@ ExemplarParser::ExemplarParser(const PropertyMapper& mapper,
       , optBuilding_(mapper.propertyOptionId(kExemplarType, kExemplarTypeBuilding))
       , optLotConfig_(mapper.propertyOptionId(kExemplarType, kExemplarTypeLotConfig))
       , optProp_(mapper.propertyOptionId(kExemplarType, kExemplarTypeProp))
-      , optFlora_(mapper.propertyOptionId(kExemplarType, kExemplarTypeFlora)) {
+      , optFlora_(mapper.propertyOptionId(kExemplarType, kExemplarTypeFlora))
+      , slotPropertyIds_{
+          pidExemplarType_, pidItemName_, pidUserVisibleNameKey_, pidExemplarName_, pidItemDescriptionKey_,
+          pidItemDescription_, pidOccupantGroups_, pidBuildingPropFamily_, pidItemIcon_, pidLotConfigSize_,
+          pidGrowthStage_, pidLotConfigZoneType_, pidLotConfigWealthType_, pidLotConfigPurposeType_,
+          pidOccupantSize_, pidNighttimeStateChange_, pidPropTimeOfDay_, pidSimulatorDateStart_,
+          pidSimulatorDateDuration_, pidSimulatorDateInterval_, pidPropRandomChance_, pidFloraWild_,
+          pidFloraFamily_, pidFloraClusterType_, kRkt0PropertyId, kRkt1PropertyId, kRkt2PropertyId,
+          kRkt3PropertyId, kRkt4PropertyId, kRkt5PropertyId,
+      } {
+    slotTable_.fill({0, PropertySlot::Count});
+    for (size_t slot = 0; slot < kPropertySlotCount; ++slot) {
+        if (slotPropertyIds_[slot]) {
+            size_t index = slotTableIndex_(*slotPropertyIds_[slot]);
+            while (slotTable_[index].second != PropertySlot::Count) {
+                index = (index + 1) % kSlotTableSize;
+            }
+            slotTable_[index] = {*slotPropertyIds_[slot], static_cast<PropertySlot>(slot)};
+        }
+    }
+
     if (renderThumbnails && indexService_) {
-        thumbnailRenderer_ = std::make_unique<thumb::ThumbnailRenderer>(*indexService_);
+        thumbnailRenderer_ = std::make_unique<thumb::ThumbnailRenderer>(*indexService_, renderBackend);
     }
 }
 
@@ -340,16 +370,42 @@ std::optional<ExemplarType> ExemplarParser::getExemplarType(const Exemplar::Reco
     if (!exemplarTypeOpt) {
         return std::nullopt;
     }
+    return exemplarTypeFromValue_(*exemplarTypeOpt);
+}
+
+ExemplarClassification ExemplarParser::classifyExemplar(const std::span<const uint8_t> data) const {
+    if (!pidExemplarType_) {
+        return {.decided = true};
+    }
+
+    const auto scan = ScanExemplarProperty(data, *pidExemplarType_);
+    if (!scan) {
+        return {};
+    }
+    if (scan->found) {
+        return {.decided = true, .type = scan->value ? exemplarTypeFromValue_(*scan->value) : std::nullopt};
+    }
+
+    const auto* prop = cohortProperty_(DBPF::Tgi{scan->parent[0], scan->parent[1], scan->parent[2]},
+                                       *pidExemplarType_);
+    if (!prop || prop->values.empty()) {
+        return {.decided = true};
+    }
+    const auto exemplarType = prop->GetScalarAs<uint32_t>();
+    return {.decided = true, .type = exemplarType ? exemplarTypeFromValue_(*exemplarType) : std::nullopt};
+}
 
-    if (optBuilding_ && *exemplarTypeOpt == *optBuilding_) return ExemplarType::Building;
-    if (optLotConfig_ && *exemplarTypeOpt == *optLotConfig_) return ExemplarType::LotConfig;
-    if (optProp_ && *exemplarTypeOpt == *optProp_) return ExemplarType::Prop;
-    if (optFlora_ && *exemplarTypeOpt == *optFlora_) return ExemplarType::Flora;
+std::optional<ExemplarType> ExemplarParser::exemplarTypeFromValue_(const uint32_t value) const {
+    if (optBuilding_ && value == *optBuilding_) return ExemplarType::Building;
+    if (optLotConfig_ && value == *optLotConfig_) return ExemplarType::LotConfig;
+    if (optProp_ && value == *optProp_) return ExemplarType::Prop;
+    if (optFlora_ && value == *optFlora_) return ExemplarType::Flora;
     return std::nullopt;
 }
 
 std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exemplar::Record& exemplar,
                                                                     const DBPF::Tgi& tgi) const {
+    const auto properties = projectProperties_(exemplar);
     ParsedBuildingExemplar parsedBuildingExemplar;
     parsedBuildingExemplar.tgi = tgi;
 
@@ -357,7 +413,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     parsedBuildingExemplar.description = "";
 
     if (pidItemName_) {
-        if (auto* prop = findProperty(exemplar, *pidItemName_)) {
+        if (auto* prop = property_(properties, PropertySlot::ItemName)) {
             if (auto name = prop->GetScalarAs<std::string>()) {
                 parsedBuildingExemplar.name = *name;
             }
@@ -365,9 +421,9 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (parsedBuildingExemplar.name.empty() && pidUserVisibleNameKey_) {
-        if (auto* prop = findProperty(exemplar, *pidUserVisibleNameKey_)) {
+        if (auto* prop = property_(properties, PropertySlot::UserVisibleNameKey)) {
             if (auto tgiKey = tgiFromProperty(prop, kTypeIdLText)) {
-                if (auto localized = loadLocalizedText(indexService_, *tgiKey)) {
+                if (auto localized = localizedText_(*tgiKey)) {
                     parsedBuildingExemplar.name = resolveLTextTags_(*localized, exemplar);
                 }
             }
@@ -375,7 +431,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (parsedBuildingExemplar.name.empty() && pidExemplarName_) {
-        if (auto* prop = findProperty(exemplar, *pidExemplarName_)) {
+        if (auto* prop = property_(properties, PropertySlot::ExemplarName)) {
             if (auto name = prop->GetScalarAs<std::string>()) {
                 parsedBuildingExemplar.name = *name;
             }
@@ -383,9 +439,9 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (pidItemDescriptionKey_) {
-        if (auto* prop = findProperty(exemplar, *pidItemDescriptionKey_)) {
+        if (auto* prop = property_(properties, PropertySlot::ItemDescriptionKey)) {
             if (auto tgiKey = tgiFromProperty(prop, kTypeIdLText)) {
-                if (auto localized = loadLocalizedText(indexService_, *tgiKey)) {
+                if (auto localized = localizedText_(*tgiKey)) {
                     parsedBuildingExemplar.description = resolveLTextTags_(*localized, exemplar);
                 }
             }
@@ -393,7 +449,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (parsedBuildingExemplar.description.empty() && pidItemDescription_) {
-        if (auto* prop = findProperty(exemplar, *pidItemDescription_)) {
+        if (auto* prop = property_(properties, PropertySlot::ItemDescription)) {
             if (auto description = prop->GetScalarAs<std::string>()) {
                 parsedBuildingExemplar.description = *description;
             }
@@ -401,7 +457,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (pidOccupantGroups_) {
-        if (auto* prop = findProperty(exemplar, *pidOccupantGroups_)) {
+        if (auto* prop = property_(properties, PropertySlot::OccupantGroups)) {
             if (prop->IsNumericList()) {
                 for (size_t i = 0; i < prop->values.size(); ++i) {
                     if (auto v = prop->GetScalarAs<uint32_t>(i)) {
@@ -414,7 +470,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
 
     // Extract building family IDs
     if (pidBuildingPropFamily_) {
-        if (auto* prop = findProperty(exemplar, *pidBuildingPropFamily_)) {
+        if (auto* prop = property_(properties, PropertySlot::BuildingPropFamily)) {
             for (size_t i = 0; i < prop->values.size(); ++i) {
                 if (auto familyId = prop->GetScalarAs<uint32_t>(i)) {
                     parsedBuildingExemplar.familyIds.push_back(*familyId);
@@ -424,7 +480,7 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
     }
 
     if (pidItemIcon_) {
-        if (auto* prop = findProperty(exemplar, *pidItemIcon_)) {
+        if (auto* prop = property_(properties, PropertySlot::ItemIcon)) {
             if (const auto iconInstance = prop->GetScalarAs<uint32_t>()) {
                 parsedBuildingExemplar.iconTgi = DBPF::Tgi{
                     kTypeIdPNG,
@@ -435,24 +491,20 @@ std::optional<ParsedBuildingExemplar> ExemplarParser::parseBuilding(const Exempl
         }
     }
 
-    parsedBuildingExemplar.modelTgi = resolveModelTgi_(exemplar, tgi);
+    parsedBuildingExemplar.modelTgi = resolveModelTgi_(properties, tgi);
 
     return parsedBuildingExemplar;
 }
 
-std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
-    const Exemplar::Record& exemplar,
-    const DBPF::Tgi& tgi,
-    const std::unordered_map<uint32_t, ParsedBuildingExemplar>& buildingMap,
-    const std::unordered_map<uint32_t, std::vector<uint32_t>>& familyToBuildingsMap) const {
+std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(const Exemplar::Record& exemplar,
+                                                                      const DBPF::Tgi& tgi) const {
+    const auto properties = projectProperties_(exemplar);
     ParsedLotConfigExemplar parsedLotConfigExemplar;
     parsedLotConfigExemplar.tgi = tgi;
-    parsedLotConfigExemplar.buildingInstanceId = 0;
-    parsedLotConfigExemplar.buildingFamilyId = 0;
-    parsedLotConfigExemplar.isFamilyReference = false;
+    parsedLotConfigExemplar.buildingReference = 0;
 
     if (pidExemplarName_) {
-        if (auto* prop = findProperty(exemplar, *pidExemplarName_)) {
+        if (auto* prop = property_(properties, PropertySlot::ExemplarName)) {
             if (auto name = prop->GetScalarAs<std::string>()) {
                 parsedLotConfigExemplar.name = *name;
             }
@@ -460,7 +512,7 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
     }
 
     if (pidLotConfigSize_) {
-        if (auto* prop = findProperty(exemplar, *pidLotConfigSize_)) {
+        if (auto* prop = property_(properties, PropertySlot::LotConfigSize)) {
             if (prop->IsNumericList() && prop->values.size() >= 2) {
                 auto width = prop->GetScalarAs<uint8_t>(0);
                 auto height = prop->GetScalarAs<uint8_t>(1);
@@ -471,57 +523,28 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
         }
     }
 
-    // Scan through the lot objects property ID range to find the building
-    for (uint32_t propID = kPropertyLotObjectsStart;
-         propID <= kPropertyLotObjectsEnd;
-         propID++) {
-        if (auto* prop = findProperty(exemplar, propID)) {
-            if (prop->values.size() >= 13) {
-                auto objectType = prop->GetScalarAs<uint32_t>(kLotObjectIndexType);
-                if (objectType && *objectType == kLotConfigObjectTypeBuilding) {
-                    // Rep 13 (index 12) contains either:
-                    // - Building IID (for most ploppables by Maxis, and most custom content)
-                    // - Family ID (for all growables by Maxis, and very rarely custom content)
-                    // We determine which by checking if it matches a known building first
-                    auto rep13Value = prop->GetScalarAs<uint32_t>(kLotObjectIndexIID);
-
-                    if (rep13Value) {
-                        // First, check if this is a known building instance ID
-                        auto buildingIt = buildingMap.find(*rep13Value);
-                        if (buildingIt != buildingMap.end()) {
-                            // Direct building IID reference
-                            parsedLotConfigExemplar.buildingInstanceId = *rep13Value;
-                        }
-                        else {
-                            // Not a known building - check if it's a family ID
-                            auto famIt = familyToBuildingsMap.find(*rep13Value);
-                            if (famIt != familyToBuildingsMap.end() && !famIt->second.empty()) {
-                                // This is a family reference
-                                parsedLotConfigExemplar.isFamilyReference = true;
-                                parsedLotConfigExemplar.buildingFamilyId = *rep13Value;
-                                // Use the first building from this family
-                                parsedLotConfigExemplar.buildingInstanceId = famIt->second.front();
-                            }
-                            else {
-                                // Unknown reference - could be a building we haven't seen yet
-                                // or a family with no members. Store it as a potential IID.
-                                parsedLotConfigExemplar.buildingInstanceId = *rep13Value;
-                            }
-                        }
-                    }
-                    break;
+    // Scan through the lot objects, lowest property ID first, to find the building
+    for (const auto* prop : lotObjects_(properties)) {
+        if (prop->values.size() >= 13) {
+            auto objectType = prop->GetScalarAs<uint32_t>(kLotObjectIndexType);
+            if (objectType && *objectType == kLotConfigObjectTypeBuilding) {
+                // Rep 13 (index 12) holds the building IID or its family ID, told apart by
+                // resolveLotBuilding once every building is known
+                if (auto rep13Value = prop->GetScalarAs<uint32_t>(kLotObjectIndexIID)) {
+                    parsedLotConfigExemplar.buildingReference = *rep13Value;
                 }
+                break;
             }
         }
     }
 
-    // We need either a valid building ID or a family reference with a resolved building
-    if (!parsedLotConfigExemplar.buildingInstanceId) {
+    // We need a building IID or family ID to resolve the building by
+    if (!parsedLotConfigExemplar.buildingReference) {
         return std::nullopt;
     }
 
     if (pidGrowthStage_) {
-        if (auto* prop = findProperty(exemplar, *pidGrowthStage_)) {
+        if (auto* prop = property_(properties, PropertySlot::GrowthStage)) {
             if (auto v = prop->GetScalarAs<uint8_t>()) {
                 parsedLotConfigExemplar.growthStage = *v;
             }
@@ -529,7 +552,7 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
     }
 
     if (pidLotConfigZoneType_) {
-        if (auto* prop = findProperty(exemplar, *pidLotConfigZoneType_)) {
+        if (auto* prop = property_(properties, PropertySlot::LotConfigZoneType)) {
             if (auto v = prop->GetScalarAs<uint8_t>()) {
                 parsedLotConfigExemplar.zoneType = *v;
             }
@@ -537,7 +560,7 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
     }
 
     if (pidLotConfigWealthType_) {
-        if (auto* prop = findProperty(exemplar, *pidLotConfigWealthType_)) {
+        if (auto* prop = property_(properties, PropertySlot::LotConfigWealthType)) {
             if (auto v = prop->GetScalarAs<uint8_t>()) {
                 parsedLotConfigExemplar.wealthType = *v;
             }
@@ -545,7 +568,7 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
     }
 
     if (pidLotConfigPurposeType_) {
-        if (auto* prop = findProperty(exemplar, *pidLotConfigPurposeType_)) {
+        if (auto* prop = property_(properties, PropertySlot::LotConfigPurposeType)) {
             if (auto v = prop->GetScalarAs<uint8_t>()) {
                 parsedLotConfigExemplar.purposeType = *v;
             }
@@ -555,8 +578,38 @@ std::optional<ParsedLotConfigExemplar> ExemplarParser::parseLotConfig(
     return parsedLotConfigExemplar;
 }
 
+LotBuildingReference ExemplarParser::resolveLotBuilding(
+    const uint32_t buildingReference,
+    const std::unordered_map<uint32_t, std::vector<uint32_t>>& buildingFamilyIds,
+    const std::unordered_map<uint32_t, std::vector<uint32_t>>& familyToBuildingsMap) {
+    // Rep 13 of the building lot object contains either:
+    // - Building IID (for most ploppables by Maxis, and most custom content)
+    // - Family ID (for all growables by Maxis, and very rarely custom content)
+    // We determine which by checking if it matches a known building first
+    if (buildingFamilyIds.contains(buildingReference)) {
+        // Direct building IID reference
+        return {.buildingInstanceId = buildingReference};
+    }
+
+    // Not a known building - check if it's a family ID
+    auto famIt = familyToBuildingsMap.find(buildingReference);
+    if (famIt != familyToBuildingsMap.end() && !famIt->second.empty()) {
+        // This is a family reference; use the first building from this family
+        return {
+            .buildingInstanceId = famIt->second.front(),
+            .buildingFamilyId = buildingReference,
+            .isFamilyReference = true,
+        };
+    }
+
+    // Unknown reference - could be a building we haven't seen yet
+    // or a family with no members. Store it as a potential IID.
+    return {.buildingInstanceId = buildingReference};
+}
+
 std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Record& exemplar,
                                                             const DBPF::Tgi& tgi) const {
+    const auto properties = projectProperties_(exemplar);
     ParsedPropExemplar parsedPropExemplar;
     parsedPropExemplar.tgi = tgi;
     parsedPropExemplar.visibleName = "";
@@ -564,9 +617,9 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     parsedPropExemplar.modelTgi = std::nullopt;
 
     if (pidUserVisibleNameKey_) {
-        if (auto* prop = findProperty(exemplar, *pidUserVisibleNameKey_)) {
+        if (auto* prop = property_(properties, PropertySlot::UserVisibleNameKey)) {
             if (auto tgiKey = tgiFromProperty(prop, kTypeIdLText)) {
-                if (auto localized = loadLocalizedText(indexService_, *tgiKey)) {
+                if (auto localized = localizedText_(*tgiKey)) {
                     auto resolvedUVNK = resolveLTextTags_(*localized, exemplar);
                     resolvedUVNK = SanitizeString(resolvedUVNK);
                     parsedPropExemplar.visibleName = std::move(resolvedUVNK);
@@ -576,7 +629,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidExemplarName_) {
-        if (auto* prop = findProperty(exemplar, *pidExemplarName_)) {
+        if (auto* prop = property_(properties, PropertySlot::ExemplarName)) {
             if (const auto name = prop->GetScalarAs<std::string>()) {
                 parsedPropExemplar.exemplarName = SanitizeString(*name);
             }
@@ -584,7 +637,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidOccupantSize_) {
-        if (auto* prop = findProperty(exemplar, *pidOccupantSize_)) {
+        if (auto* prop = property_(properties, PropertySlot::OccupantSize)) {
             if (prop->IsNumericList()) {
                 if (prop->values.size() >= 3) {
                     auto width = prop->GetScalarAs<float>(0);
@@ -606,7 +659,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidBuildingPropFamily_) {
-        if (auto* prop = findProperty(exemplar, *pidBuildingPropFamily_)) {
+        if (auto* prop = property_(properties, PropertySlot::BuildingPropFamily)) {
             for (size_t i = 0; i < prop->values.size(); ++i) {
                 if (auto familyId = prop->GetScalarAs<uint32_t>(i)) {
                     parsedPropExemplar.familyIds.push_back(*familyId);
@@ -616,7 +669,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidNighttimeStateChange_) {
-        if (auto* prop = findProperty(exemplar, *pidNighttimeStateChange_)) {
+        if (auto* prop = property_(properties, PropertySlot::NighttimeStateChange)) {
             if (const auto value = prop->GetScalarAs<uint8_t>()) {
                 parsedPropExemplar.nighttimeStateChange = (*value != 0);
             }
@@ -624,7 +677,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidPropTimeOfDay_) {
-        if (auto* prop = findProperty(exemplar, *pidPropTimeOfDay_)) {
+        if (auto* prop = property_(properties, PropertySlot::PropTimeOfDay)) {
             if (prop->values.size() >= 2) {
                 const auto startHour = prop->GetScalarAs<float>(0);
                 const auto endHour = prop->GetScalarAs<float>(1);
@@ -636,7 +689,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidSimulatorDateStart_) {
-        if (auto* prop = findProperty(exemplar, *pidSimulatorDateStart_)) {
+        if (auto* prop = property_(properties, PropertySlot::SimulatorDateStart)) {
             if (prop->values.size() >= 2) {
                 const auto month = prop->GetScalarAs<uint8_t>(0);
                 const auto day = prop->GetScalarAs<uint8_t>(1);
@@ -648,7 +701,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidSimulatorDateDuration_) {
-        if (auto* prop = findProperty(exemplar, *pidSimulatorDateDuration_)) {
+        if (auto* prop = property_(properties, PropertySlot::SimulatorDateDuration)) {
             if (const auto value = prop->GetScalarAs<uint32_t>()) {
                 parsedPropExemplar.simulatorDateDuration = *value;
             }
@@ -656,7 +709,7 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidSimulatorDateInterval_) {
-        if (auto* prop = findProperty(exemplar, *pidSimulatorDateInterval_)) {
+        if (auto* prop = property_(properties, PropertySlot::SimulatorDateInterval)) {
             if (const auto value = prop->GetScalarAs<uint32_t>()) {
                 parsedPropExemplar.simulatorDateInterval = *value;
             }
@@ -664,14 +717,14 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
     }
 
     if (pidPropRandomChance_) {
-        if (auto* prop = findProperty(exemplar, *pidPropRandomChance_)) {
+        if (auto* prop = property_(properties, PropertySlot::PropRandomChance)) {
             if (const auto value = prop->GetScalarAs<uint8_t>()) {
                 parsedPropExemplar.randomChance = *value;
             }
         }
     }
 
-    parsedPropExemplar.modelTgi = resolveModelTgi_(exemplar, tgi);
+    parsedPropExemplar.modelTgi = resolveModelTgi_(properties, tgi);
 
     if (parsedPropExemplar.modelTgi.has_value()) {
         if (const auto bounds = loadModelBounds_(*parsedPropExemplar.modelTgi)) {
@@ -702,9 +755,10 @@ std::optional<ParsedPropExemplar> ExemplarParser::parseProp(const Exemplar::Reco
 
 std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Record& exemplar,
                                                               const DBPF::Tgi& tgi) const {
+    const auto properties = projectProperties_(exemplar);
     // Only parse MMP flora (Flora: Wild == false). Skip wild/god-mode flora.
     if (pidFloraWild_) {
-        if (const auto* prop = findProperty(exemplar, *pidFloraWild_)) {
+        if (const auto* prop = property_(properties, PropertySlot::FloraWild)) {
             if (const auto wild = prop->GetScalarAs<bool>()) {
                 if (*wild) {
                     spdlog::trace("Skipping wild flora at {}", tgi.ToString());
@@ -718,9 +772,9 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
     parsed.tgi = tgi;
 
     if (pidUserVisibleNameKey_) {
-        if (const auto* prop = findProperty(exemplar, *pidUserVisibleNameKey_)) {
+        if (const auto* prop = property_(properties, PropertySlot::UserVisibleNameKey)) {
             if (auto tgiKey = tgiFromProperty(prop, kTypeIdLText)) {
-                if (auto localized = loadLocalizedText(indexService_, *tgiKey)) {
+                if (auto localized = localizedText_(*tgiKey)) {
                     parsed.visibleName = SanitizeString(resolveLTextTags_(*localized, exemplar));
                 }
             }
@@ -728,7 +782,7 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
     }
 
     if (pidExemplarName_) {
-        if (const auto* prop = findProperty(exemplar, *pidExemplarName_)) {
+        if (const auto* prop = property_(properties, PropertySlot::ExemplarName)) {
             if (const auto name = prop->GetScalarAs<std::string>()) {
                 parsed.exemplarName = SanitizeString(*name);
             }
@@ -736,7 +790,7 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
     }
 
     if (pidOccupantSize_) {
-        if (const auto* prop = findProperty(exemplar, *pidOccupantSize_)) {
+        if (const auto* prop = property_(properties, PropertySlot::OccupantSize)) {
             if (prop->IsNumericList() && prop->values.size() >= 3) {
                 const auto w = prop->GetScalarAs<float>(0);
                 const auto h = prop->GetScalarAs<float>(1);
@@ -751,7 +805,7 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
     }
 
     if (pidFloraFamily_) {
-        if (const auto* prop = findProperty(exemplar, *pidFloraFamily_)) {
+        if (const auto* prop = property_(properties, PropertySlot::FloraFamily)) {
             for (size_t i = 0; i < prop->values.size(); ++i) {
                 if (const auto familyId = prop->GetScalarAs<uint32_t>(i)) {
                     parsed.familyIds.push_back(*familyId);
@@ -761,7 +815,7 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
     }
 
     if (pidFloraClusterType_) {
-        if (const auto* prop = findProperty(exemplar, *pidFloraClusterType_)) {
+        if (const auto* prop = property_(properties, PropertySlot::FloraClusterType)) {
             if (const auto value = prop->GetScalarAs<uint32_t>()) {
                 if (*value != 0) {
                     parsed.clusterNextType = *value;
@@ -770,7 +824,7 @@ std::optional<ParsedFloraExemplar> ExemplarParser::parseFlora(const Exemplar::Re
         }
     }
 
-    parsed.modelTgi = resolveModelTgi_(exemplar, tgi);
+    parsed.modelTgi = resolveModelTgi_(properties, tgi);
 
     if (parsed.modelTgi.has_value()) {
         if (const auto bounds = loadModelBounds_(*parsed.modelTgi)) {
@@ -820,18 +874,8 @@ Flora ExemplarParser::floraFromParsed(const ParsedFloraExemplar& parsed) const {
         flora.clusterNextType = rfl::Hex<uint32_t>(*parsed.clusterNextType);
     }
 
-    if (parsed.modelTgi.has_value() && thumbnailRenderer_) {
-        auto rendered = thumbnailRenderer_->renderModel(*parsed.modelTgi, thumbnailSize_);
-        if (rendered.has_value() && !rendered->pixels.empty()) {
-            PreRendered preview;
-            preview.data = rfl::Bytestring(std::move(rendered->pixels));
-            preview.width  = rendered->width;
-            preview.height = rendered->height;
-            flora.thumbnail = preview;
-        }
-        else {
-            flora.thumbnail = makeRenderFailedThumbnail(thumbnailSize_, &*parsed.modelTgi);
-        }
+    if (parsed.modelTgi.has_value()) {
+        flora.thumbnail = modelThumbnail(*parsed.modelTgi);
     }
     return flora;
 }
@@ -920,20 +964,8 @@ Building ExemplarParser::buildingFromParsed(const ParsedBuildingExemplar& parsed
         }
     }
 
-    if (!building.thumbnail.has_value() && parsed.modelTgi.has_value() && thumbnailRenderer_) {
-        auto rendered = thumbnailRenderer_->renderModel(*parsed.modelTgi, thumbnailSize_);
-        if (rendered.has_value() && !rendered->pixels.empty()) {
-            PreRendered preview;
-            preview.data = rfl::Bytestring(std::move(rendered->pixels));
-            preview.width = rendered->width;
-            preview.height = rendered->height;
-            building.thumbnail = preview;
-        }
-        else {
-            spdlog::debug("Thumbnail render failed for building {} ({})",
-                          parsed.name, parsed.modelTgi->ToString());
-            building.thumbnail = makeRenderFailedThumbnail(thumbnailSize_, &*parsed.modelTgi);
-        }
+    if (!building.thumbnail.has_value() && parsed.modelTgi.has_value()) {
+        building.thumbnail = modelThumbnail(*parsed.modelTgi);
     }
 
     return building;
@@ -981,91 +1013,234 @@ Prop ExemplarParser::propFromParsed(const ParsedPropExemplar& parsed) const {
     prop.simulatorDateInterval = parsed.simulatorDateInterval;
     prop.randomChance = parsed.randomChance;
 
-    if (parsed.modelTgi.has_value() && thumbnailRenderer_) {
-        auto rendered = thumbnailRenderer_->renderModel(*parsed.modelTgi, thumbnailSize_);
-        if (rendered.has_value() && !rendered->pixels.empty()) {
-            PreRendered preview;
-            preview.data = rfl::Bytestring(std::move(rendered->pixels));
-            preview.width = rendered->width;
-            preview.height = rendered->height;
-            prop.thumbnail = preview;
-        }
-        else {
-            spdlog::debug("Thumbnail render failed for prop {} ({})",
-                          parsed.visibleName, parsed.modelTgi->ToString());
-            prop.thumbnail = makeRenderFailedThumbnail(thumbnailSize_, &*parsed.modelTgi);
-        }
+    if (parsed.modelTgi.has_value()) {
+        prop.thumbnail = modelThumbnail(*parsed.modelTgi);
     }
     return prop;
 }
 
-const Exemplar::Property* ExemplarParser::findProperty(
-    const Exemplar::Record& exemplar,
-    const uint32_t propertyId
-) const {
-    // If we have an index service, use recursive cohort following
-    if (indexService_) {
-        std::unordered_set<uint32_t> visitedCohorts;
-        return findPropertyRecursive(exemplar, propertyId, visitedCohorts);
+std::optional<Thumbnail> ExemplarParser::modelThumbnail(const DBPF::Tgi& modelTgi) const {
+    if (!thumbnailRenderer_) {
+        return std::nullopt;
+    }
+    auto rendered = renderModelTimed(*thumbnailRenderer_, modelTgi, thumbnailSize_, metrics_);
+    if (rendered.has_value() && !rendered->pixels.empty()) {
+        PreRendered preview;
+        preview.data = rfl::Bytestring(std::move(rendered->pixels));
+        preview.width = rendered->width;
+        preview.height = rendered->height;
+        return preview;
     }
-    // Otherwise, just direct lookup
-    return exemplar.FindProperty(propertyId);
+    spdlog::debug("Thumbnail render failed for model {}", modelTgi.ToString());
+    return makeRenderFailedThumbnail(thumbnailSize_, &modelTgi);
 }
 
-const Exemplar::Property* ExemplarParser::findPropertyRecursive(
+const Exemplar::Property* ExemplarParser::findProperty(
     const Exemplar::Record& exemplar,
-    const uint32_t propertyId,
-    std::unordered_set<uint32_t>& visitedCohorts
+    const uint32_t propertyId
 ) const {
     // Check the current exemplar for the property
     if (auto* prop = exemplar.FindProperty(propertyId)) {
         return prop;
     }
 
-    // If no index service, can't look up parent cohorts across files
-    if (!indexService_) {
-        return nullptr;
-    }
+    return cohortProperty_(exemplar.parent, propertyId);
+}
 
-    // Parent cohort is stored in the exemplar header, not as a property
-    // Check if this exemplar has a parent cohort (instance != 0)
-    if (exemplar.parent.instance == 0) {
+const Exemplar::Property* ExemplarParser::cohortProperty_(const DBPF::Tgi& parentTgi,
+                                                          const uint32_t propertyId) const {
+    // Without an index service we can't look up parent cohorts across files.
+    // Parent cohort is stored in the exemplar header, not as a property (instance 0 means none).
+    if (!indexService_ || parentTgi.instance == 0) {
         return nullptr;
     }
 
-    // Prevent infinite loops
-    if (visitedCohorts.contains(exemplar.parent.instance)) {
-        return nullptr;
-    }
-    visitedCohorts.insert(exemplar.parent.instance);
+    const auto& view = cohortView_(parentTgi);
+    // The view skips the index, so record the cohorts it stands for as if they were walked
+    DbpfIndexService::recordDependencies(view.chain);
 
-    // Use the full parent TGI (type, group, instance) from the exemplar header
-    const DBPF::Tgi& parentTgi = exemplar.parent;
+    const auto it = view.properties.find(propertyId);
+    return it != view.properties.end() ? it->second : nullptr;
+}
 
-    if (indexService_->containsTgi(parentTgi)) {
-        // Use the index service's cached loader instead of opening files repeatedly
-        auto parentExemplarResult = indexService_->loadExemplar(parentTgi);
-        if (parentExemplarResult.has_value()) {
-            const Exemplar::Record* parentExemplar = *parentExemplarResult;
-            // Recursively search parent
-            spdlog::trace("Searching parent cohort 0x{:08X}/0x{:08X}/0x{:08X} for property 0x{:08X}", parentTgi.type,
-                          parentTgi.group, parentTgi.instance, propertyId);
-            const auto prop = findPropertyRecursive(*parentExemplar, propertyId, visitedCohorts);
-            if (prop != nullptr) {
-                spdlog::trace("Found property 0x{:08X} in parent cohort: {}", propertyId, prop->ToString());
-                return prop;
+size_t ExemplarParser::slotTableIndex_(const uint32_t propertyId) {
+    // Multiplicative hash, as property IDs in one family often differ only in their low bits
+    return ((propertyId * 0x9E3779B1u) >> 16) % kSlotTableSize;
+}
+
+ExemplarParser::ProjectedProperties ExemplarParser::projectProperties_(const Exemplar::Record& exemplar) const {
+    ProjectedProperties projected{.exemplar = &exemplar};
+    for (const auto& property : exemplar.properties) {
+        if (property.id >= kPropertyLotObjectsStart && property.id <= kPropertyLotObjectsEnd) {
+            projected.lotObjects.push_back(&property);
+        }
+        // Probes to the first unused entry, since several slots may share an ID
+        for (size_t index = slotTableIndex_(property.id); slotTable_[index].second != PropertySlot::Count;
+             index = (index + 1) % kSlotTableSize) {
+            // The first occurrence wins, as it does for Exemplar::Record::FindProperty
+            auto& slot = projected.slots[static_cast<size_t>(slotTable_[index].second)];
+            if (slotTable_[index].first == property.id && !slot) {
+                slot = &property;
             }
-            else {
-                spdlog::trace("Property 0x{:08X} not found in parent cohort", propertyId);
+        }
+    }
+    return projected;
+}
+
+const Exemplar::Property* ExemplarParser::property_(const ProjectedProperties& properties,
+                                                    const PropertySlot slot) const {
+    const auto index = static_cast<size_t>(slot);
+    if (const auto* property = properties.slots[index]) {
+        return property;
+    }
+    const auto& propertyId = slotPropertyIds_[index];
+    return propertyId ? cohortProperty_(properties.exemplar->parent, *propertyId) : nullptr;
+}
+
+std::vector<const Exemplar::Property*> ExemplarParser::lotObjects_(const ProjectedProperties& properties) const {
+    auto lotObjects = properties.lotObjects;
+    const auto& exemplar = *properties.exemplar;
+    if (indexService_ && exemplar.parent.instance != 0) {
+        const auto& view = cohortView_(exemplar.parent);
+        DbpfIndexService::recordDependencies(view.chain);
+        for (const auto& [propertyId, property] : view.properties) {
+            if (propertyId >= kPropertyLotObjectsStart && propertyId <= kPropertyLotObjectsEnd) {
+                lotObjects.push_back(property);
             }
         }
-        else {
+    }
+
+    // Stable, so the exemplar's own first definition of an ID stays ahead of later ones and the cohort's
+    std::ranges::stable_sort(lotObjects, {}, &Exemplar::Property::id);
+    const auto duplicates = std::ranges::unique(lotObjects, {}, &Exemplar::Property::id);
+    lotObjects.erase(duplicates.begin(), duplicates.end());
+    return lotObjects;
+}
+
+CohortViewStats ExemplarParser::cohortViewStats() const {
+    return CohortViewStats{
+        .chainsFlattened = cohortChainsFlattened_.load(std::memory_order_relaxed),
+        .cohortsLoaded = cohortsLoaded_.load(std::memory_order_relaxed),
+        .cyclesDetected = cohortCyclesDetected_.load(std::memory_order_relaxed),
+        .viewHits = cohortViewHits_.load(std::memory_order_relaxed),
+    };
+}
+
+void ExemplarParser::setRenderCache(thumb::RenderCache* cache) {
+    if (thumbnailRenderer_) {
+        thumbnailRenderer_->setPersistentCache(cache);
+    }
+}
+
+void ExemplarParser::prerenderThumbnail(const DBPF::Tgi& modelTgi) const {
+    if (!thumbnailRenderer_ || !thumbnailRenderer_->rendersConcurrently()) {
+        return;
+    }
+    // Items are counted by the *FromParsed call that picks the render up
+    ScanMetrics::Timer timer(metrics_, ScanPhase::ThumbnailRendering);
+    thumbnailRenderer_->prerenderModel(modelTgi, thumbnailSize_);
+    if (metrics_) {
+        metrics_->recordModel(modelTgi.ToString(), timer.elapsedMs());
+    }
+}
+
+void ExemplarParser::prerenderThumbnails(const std::span<const DBPF::Tgi> modelTgis) const {
+    if (!thumbnailRenderer_ || thumbnailRenderer_->rendersConcurrently() || modelTgis.empty()) {
+        return;
+    }
+    ScanMetrics::Timer timer(metrics_, ScanPhase::ThumbnailRendering);
+    thumbnailRenderer_->prerenderModels(modelTgis, thumbnailSize_);
+}
+
+std::optional<thumb::RenderBackend> ExemplarParser::renderBackend() const {
+    if (!thumbnailRenderer_) {
+        return std::nullopt;
+    }
+    return thumbnailRenderer_->backend();
+}
+
+ModelBoundsStats ExemplarParser::modelBoundsStats() const {
+    return ModelBoundsStats{
+        .modelsLoaded = modelBoundsLoaded_.load(std::memory_order_relaxed),
+        .fromVertices = modelBoundsFromVertices_.load(std::memory_order_relaxed),
+        .hits = modelBoundsHits_.load(std::memory_order_relaxed),
+    };
+}
+
+LocalizedTextStats ExemplarParser::localizedTextStats() const {
+    return LocalizedTextStats{
+        .textsDecoded = localizedTextsDecoded_.load(std::memory_order_relaxed),
+        .prefetched = localizedTextsPrefetched_.load(std::memory_order_relaxed),
+        .hits = localizedTextHits_.load(std::memory_order_relaxed),
+    };
+}
+
+thumb::RenderCacheStats ExemplarParser::renderCacheStats() const {
+    return thumbnailRenderer_ ? thumbnailRenderer_->renderCacheStats() : thumb::RenderCacheStats{};
+}
+
+thumb::TextureCacheStats ExemplarParser::textureCacheStats() const {
+    return thumbnailRenderer_ ? thumbnailRenderer_->textureCacheStats() : thumb::TextureCacheStats{};
+}
+
+const ExemplarParser::CohortView& ExemplarParser::cohortView_(const DBPF::Tgi& parentTgi) const {
+    {
+        std::shared_lock readLock(cohortViewMutex_);
+        if (const auto it = cohortViews_.find(parentTgi); it != cohortViews_.end()) {
+            cohortViewHits_.fetch_add(1, std::memory_order_relaxed);
+            return *it->second;
+        }
+    }
+
+    // Flatten outside the lock; if another thread got there first, its view wins and ours is dropped
+    auto view = flattenCohortChain_(parentTgi);
+    std::unique_lock writeLock(cohortViewMutex_);
+    const auto [it, inserted] = cohortViews_.try_emplace(parentTgi, std::move(view));
+    if (inserted) {
+        cohortChainsFlattened_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return *it->second;
+}
+
+std::shared_ptr<const ExemplarParser::CohortView> ExemplarParser::flattenCohortChain_(
+    const DBPF::Tgi& parentTgi
+) const {
+    auto view = std::make_shared<CohortView>();
+
+    // Walk the chain nearest-first; the first cohort to define a property wins
+    std::unordered_set<uint32_t> visitedCohorts;
+    DBPF::Tgi cohortTgi = parentTgi;
+    while (cohortTgi.instance != 0) {
+        // Prevent infinite loops
+        if (!visitedCohorts.insert(cohortTgi.instance).second) {
+            spdlog::debug("Cohort chain starting at 0x{:08X}/0x{:08X}/0x{:08X} loops back to 0x{:08X}",
+                          parentTgi.type, parentTgi.group, parentTgi.instance, cohortTgi.instance);
+            cohortCyclesDetected_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        view->chain.push_back(cohortTgi);
+
+        if (!indexService_->containsTgi(cohortTgi)) {
+            break;
+        }
+
+        // Use the index service's cached loader instead of opening files repeatedly
+        auto cohortResult = indexService_->loadExemplar(cohortTgi);
+        if (!cohortResult.has_value()) {
             spdlog::warn("Failed to load parent cohort 0x{:08X}/0x{:08X}/0x{:08X}: {}",
-                         parentTgi.type, parentTgi.group, parentTgi.instance, parentExemplarResult.error().message);
+                         cohortTgi.type, cohortTgi.group, cohortTgi.instance, cohortResult.error().message);
+            break;
         }
+        cohortsLoaded_.fetch_add(1, std::memory_order_relaxed);
+
+        const Exemplar::Record* cohort = *cohortResult;
+        for (const auto& prop : cohort->properties) {
+            view->properties.try_emplace(prop.id, &prop);
+        }
+        cohortTgi = cohort->parent;
     }
 
-    return nullptr;
+    return view;
 }
 
 std::string ExemplarParser::resolveLTextTags_(std::string_view text,
@@ -1157,7 +1332,7 @@ std::string ExemplarParser::resolveLTextTags_(std::string_view text,
     return result;
 }
 
-std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record& exemplar,
+std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const ProjectedProperties& properties,
                                                           const DBPF::Tgi& exemplarTgi) const {
     constexpr auto kDesiredZoomLevel = 5;
     constexpr auto kDesiredRotation = 0; // South
@@ -1187,7 +1362,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         return DBPF::Tgi{type, *group, *instance};
     };
 
-    if (const auto* rkt0 = findProperty(exemplar, kRkt0PropertyId)) {
+    if (const auto* rkt0 = property_(properties, PropertySlot::Rkt0)) {
         spdlog::trace("Found RKT0 for exemplar {}", exemplarTgi.ToString());
         // RKT0 -> One model for all zooms and rotation (True3D)
         if (const auto tgi = tgiFromList(rkt0)) {
@@ -1195,7 +1370,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         }
     }
 
-    if (const auto* rkt1 = findProperty(exemplar, kRkt1PropertyId)) {
+    if (const auto* rkt1 = property_(properties, PropertySlot::Rkt1)) {
         spdlog::trace("Found RKT1 for exemplar {}", exemplarTgi.ToString());
         // RKT1 -> The S3D tgi will point towards the Zoom 1, South version of the 20 possible models
         if (auto tgi = tgiFromList(rkt1)) {
@@ -1204,7 +1379,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         }
     }
 
-    if (const auto* rkt5 = findProperty(exemplar, kRkt5PropertyId)) {
+    if (const auto* rkt5 = property_(properties, PropertySlot::Rkt5)) {
         spdlog::trace("Found RKT5 for exemplar {}", exemplarTgi.ToString());
         if (auto tgi = tgiFromList(rkt5)) {
             constexpr uint32_t zoomOffset = static_cast<uint32_t>(kDesiredZoomLevel - 1) * 0x100u;
@@ -1214,7 +1389,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         }
     }
 
-    if (const auto* rkt3 = findProperty(exemplar, kRkt3PropertyId)) {
+    if (const auto* rkt3 = property_(properties, PropertySlot::Rkt3)) {
         spdlog::trace("Found RKT3 for exemplar {}", exemplarTgi.ToString());
         constexpr size_t index = 2 + static_cast<size_t>(kDesiredZoomLevel - 1);
         if (rkt3->values.size() > index) {
@@ -1230,7 +1405,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         }
     }
 
-    if (const auto* rkt2 = findProperty(exemplar, kRkt2PropertyId)) {
+    if (const auto* rkt2 = property_(properties, PropertySlot::Rkt2)) {
         spdlog::trace("Found RKT2 for exemplar {}", exemplarTgi.ToString());
         constexpr size_t index = 2 + static_cast<size_t>(kDesiredZoomLevel - 1) * 4 +
             static_cast<size_t>(kDesiredRotation);
@@ -1242,7 +1417,7 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
         }
     }
 
-    if (const auto* rkt4 = findProperty(exemplar, kRkt4PropertyId)) {
+    if (const auto* rkt4 = property_(properties, PropertySlot::Rkt4)) {
         spdlog::trace("Found RKT4 for exemplar {}", exemplarTgi.ToString());
         constexpr size_t blockSize = 8;
         // Try state 0 (normal) first, then state 1 (special/timed prop).
@@ -1294,35 +1469,159 @@ std::optional<DBPF::Tgi> ExemplarParser::resolveModelTgi_(const Exemplar::Record
     return std::nullopt;
 }
 
-std::optional<std::array<float, 6>> ExemplarParser::loadModelBounds_(const DBPF::Tgi& modelTgi) const {
+void ExemplarParser::prefetchLocalizedTexts(std::span<const Exemplar::Record* const> exemplars) const {
     if (!indexService_) {
-        return std::nullopt;
+        return;
     }
 
-    auto filePaths = indexService_->lookupFiles(modelTgi);
-    if (filePaths.empty()) {
-        return std::nullopt;
+    std::vector<DBPF::Tgi> referenced;
+    for (const auto* exemplar : exemplars) {
+        for (const auto& propertyId : {pidUserVisibleNameKey_, pidItemDescriptionKey_}) {
+            if (!propertyId) {
+                continue;
+            }
+            if (const auto tgi = tgiFromProperty(findProperty(*exemplar, *propertyId), kTypeIdLText)) {
+                referenced.push_back(*tgi);
+            }
+        }
+    }
+
+    // Texts not decoded yet, by the file they are read from
+    std::unordered_map<uint32_t, std::vector<DBPF::Tgi>> textsByFile;
+    {
+        std::unordered_set<DBPF::Tgi, DBPF::TgiHash> seen;
+        std::shared_lock readLock(localizedTextMutex_);
+        for (const auto& tgi : referenced) {
+            if (localizedTexts_.contains(tgi) || !seen.insert(tgi).second) {
+                continue;
+            }
+            if (const auto fileIndex = indexService_->winningFile(tgi)) {
+                textsByFile[*fileIndex].push_back(tgi);
+            }
+        }
+    }
+    if (textsByFile.empty()) {
+        return;
     }
 
-    for (const auto& filePath : std::ranges::reverse_view(filePaths)) {
-        auto* reader = indexService_->getReader(filePath);
+    ScanMetrics::Timer timer(metrics_, ScanPhase::LTextResolution);
+    for (auto& [fileIndex, tgis] : textsByFile) {
+        const auto reader = indexService_->getReader(fileIndex);
         if (!reader) {
             continue;
         }
+        std::ranges::sort(tgis, {}, [](const DBPF::Tgi& tgi) { return std::tie(tgi.group, tgi.instance); });
 
-        auto record = reader->LoadS3D(modelTgi);
-        if (!record.has_value()) {
-            continue;
+        std::vector<std::pair<DBPF::Tgi, std::optional<std::string>>> decoded;
+        decoded.reserve(tgis.size());
+        for (const auto& tgi : tgis) {
+            const auto data = reader->ReadEntryData(tgi);
+            if (metrics_ && data) {
+                metrics_->addBytesRead(ScanPhase::LTextResolution, data->size());
+            }
+            decoded.emplace_back(tgi, decodeLocalizedText(tgi, data));
         }
 
-        return std::array<float, 6>{
-            record->bbMin.x,
-            record->bbMax.x,
-            record->bbMin.y,
-            record->bbMax.y,
-            record->bbMin.z,
-            record->bbMax.z
-        };
+        std::unique_lock writeLock(localizedTextMutex_);
+        for (auto& [tgi, text] : decoded) {
+            if (localizedTexts_.try_emplace(tgi, std::move(text)).second) {
+                localizedTextsPrefetched_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+std::optional<std::string> ExemplarParser::localizedText_(const DBPF::Tgi& tgi) const {
+    if (!indexService_) {
+        return std::nullopt;
+    }
+
+    ScanMetrics::Timer timer(metrics_, ScanPhase::LTextResolution);
+    if (metrics_) {
+        metrics_->addItems(ScanPhase::LTextResolution, 1);
+    }
+    {
+        std::shared_lock readLock(localizedTextMutex_);
+        if (const auto it = localizedTexts_.find(tgi); it != localizedTexts_.end()) {
+            localizedTextHits_.fetch_add(1, std::memory_order_relaxed);
+            // The text only depends on its own entry, which loadEntryData records on a miss
+            DbpfIndexService::recordDependencies(std::span(&tgi, 1));
+            return it->second;
+        }
+    }
+
+    const auto data = indexService_->loadEntryData(tgi);
+    if (metrics_ && data) {
+        metrics_->addBytesRead(ScanPhase::LTextResolution, data->size());
+    }
+    auto text = decodeLocalizedText(tgi, data);
+    std::unique_lock writeLock(localizedTextMutex_);
+    if (localizedTexts_.try_emplace(tgi, text).second) {
+        localizedTextsDecoded_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return text;
+}
+
+std::optional<std::array<float, 6>> ExemplarParser::loadModelBounds_(const DBPF::Tgi& modelTgi) const {
+    if (!indexService_) {
+        return std::nullopt;
+    }
+
+    ScanMetrics::Timer timer(metrics_, ScanPhase::ModelBounds);
+    if (metrics_) {
+        metrics_->addItems(ScanPhase::ModelBounds, 1);
+    }
+    {
+        std::shared_lock readLock(modelBoundsMutex_);
+        if (const auto it = modelBounds_.find(modelTgi); it != modelBounds_.end()) {
+            modelBoundsHits_.fetch_add(1, std::memory_order_relaxed);
+            DbpfIndexService::recordDependencies(it->second.dependencies);
+            return it->second.bounds;
+        }
+    }
+
+    // Read outside the lock; if another thread got there first, its result wins
+    ModelBounds entry;
+    {
+        DbpfIndexService::DependencyScope scope(entry.dependencies);
+        entry.bounds = readModelBounds_(modelTgi);
+    }
+    const auto bounds = entry.bounds;
+    std::unique_lock writeLock(modelBoundsMutex_);
+    if (modelBounds_.try_emplace(modelTgi, std::move(entry)).second) {
+        modelBoundsLoaded_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return bounds;
+}
+
+std::optional<std::array<float, 6>> ExemplarParser::readModelBounds_(const DBPF::Tgi& modelTgi) const {
+    const auto fileIndex = indexService_->winningFile(modelTgi);
+    if (!fileIndex) {
+        return std::nullopt;
+    }
+
+    if (const auto reader = indexService_->getReader(*fileIndex)) {
+        // The vertex positions are enough for the box; only models the reader does not understand are
+        // decoded in full
+        if (const auto data = reader->ReadEntryData(modelTgi)) {
+            if (metrics_) {
+                metrics_->addBytesRead(ScanPhase::ModelBounds, data->size());
+            }
+            if (const auto bounds = ReadS3DBounds(*data)) {
+                modelBoundsFromVertices_.fetch_add(1, std::memory_order_relaxed);
+                return bounds;
+            }
+        }
+        if (auto record = reader->LoadS3D(modelTgi); record.has_value()) {
+            return std::array<float, 6>{
+                record->bbMin.x,
+                record->bbMax.x,
+                record->bbMin.y,
+                record->bbMax.y,
+                record->bbMin.z,
+                record->bbMax.z
+            };
+        }
     }
 
     spdlog::warn("Unable to load model bounds for S3D model {}", modelTgi.ToString());
@@ -1332,11 +1631,7 @@ std::optional<std::array<float, 6>> ExemplarParser::loadModelBounds_(const DBPF:
 std::vector<std::byte> ExemplarParser::convertBgraToRgba_(const std::vector<std::byte>& pixels) {
     std::vector<std::byte> rgba;
     rgba.resize(pixels.size());
-    for (size_t i = 0; i + 3 < pixels.size(); i += 4) {
-        rgba[i + 0] = pixels[i + 2];
-        rgba[i + 1] = pixels[i + 1];
-        rgba[i + 2] = pixels[i + 0];
-        rgba[i + 3] = pixels[i + 3];
-    }
+    thumb::PixelKernels::swapRedBlue(reinterpret_cast<const uint8_t*>(pixels.data()),
+                                     reinterpret_cast<uint8_t*>(rgba.data()), pixels.size() / 4);
     return rgba;
 }
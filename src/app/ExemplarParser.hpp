@@ -4,14 +4,23 @@
 #include "ExemplarReader.h"
 #include "PropertyMapper.hpp"
 #include "DbpfIndexService.hpp"
+#include "ThumbnailRenderer.hpp"
 #include "../shared/entities.hpp"
 #include <array>
+#include <atomic>
 #include <memory>
 #include <filesystem>
 #include <optional>
+#include <shared_mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ScanMetrics;
 
 namespace thumb {
-    class ThumbnailRenderer;
+    class RenderCache;
 }
 
 constexpr auto kZero = 0x0000000u;
@@ -75,6 +84,12 @@ enum class ExemplarType {
     Flora,    // Exemplar Type 0x0F
 };
 
+// What the Exemplar Type of a raw exemplar entry says, read without decoding the entry
+struct ExemplarClassification {
+    bool decided = false; // False when only a full load can tell, as for text exemplars
+    std::optional<ExemplarType> type; // Nullopt for exemplars the catalog has no use for
+};
+
 struct ParsedBuildingExemplar {
     DBPF::Tgi tgi;
     std::string name;
@@ -89,9 +104,7 @@ struct ParsedLotConfigExemplar {
     DBPF::Tgi tgi;
     std::string name;
     std::pair<uint8_t, uint8_t> lotSize;
-    uint32_t buildingInstanceId;
-    uint32_t buildingFamilyId = 0; // Family ID if isFamilyReference is true
-    bool isFamilyReference = false; // True if lot references a family instead of specific building
+    uint32_t buildingReference; // Rep 13 of the building lot object: a building IID or a family ID
     std::optional<uint8_t> growthStage;
     std::optional<std::pair<uint8_t, uint8_t>> capacity; // (min, max)
     std::optional<uint8_t> zoneType; // LotConfigPropertyZoneTypes
@@ -99,6 +112,13 @@ struct ParsedLotConfigExemplar {
     std::optional<uint8_t> purposeType; // LotConfigPropertyPurposeTypes
 };
 
+// The building a lot belongs to, once every building of the install is known
+struct LotBuildingReference {
+    uint32_t buildingInstanceId = 0;
+    uint32_t buildingFamilyId = 0; // Family ID if isFamilyReference is true
+    bool isFamilyReference = false; // True if lot references a family instead of specific building
+};
+
 struct ParsedFloraExemplar {
     DBPF::Tgi tgi;
     std::string exemplarName;
@@ -142,22 +162,47 @@ struct ParsedPropExemplar {
     std::optional<DBPF::Tgi> modelTgi;
 };
 
+struct CohortViewStats {
+    uint64_t chainsFlattened = 0; // Distinct parent cohort chains flattened into a view
+    uint64_t cohortsLoaded = 0;   // Cohort exemplars walked while flattening
+    uint64_t cyclesDetected = 0;  // Chains that referred back to a cohort already on the chain
+    uint64_t viewHits = 0;        // Lookups answered by an existing view
+};
+
+struct ModelBoundsStats {
+    uint64_t modelsLoaded = 0; // Distinct S3D models read for their bounds
+    uint64_t fromVertices = 0; // Of those, models read from their vertex positions alone, without a full decode
+    uint64_t hits = 0;         // Lookups answered by bounds already read, failures included
+};
+
+struct LocalizedTextStats {
+    uint64_t textsDecoded = 0; // Distinct LTEXT entries decoded when first looked up
+    uint64_t prefetched = 0;   // Distinct LTEXT entries decoded ahead, a file's worth at a time
+    uint64_t hits = 0;         // Lookups answered by a text already decoded, failures included
+};
+
 class ExemplarParser {
 public:
     explicit ExemplarParser(const PropertyMapper& mapper,
                             const DbpfIndexService* indexService = nullptr,
                             bool renderThumbnails = false,
-                            uint32_t thumbnailSize = kDefaultThumbnailSize);
+                            uint32_t thumbnailSize = kDefaultThumbnailSize,
+                            thumb::RenderBackend renderBackend = thumb::RenderBackend::Gpu);
     ~ExemplarParser();
 
     [[nodiscard]] std::optional<ExemplarType> getExemplarType(const Exemplar::Record& exemplar) const;
+    // Same answer as getExemplarType, from the raw bytes of an exemplar entry, falling back to the
+    // parent cohort chain when the entry has no Exemplar Type of its own
+    [[nodiscard]] ExemplarClassification classifyExemplar(std::span<const uint8_t> data) const;
     [[nodiscard]] std::optional<ParsedBuildingExemplar> parseBuilding(const Exemplar::Record& exemplar,
                                                                       const DBPF::Tgi& tgi) const;
-    [[nodiscard]] std::optional<ParsedLotConfigExemplar> parseLotConfig(
-        const Exemplar::Record& exemplar,
-        const DBPF::Tgi& tgi,
-        const std::unordered_map<uint32_t, ParsedBuildingExemplar>& buildingMap,
-        const std::unordered_map<uint32_t, std::vector<uint32_t>>& familyToBuildingsMap) const;
+    [[nodiscard]] std::optional<ParsedLotConfigExemplar> parseLotConfig(const Exemplar::Record& exemplar,
+                                                                        const DBPF::Tgi& tgi) const;
+    // buildingFamilyIds maps every known building instance ID to its Building/prop Family values
+    [[nodiscard]] static LotBuildingReference resolveLotBuilding(
+        uint32_t buildingReference,
+        const std::unordered_map<uint32_t, std::vector<uint32_t>>& buildingFamilyIds,
+        const std::unordered_map<uint32_t, std::vector<uint32_t>>& familyToBuildingsMap);
     [[nodiscard]] std::optional<ParsedPropExemplar> parseProp(const Exemplar::Record& exemplar,
                                                               const DBPF::Tgi& tgi) const;
     [[nodiscard]] std::optional<ParsedFloraExemplar> parseFlora(const Exemplar::Record& exemplar,
@@ -169,31 +214,144 @@ public:
     [[nodiscard]] Lot lotFromParsed(const ParsedLotConfigExemplar& parsed) const;
     [[nodiscard]] Prop propFromParsed(const ParsedPropExemplar& parsed) const;
     [[nodiscard]] Flora floraFromParsed(const ParsedFloraExemplar& parsed) const;
+    // The rendered thumbnail of a model, or the placeholder for a model that does not render; nullopt
+    // when thumbnails are not rendered. Comes from the render cache when the model was drawn before.
+    [[nodiscard]] std::optional<Thumbnail> modelThumbnail(const DBPF::Tgi& modelTgi) const;
 
-    // Cohort-aware property lookup - searches exemplar and parent cohorts recursively
+    // Cohort-aware property lookup - searches the exemplar, then its flattened parent cohort chain
     [[nodiscard]] const Exemplar::Property* findProperty(
         const Exemplar::Record& exemplar,
         uint32_t propertyId
     ) const;
 
+    [[nodiscard]] CohortViewStats cohortViewStats() const;
+    [[nodiscard]] ModelBoundsStats modelBoundsStats() const;
+    [[nodiscard]] LocalizedTextStats localizedTextStats() const;
+    // All zero when thumbnails are not rendered
+    [[nodiscard]] thumb::RenderCacheStats renderCacheStats() const;
+    [[nodiscard]] thumb::TextureCacheStats textureCacheStats() const;
+
+    // Time LTEXT resolution, model bounds and thumbnail rendering into metrics; null disables it
+    void setMetrics(ScanMetrics* metrics) { metrics_ = metrics; }
+    // Reuse thumbnails rendered by earlier scans; null disables it
+    void setRenderCache(thumb::RenderCache* cache);
+    // Renders a model ahead of the *FromParsed call that needs it, when the renderer can draw on the
+    // calling thread; the result waits in the render cache. Does nothing for the GPU backend.
+    void prerenderThumbnail(const DBPF::Tgi& modelTgi) const;
+    // Renders a batch of models ahead for the GPU backend, which draws them into one render target per
+    // pass. Call on the thread that renders; does nothing for the CPU backend.
+    void prerenderThumbnails(std::span<const DBPF::Tgi> modelTgis) const;
+    [[nodiscard]] std::optional<thumb::RenderBackend> renderBackend() const;
+    // Reads and decodes the LTEXT names and descriptions these exemplars refer to, grouped by the file
+    // they come from, so the parses that follow find them decoded instead of reading them one by one
+    void prefetchLocalizedTexts(std::span<const Exemplar::Record* const> exemplars) const;
+
 private:
-    // Helper to recursively find properties in exemplar and parent cohorts
-    [[nodiscard]] const Exemplar::Property* findPropertyRecursive(
-        const Exemplar::Record& exemplar,
-        uint32_t propertyId,
-        std::unordered_set<uint32_t>& visitedCohorts
-    ) const;
+    // All properties visible through a parent cohort chain, nearest cohort first. Property pointers
+    // point into the index service's exemplar cache, which never evicts.
+    struct CohortView {
+        std::unordered_map<uint32_t, const Exemplar::Property*> properties;
+        std::vector<DBPF::Tgi> chain; // Cohorts the view was built from, including missing ones
+    };
+
+    // Properties the parsers read, one slot each in ProjectedProperties
+    enum class PropertySlot : uint8_t {
+        ExemplarType,
+        ItemName,
+        UserVisibleNameKey,
+        ExemplarName,
+        ItemDescriptionKey,
+        ItemDescription,
+        OccupantGroups,
+        BuildingPropFamily,
+        ItemIcon,
+        LotConfigSize,
+        GrowthStage,
+        LotConfigZoneType,
+        LotConfigWealthType,
+        LotConfigPurposeType,
+        OccupantSize,
+        NighttimeStateChange,
+        PropTimeOfDay,
+        SimulatorDateStart,
+        SimulatorDateDuration,
+        SimulatorDateInterval,
+        PropRandomChance,
+        FloraWild,
+        FloraFamily,
+        FloraClusterType,
+        Rkt0,
+        Rkt1,
+        Rkt2,
+        Rkt3,
+        Rkt4,
+        Rkt5,
+        Count,
+    };
+    static constexpr size_t kPropertySlotCount = static_cast<size_t>(PropertySlot::Count);
+
+    // An exemplar's own properties, sorted into slots by a single walk over its property list.
+    // Empty slots are looked up in the parent cohort chain when read.
+    struct ProjectedProperties {
+        const Exemplar::Record* exemplar;
+        std::array<const Exemplar::Property*, kPropertySlotCount> slots{};
+        std::vector<const Exemplar::Property*> lotObjects; // In the lot object ID range, in file order
+    };
+
+    static size_t slotTableIndex_(uint32_t propertyId);
+    [[nodiscard]] ProjectedProperties projectProperties_(const Exemplar::Record& exemplar) const;
+    // The slot's property from the exemplar, else from its cohort chain; null when neither has it
+    [[nodiscard]] const Exemplar::Property* property_(const ProjectedProperties& properties,
+                                                      PropertySlot slot) const;
+    // Lot objects of the exemplar and its cohort chain, one per property ID, lowest ID first
+    [[nodiscard]] std::vector<const Exemplar::Property*> lotObjects_(const ProjectedProperties& properties) const;
+    // Looks a property up in the flattened parent cohort chain only
+    [[nodiscard]] const Exemplar::Property* cohortProperty_(const DBPF::Tgi& parentTgi, uint32_t propertyId) const;
+    [[nodiscard]] std::optional<ExemplarType> exemplarTypeFromValue_(uint32_t value) const;
+    // Returns the memoised view of the chain starting at parentTgi, building it on first use
+    [[nodiscard]] const CohortView& cohortView_(const DBPF::Tgi& parentTgi) const;
+    [[nodiscard]] std::shared_ptr<const CohortView> flattenCohortChain_(const DBPF::Tgi& parentTgi) const;
+    // Memoised per LTEXT entry, since names and descriptions are often shared between exemplars
+    [[nodiscard]] std::optional<std::string> localizedText_(const DBPF::Tgi& tgi) const;
     [[nodiscard]] std::string resolveLTextTags_(std::string_view text,
                                                 const Exemplar::Record& exemplar) const;
-    [[nodiscard]] std::optional<DBPF::Tgi> resolveModelTgi_(const Exemplar::Record& exemplar,
+    [[nodiscard]] std::optional<DBPF::Tgi> resolveModelTgi_(const ProjectedProperties& properties,
                                                             const DBPF::Tgi& exemplarTgi) const;
+    // Memoised per model, since many props and flora share one model
     [[nodiscard]] std::optional<std::array<float, 6>> loadModelBounds_(const DBPF::Tgi& modelTgi) const;
+    [[nodiscard]] std::optional<std::array<float, 6>> readModelBounds_(const DBPF::Tgi& modelTgi) const;
     static std::vector<std::byte> convertBgraToRgba_(const std::vector<std::byte>& pixels);
 
     const PropertyMapper& propertyMapper_;
     const DbpfIndexService* indexService_;
     std::unique_ptr<thumb::ThumbnailRenderer> thumbnailRenderer_;
     uint32_t thumbnailSize_;
+    ScanMetrics* metrics_ = nullptr;
+
+    // Flattened parent cohort chains, keyed by the TGI of the first parent
+    mutable std::shared_mutex cohortViewMutex_;
+    mutable std::unordered_map<DBPF::Tgi, std::shared_ptr<const CohortView>, DBPF::TgiHash> cohortViews_;
+    mutable std::atomic<uint64_t> cohortChainsFlattened_{0};
+    mutable std::atomic<uint64_t> cohortsLoaded_{0};
+    mutable std::atomic<uint64_t> cohortCyclesDetected_{0};
+    mutable std::atomic<uint64_t> cohortViewHits_{0};
+
+    struct ModelBounds {
+        std::optional<std::array<float, 6>> bounds;
+        std::vector<DBPF::Tgi> dependencies; // Replayed on every hit
+    };
+    mutable std::shared_mutex modelBoundsMutex_;
+    mutable std::unordered_map<DBPF::Tgi, ModelBounds, DBPF::TgiHash> modelBounds_;
+    mutable std::atomic<uint64_t> modelBoundsLoaded_{0};
+    mutable std::atomic<uint64_t> modelBoundsFromVertices_{0};
+    mutable std::atomic<uint64_t> modelBoundsHits_{0};
+
+    // Decoded LTEXT, before tags are resolved; nullopt when the entry is missing or does not decode
+    mutable std::shared_mutex localizedTextMutex_;
+    mutable std::unordered_map<DBPF::Tgi, std::optional<std::string>, DBPF::TgiHash> localizedTexts_;
+    mutable std::atomic<uint64_t> localizedTextsDecoded_{0};
+    mutable std::atomic<uint64_t> localizedTextsPrefetched_{0};
+    mutable std::atomic<uint64_t> localizedTextHits_{0};
 
     // Cached property IDs (resolved once at construction)
     std::optional<uint32_t> pidExemplarType_;
@@ -227,4 +385,10 @@ private:
     std::optional<uint32_t> optLotConfig_;
     std::optional<uint32_t> optProp_;
     std::optional<uint32_t> optFlora_;
+
+    // Property ID of every slot, and an open-addressed (ID, slot) table that projectProperties_ probes
+    // once per property; most IDs miss on the first probe. Unused entries hold PropertySlot::Count.
+    static constexpr size_t kSlotTableSize = 128;
+    std::array<std::optional<uint32_t>, kPropertySlotCount> slotPropertyIds_;
+    std::array<std::pair<uint32_t, PropertySlot>, kSlotTableSize> slotTable_;
 };
@@ -0,0 +1,238 @@
+#include "GpuTileAtlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#define GLFW_INCLUDE_NONE
+#include "GLFW/glfw3.h"
+#include "rlgl.h"
+#include "spdlog/spdlog.h"
+
+#if defined(_WIN32) && !defined(_WIN64)
+#define THUMB_GL_API __stdcall
+#else
+#define THUMB_GL_API
+#endif
+
+namespace thumb {
+    namespace {
+        // Bounds the target at 16 MiB, and each pixel buffer at the same
+        constexpr uint32_t kMaxAtlasSide = 2048;
+
+        // raylib does not expose pixel-buffer objects, so the few GL entry points needed are loaded here
+        constexpr uint32_t kGlPixelPackBuffer = 0x88EB;
+        constexpr uint32_t kGlStreamRead = 0x88E1;
+        constexpr uint32_t kGlMapReadBit = 0x0001;
+        constexpr uint32_t kGlRgba = 0x1908;
+        constexpr uint32_t kGlUnsignedByte = 0x1401;
+
+        struct GlPixelBufferApi {
+            void (THUMB_GL_API *genBuffers)(int, uint32_t*) = nullptr;
+            void (THUMB_GL_API *deleteBuffers)(int, const uint32_t*) = nullptr;
+            void (THUMB_GL_API *bindBuffer)(uint32_t, uint32_t) = nullptr;
+            void (THUMB_GL_API *bufferData)(uint32_t, ptrdiff_t, const void*, uint32_t) = nullptr;
+            void* (THUMB_GL_API *mapBufferRange)(uint32_t, ptrdiff_t, ptrdiff_t, uint32_t) = nullptr;
+            uint8_t (THUMB_GL_API *unmapBuffer)(uint32_t) = nullptr;
+            void (THUMB_GL_API *readPixels)(int, int, int, int, uint32_t, uint32_t, void*) = nullptr;
+
+            [[nodiscard]] bool complete() const {
+                return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBufferRange && unmapBuffer &&
+                       readPixels;
+            }
+        };
+
+        GlPixelBufferApi gl;
+
+        template<typename Fn>
+        void LoadGlFunction(Fn& fn, const char* name) {
+            fn = reinterpret_cast<Fn>(glfwGetProcAddress(name));
+        }
+    }
+
+    GpuTileAtlas::~GpuTileAtlas() {
+        unload_();
+    }
+
+    bool GpuTileAtlas::prepare(const uint32_t tileSize) {
+        if (tileSize == 0) {
+            return false;
+        }
+        if (target_.id != 0 && tileSize_ == tileSize) {
+            return true;
+        }
+        unload_();
+
+        tilesPerRow_ = std::max(1u, kMaxAtlasSide / tileSize);
+        const auto side = static_cast<int>(tilesPerRow_ * tileSize);
+        target_ = LoadRenderTexture(side, side);
+        if (target_.id == 0) {
+            tilesPerRow_ = 0;
+            return false;
+        }
+        tileSize_ = tileSize;
+
+        pixelBufferBytes_ = static_cast<size_t>(side) * side * 4;
+        if (!loadPixelBuffers_()) {
+            spdlog::debug("Thumbnail atlas: pixel-buffer objects unavailable, reading back synchronously");
+        }
+        spdlog::debug("Thumbnail atlas: {}x{} px, {} tiles of {} px", side, side, capacity(), tileSize);
+        return true;
+    }
+
+    void GpuTileAtlas::beginPass() {
+        BeginTextureMode(target_);
+        ClearBackground(BLANK);
+    }
+
+    void GpuTileAtlas::beginTile(const uint32_t index) {
+        const auto column = static_cast<int>(index % tilesPerRow_);
+        const auto row = static_cast<int>(index / tilesPerRow_);
+        const auto size = static_cast<int>(tileSize_);
+        rlViewport(column * size, row * size, size, size);
+    }
+
+    void GpuTileAtlas::endPass() {
+        EndTextureMode();
+    }
+
+    GpuTileAtlas::Readback GpuTileAtlas::readback(const uint32_t tileCount) {
+        Readback result;
+        result.slot = nextSlot_;
+        result.tileCount = std::min(tileCount, capacity());
+        nextSlot_ ^= 1;
+        if (result.tileCount == 0) {
+            return result;
+        }
+
+        const uint32_t rows = (result.tileCount + tilesPerRow_ - 1) / tilesPerRow_;
+        const uint32_t columns = rows > 1 ? tilesPerRow_ : result.tileCount;
+        result.width = static_cast<int>(columns * tileSize_);
+        result.height = static_cast<int>(rows * tileSize_);
+
+        if (pixelBuffersSupported_) {
+            // Only the used rectangle is copied; the copy runs on the GPU after the draws before it
+            rlEnableFramebuffer(target_.id);
+            gl.bindBuffer(kGlPixelPackBuffer, pixelBuffers_[result.slot]);
+            gl.readPixels(0, 0, result.width, result.height, kGlRgba, kGlUnsignedByte, nullptr);
+            gl.bindBuffer(kGlPixelPackBuffer, 0);
+            rlDisableFramebuffer();
+            return result;
+        }
+
+        const int side = target_.texture.width;
+        auto* pixels = static_cast<uint8_t*>(
+            rlReadTexturePixels(target_.texture.id, side, side, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8));
+        result.width = side;
+        result.height = side;
+        auto& buffer = syncPixels_[result.slot];
+        if (pixels) {
+            buffer.assign(pixels, pixels + static_cast<size_t>(side) * side * 4);
+            MemFree(pixels);
+        }
+        else {
+            buffer.clear();
+        }
+        return result;
+    }
+
+    const uint8_t* GpuTileAtlas::pixels(const Readback& readback) {
+        if (readback.tileCount == 0 || readback.slot < 0) {
+            return nullptr;
+        }
+        if (!pixelBuffersSupported_) {
+            const auto& buffer = syncPixels_[readback.slot];
+            return buffer.empty() ? nullptr : buffer.data();
+        }
+
+        gl.bindBuffer(kGlPixelPackBuffer, pixelBuffers_[readback.slot]);
+        const auto bytes = static_cast<ptrdiff_t>(readback.width) * readback.height * 4;
+        const auto* mapped = static_cast<const uint8_t*>(
+            gl.mapBufferRange(kGlPixelPackBuffer, 0, bytes, kGlMapReadBit));
+        if (!mapped) {
+            gl.bindBuffer(kGlPixelPackBuffer, 0);
+        }
+        mapped_ = mapped != nullptr;
+        return mapped;
+    }
+
+    void GpuTileAtlas::release(const Readback&) {
+        // A failed map already unbound the buffer, and unmapping a buffer that is not mapped is a GL error
+        if (!mapped_) {
+            return;
+        }
+        gl.unmapBuffer(kGlPixelPackBuffer);
+        gl.bindBuffer(kGlPixelPackBuffer, 0);
+        mapped_ = false;
+    }
+
+    Image GpuTileAtlas::tileImage(const uint8_t* pixels, const Readback& readback, const uint32_t index) const {
+        Image image{};
+        if (!pixels || index >= readback.tileCount) {
+            return image;
+        }
+
+        const size_t rowBytes = static_cast<size_t>(tileSize_) * 4;
+        image.data = MemAlloc(static_cast<unsigned int>(rowBytes * tileSize_));
+        if (!image.data) {
+            return image;
+        }
+        image.width = static_cast<int>(tileSize_);
+        image.height = static_cast<int>(tileSize_);
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+
+        const uint32_t column = index % tilesPerRow_;
+        const uint32_t row = index / tilesPerRow_;
+        auto* out = static_cast<uint8_t*>(image.data);
+        for (uint32_t y = 0; y < tileSize_; ++y) {
+            // GL rows run bottom-up; the image is top-down
+            const size_t sourceRow = static_cast<size_t>(row) * tileSize_ + (tileSize_ - 1 - y);
+            const size_t sourceOffset = sourceRow * readback.width + static_cast<size_t>(column) * tileSize_;
+            const uint8_t* source = pixels + sourceOffset * 4;
+            std::memcpy(out + y * rowBytes, source, rowBytes);
+        }
+        return image;
+    }
+
+    void GpuTileAtlas::unload_() {
+        if (pixelBuffersSupported_) {
+            gl.deleteBuffers(2, pixelBuffers_.data());
+            pixelBuffers_ = {};
+            pixelBuffersSupported_ = false;
+        }
+        if (target_.id != 0) {
+            UnloadRenderTexture(target_);
+            target_ = {};
+        }
+        tileSize_ = 0;
+        tilesPerRow_ = 0;
+        nextSlot_ = 0;
+        mapped_ = false;
+        syncPixels_[0].clear();
+        syncPixels_[1].clear();
+    }
+
+    bool GpuTileAtlas::loadPixelBuffers_() {
+        if (!gl.complete()) {
+            LoadGlFunction(gl.genBuffers, "glGenBuffers");
+            LoadGlFunction(gl.deleteBuffers, "glDeleteBuffers");
+            LoadGlFunction(gl.bindBuffer, "glBindBuffer");
+            LoadGlFunction(gl.bufferData, "glBufferData");
+            LoadGlFunction(gl.mapBufferRange, "glMapBufferRange");
+            LoadGlFunction(gl.unmapBuffer, "glUnmapBuffer");
+            LoadGlFunction(gl.readPixels, "glReadPixels");
+        }
+        if (!gl.complete()) {
+            return false;
+        }
+
+        gl.genBuffers(2, pixelBuffers_.data());
+        for (const auto buffer : pixelBuffers_) {
+            gl.bindBuffer(kGlPixelPackBuffer, buffer);
+            gl.bufferData(kGlPixelPackBuffer, static_cast<ptrdiff_t>(pixelBufferBytes_), nullptr, kGlStreamRead);
+        }
+        gl.bindBuffer(kGlPixelPackBuffer, 0);
+        pixelBuffersSupported_ = pixelBuffers_[0] != 0 && pixelBuffers_[1] != 0;
+        return pixelBuffersSupported_;
+    }
+} // namespace thumb
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "raylib.h"
+
+namespace thumb {
+    // One large render target that thumbnails are drawn into side by side, one square tile each, so a
+    // whole batch of models costs a single target and a single readback.
+    //
+    // Readbacks go through two pixel-buffer objects. readback() of one pass only queues the copy; the
+    // pixels are mapped later by pixels(), ideally after the next pass was drawn into the target, so the
+    // GPU renders while the CPU crops the previous tiles. Without pixel-buffer support the whole target
+    // is read synchronously instead.
+    //
+    // Needs raylib's GL context to be current, like everything else in ThumbnailRenderer's GPU path.
+    class GpuTileAtlas {
+    public:
+        struct Readback {
+            int slot = -1;          // Pixel buffer holding the pixels; -1 for a synchronous read
+            uint32_t tileCount = 0;
+            int width = 0;          // Size of the rectangle read, from the bottom-left corner
+            int height = 0;
+        };
+
+        GpuTileAtlas() = default;
+        ~GpuTileAtlas();
+        GpuTileAtlas(const GpuTileAtlas&) = delete;
+        GpuTileAtlas& operator=(const GpuTileAtlas&) = delete;
+
+        // Makes the target fit tiles of tileSize pixels, reusing it when it already does
+        bool prepare(uint32_t tileSize);
+        [[nodiscard]] uint32_t capacity() const { return tilesPerRow_ * tilesPerRow_; }
+
+        // Binds and clears the target; draw each tile between beginTile and EndMode3D
+        void beginPass();
+        // Restricts drawing to a tile; call before BeginMode3D
+        void beginTile(uint32_t index);
+        void endPass();
+
+        // Queues the copy of tiles [0, tileCount) of the pass just drawn
+        Readback readback(uint32_t tileCount);
+        // Waits for a readback and returns its pixels, rows bottom-up as GL stores them, or nullptr when
+        // they could not be read. Valid until release(); only one readback can be mapped at a time.
+        const uint8_t* pixels(const Readback& readback);
+        void release(const Readback& readback);
+        // Copies a tile out of mapped pixels as a top-down RGBA8 image; the caller unloads it
+        [[nodiscard]] Image tileImage(const uint8_t* pixels, const Readback& readback, uint32_t index) const;
+
+    private:
+        void unload_();
+        bool loadPixelBuffers_();
+
+        RenderTexture2D target_{};
+        uint32_t tileSize_ = 0;
+        uint32_t tilesPerRow_ = 0;
+        std::array<uint32_t, 2> pixelBuffers_{};
+        size_t pixelBufferBytes_ = 0;
+        int nextSlot_ = 0;
+        bool pixelBuffersSupported_ = false;
+        bool mapped_ = false; // Whether pixels() mapped a pixel buffer that release() has to unmap
+        std::array<std::vector<uint8_t>, 2> syncPixels_; // Per slot, without pixel-buffer support
+    };
+} // namespace thumb
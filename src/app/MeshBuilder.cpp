@@ -129,23 +129,62 @@ namespace thumb {
         return expanded;
     }
 
+    bool MeshBuilder::buildVertices(const MeshSource& source,
+                                    const Vector3& center,
+                                    const float yLift,
+                                    MeshVertices& vertices,
+                                    const bool preserveOriginalSpace) {
+        if (!source.vertexBuffer || !source.indexBuffer || !source.primitiveBlock) {
+            return false;
+        }
+
+        vertices.indices = expandPrimitives(*source.primitiveBlock, source.indexBuffer->indices);
+        if (source.vertexBuffer->vertices.empty() || vertices.indices.size() < 3) {
+            return false;
+        }
+
+        const float yOffset = preserveOriginalSpace ? 0.0f : yLift;
+        const size_t vertexCount = source.vertexBuffer->vertices.size();
+        vertices.positions.resize(vertexCount);
+        vertices.texcoords.resize(vertexCount);
+        vertices.colors.resize(vertexCount);
+
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const auto& vert = source.vertexBuffer->vertices[i];
+            if (preserveOriginalSpace) {
+                vertices.positions[i] = Vector3{vert.position.x, vert.position.y, vert.position.z};
+            }
+            else {
+                vertices.positions[i] = Vector3{
+                    vert.position.x - center.x,
+                    vert.position.y - center.y + yOffset,
+                    vert.position.z - center.z
+                };
+            }
+            vertices.texcoords[i] = Vector2{vert.uv.x, vert.uv.y};
+            vertices.colors[i] = Color{
+                static_cast<unsigned char>(vert.color.x * 255.0f),
+                static_cast<unsigned char>(vert.color.y * 255.0f),
+                static_cast<unsigned char>(vert.color.z * 255.0f),
+                static_cast<unsigned char>(vert.color.w * 255.0f)
+            };
+        }
+        return true;
+    }
+
     bool MeshBuilder::buildMeshFromSource(const MeshSource& source,
                                           const Vector3& center,
                                           const float yLift,
                                           Mesh& mesh,
                                           const bool preserveOriginalSpace) {
-        if (!source.vertexBuffer || !source.indexBuffer || !source.primitiveBlock) {
-            return false;
-        }
-
-        const auto expandedIndices = expandPrimitives(*source.primitiveBlock,
-                                                      source.indexBuffer->indices);
-        if (source.vertexBuffer->vertices.empty() || expandedIndices.size() < 3) {
+        MeshVertices vertices;
+        if (!buildVertices(source, center, yLift, vertices, preserveOriginalSpace)) {
             return false;
         }
+        const auto& expandedIndices = vertices.indices;
 
         mesh = {};
-        mesh.vertexCount = static_cast<int>(source.vertexBuffer->vertices.size());
+        mesh.vertexCount = static_cast<int>(vertices.positions.size());
         mesh.triangleCount = static_cast<int>(expandedIndices.size() / 3);
         mesh.vertices = static_cast<float*>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
         mesh.normals = static_cast<float*>(MemAlloc(mesh.vertexCount * 3 * sizeof(float)));
@@ -159,26 +198,16 @@ namespace thumb {
             return false;
         }
 
-        const float yOffset = preserveOriginalSpace ? 0.0f : yLift;
-
         for (int i = 0; i < mesh.vertexCount; ++i) {
-            const auto& vert = source.vertexBuffer->vertices[i];
-            if (preserveOriginalSpace) {
-                mesh.vertices[i * 3 + 0] = vert.position.x;
-                mesh.vertices[i * 3 + 1] = vert.position.y;
-                mesh.vertices[i * 3 + 2] = vert.position.z;
-            }
-            else {
-                mesh.vertices[i * 3 + 0] = vert.position.x - center.x;
-                mesh.vertices[i * 3 + 1] = vert.position.y - center.y + yOffset;
-                mesh.vertices[i * 3 + 2] = vert.position.z - center.z;
-            }
-            mesh.texcoords[i * 2 + 0] = vert.uv.x;
-            mesh.texcoords[i * 2 + 1] = vert.uv.y;
-            mesh.colors[i * 4 + 0] = static_cast<unsigned char>(vert.color.x * 255.0f);
-            mesh.colors[i * 4 + 1] = static_cast<unsigned char>(vert.color.y * 255.0f);
-            mesh.colors[i * 4 + 2] = static_cast<unsigned char>(vert.color.z * 255.0f);
-            mesh.colors[i * 4 + 3] = static_cast<unsigned char>(vert.color.w * 255.0f);
+            mesh.vertices[i * 3 + 0] = vertices.positions[i].x;
+            mesh.vertices[i * 3 + 1] = vertices.positions[i].y;
+            mesh.vertices[i * 3 + 2] = vertices.positions[i].z;
+            mesh.texcoords[i * 2 + 0] = vertices.texcoords[i].x;
+            mesh.texcoords[i * 2 + 1] = vertices.texcoords[i].y;
+            mesh.colors[i * 4 + 0] = vertices.colors[i].r;
+            mesh.colors[i * 4 + 1] = vertices.colors[i].g;
+            mesh.colors[i * 4 + 2] = vertices.colors[i].b;
+            mesh.colors[i * 4 + 3] = vertices.colors[i].a;
         }
 
         std::memcpy(mesh.indices, expandedIndices.data(),
@@ -14,12 +14,25 @@ namespace thumb {
         const S3D::Material* material = nullptr;
     };
 
+    // Vertex data of one mesh in model space, before it is uploaded or rasterised
+    struct MeshVertices {
+        std::vector<Vector3> positions;
+        std::vector<Vector2> texcoords;
+        std::vector<Color> colors;
+        std::vector<uint16_t> indices; // Triangle list
+    };
+
     class MeshBuilder {
     public:
         static Vector3 calculateModelCenter(const S3D::Record& record);
         static std::vector<MeshSource> collectMeshSources(const S3D::Record& record);
         static std::vector<uint16_t> expandPrimitives(const S3D::PrimitiveBlock& primitives,
                                                       std::span<const uint16_t> source);
+        static bool buildVertices(const MeshSource& source,
+                                  const Vector3& center,
+                                  float yLift,
+                                  MeshVertices& vertices,
+                                  bool preserveOriginalSpace = false);
         static bool buildMeshFromSource(const MeshSource& source,
                                         const Vector3& center,
                                         float yLift,
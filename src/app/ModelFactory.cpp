@@ -2,6 +2,7 @@
 
 #include "MeshBuilder.hpp"
 #include "raymath.h"
+#include "TextureCache.hpp"
 #include "TextureLoader.hpp"
 #include "spdlog/spdlog.h"
 
@@ -30,7 +31,8 @@ namespace thumb {
         const bool nightMode,
         const bool nightOverlay,
         const float rotationDegrees,
-        const std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)>& extraTextureLookup) const {
+        const std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)>& extraTextureLookup,
+        const uint32_t fileIndex) const {
         if (record.animation.animatedMeshes.empty() && record.vertexBuffers.empty()) {
             return nullptr;
         }
@@ -98,12 +100,31 @@ namespace thumb {
 
             if (matInfo) {
                 for (const auto& texInfo : matInfo->textures) {
-                    auto texture = TextureLoader::loadTextureForMaterial(reader,
-                                                                             tgi,
-                                                                             texInfo.textureID,
-                                                                             nightMode,
-                                                                             nightOverlay,
-                                                                             extraTextureLookup);
+                    std::optional<Texture2D> texture;
+                    if (textureCache_) {
+                        const TextureCache::Key key{
+                            .fileIndex = fileIndex,
+                            .group = tgi.group,
+                            .instance = texInfo.textureID,
+                            .nightMode = nightMode,
+                            .nightOverlay = nightOverlay,
+                        };
+                        const auto image = textureCache_->get(key, [&] {
+                            return TextureLoader::loadImageForMaterial(reader, tgi, texInfo.textureID, nightMode,
+                                                                       nightOverlay, extraTextureLookup);
+                        });
+                        if (image) {
+                            texture = TextureLoader::uploadImage(*image);
+                        }
+                    }
+                    else {
+                        texture = TextureLoader::loadTextureForMaterial(reader,
+                                                                        tgi,
+                                                                        texInfo.textureID,
+                                                                        nightMode,
+                                                                        nightOverlay,
+                                                                        extraTextureLookup);
+                    }
                     if (texture.has_value()) {
                         if (previewMode) {
                             SetTextureWrap(*texture, TEXTURE_WRAP_CLAMP);
@@ -10,6 +10,8 @@
 #include "raylib.h"
 
 namespace thumb {
+    class TextureCache;
+
     struct LoadedModelHandle {
         Model model{};
         std::vector<Texture2D> textures;
@@ -19,6 +21,10 @@ namespace thumb {
 
     class ModelFactory {
     public:
+        // Decoded textures are shared through textureCache when one is given
+        explicit ModelFactory(TextureCache* textureCache = nullptr) : textureCache_(textureCache) {}
+
+        // fileIndex is the file record and reader come from; it keys the texture cache
         std::shared_ptr<LoadedModelHandle> build(
             const S3D::Record& record,
             DBPF::Tgi tgi,
@@ -27,6 +33,10 @@ namespace thumb {
             bool nightMode,
             bool nightOverlay,
             float rotationDegrees,
-            const std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)>& extraTextureLookup = {}) const;
+            const std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)>& extraTextureLookup = {},
+            uint32_t fileIndex = 0) const;
+
+    private:
+        TextureCache* textureCache_;
     };
 } // namespace thumb
@@ -0,0 +1,101 @@
+#include "ParseCache.hpp"
+
+#include <rfl/cbor.hpp>
+
+#include "spdlog/spdlog.h"
+
+std::unordered_map<std::string, ParseCacheFile> LoadParseCache(const std::filesystem::path& path,
+                                                               const std::string& cacheSignature) {
+    std::unordered_map<std::string, ParseCacheFile> files;
+
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return files;
+    }
+
+    auto result = rfl::cbor::load<ParseCacheData>(path.string());
+    if (!result) {
+        spdlog::warn("Ignoring unreadable parse cache {}: {}", path.string(), result.error().what());
+        return files;
+    }
+    if (result->version != kParseCacheVersion || result->cacheSignature != cacheSignature) {
+        spdlog::info("Parse cache {} was built with different options, reparsing everything", path.string());
+        return files;
+    }
+
+    files.reserve(result->files.size());
+    for (auto& file : result->files) {
+        auto key = file.filePath;
+        files.insert_or_assign(std::move(key), std::move(file));
+    }
+    return files;
+}
+
+ParseCacheWriter::ParseCacheWriter(const std::filesystem::path& path, const std::string& cacheSignature)
+    : writer_(path) {
+    if (!writer_.isOpen()) {
+        spdlog::error("Failed to open parse cache for writing: {}", path.string());
+        return;
+    }
+    writer_.beginMap<ParseCacheData>();
+    writer_.field("version", kParseCacheVersion);
+    writer_.field("cacheSignature", cacheSignature);
+    writer_.key("files");
+    writer_.beginArray();
+}
+
+bool ParseCacheWriter::isOpen() const {
+    return writer_.isOpen();
+}
+
+void ParseCacheWriter::add(const ParseCacheFile& file) {
+    if (writer_.isOpen()) {
+        writer_.append(file);
+    }
+}
+
+bool ParseCacheWriter::commit() {
+    try {
+        if (!writer_.isOpen()) {
+            writer_.discard();
+            return false;
+        }
+        writer_.endArray();
+        if (!writer_.commit()) {
+            spdlog::error("Error writing parse cache {}", writer_.path().string());
+            return false;
+        }
+        return true;
+    }
+    catch (const std::exception& error) {
+        spdlog::error("Error writing parse cache {}: {}", writer_.path().string(), error.what());
+        writer_.discard();
+        return false;
+    }
+}
+
+bool IsParseRecordCurrent(const ParseCacheRecord& record,
+                          const std::unordered_set<DBPF::Tgi, DBPF::TgiHash>& changedTgis) {
+    if (changedTgis.empty()) {
+        return true;
+    }
+
+    const auto& deps = record.dependencies;
+    for (size_t i = 0; i + 2 < deps.size(); i += 3) {
+        if (changedTgis.contains(DBPF::Tgi{deps[i], deps[i + 1], deps[i + 2]})) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint32_t> FlattenTgis(const std::span<const DBPF::Tgi> tgis) {
+    std::vector<uint32_t> flat;
+    flat.reserve(tgis.size() * 3);
+    for (const auto& tgi : tgis) {
+        flat.push_back(tgi.type);
+        flat.push_back(tgi.group);
+        flat.push_back(tgi.instance);
+    }
+    return flat;
+}
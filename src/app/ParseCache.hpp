@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "TGI.h"
+#include "../shared/catalog_writer.hpp"
+#include "../shared/entities.hpp"
+
+constexpr auto kParseCacheFileName = "parse_cache.cbor";
+constexpr uint32_t kParseCacheVersion = 4;
+
+// What the first scan pass produced for one exemplar or cohort
+enum class ParsedRecordKind {
+    None,
+    PropFamily,
+    Building,
+    LotConfig,
+    Prop,
+    Flora,
+};
+
+struct ParseCacheRecord {
+    uint32_t type = 0;
+    uint32_t group = 0;
+    uint32_t instance = 0;
+    ParsedRecordKind kind = ParsedRecordKind::None;
+    // False for props/flora skipped as duplicates; they are parsed on demand once they no longer are
+    bool parsed = true;
+    std::optional<PropFamilyInfo> propFamily;
+    std::optional<Building> building;
+    std::vector<uint32_t> buildingFamilyIds;
+    std::optional<Prop> prop;
+    std::optional<Flora> flora;
+    // Model rendered as the thumbnail of the building, prop or flora, as a flattened (type, group, instance)
+    // triple; empty when it has none or an icon. Such thumbnails are not kept with the record, since the
+    // render cache already holds them; they are fetched from it again when the record is reused.
+    std::vector<uint32_t> thumbnailModel;
+    // Lot configurations keep what the lot-config pass needs, so it never loads them again; the
+    // building they belong to is resolved from lotBuildingReference once every building is known
+    std::optional<Lot> lot;
+    uint32_t lotBuildingReference = 0;
+    // Entries resolved through the index while parsing (cohort parents, LTEXT, icons, models, textures),
+    // as flattened (type, group, instance) triples
+    std::vector<uint32_t> dependencies;
+};
+
+struct ParseCacheFile {
+    std::string filePath;
+    uint64_t fileSize = 0;
+    int64_t lastWriteTicks = 0;
+    std::vector<ParseCacheRecord> records;
+};
+
+struct ParseCacheData {
+    uint32_t version = kParseCacheVersion;
+    std::string cacheSignature;
+    std::vector<ParseCacheFile> files;
+};
+
+// Loads the parse cache, keyed by PluginPathKey. Returns an empty map when the file is missing,
+// unreadable, or was written with a different version or cache signature.
+[[nodiscard]] std::unordered_map<std::string, ParseCacheFile> LoadParseCache(const std::filesystem::path& path,
+                                                                           const std::string& cacheSignature);
+
+// Writes a ParseCacheData file one plugin file at a time, as the first pass finishes each of them
+class ParseCacheWriter {
+public:
+    ParseCacheWriter(const std::filesystem::path& path, const std::string& cacheSignature);
+
+    [[nodiscard]] bool isOpen() const;
+    void add(const ParseCacheFile& file);
+    // Replaces the previous parse cache; returns false if it could not be written
+    bool commit();
+
+private:
+    CatalogWriter writer_;
+};
+
+// A cached record is reusable when none of the entries it depends on changed since it was parsed
+[[nodiscard]] bool IsParseRecordCurrent(const ParseCacheRecord& record,
+                                        const std::unordered_set<DBPF::Tgi, DBPF::TgiHash>& changedTgis);
+
+[[nodiscard]] std::vector<uint32_t> FlattenTgis(std::span<const DBPF::Tgi> tgis);
@@ -0,0 +1,543 @@
+#include "PixelKernels.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define THUMB_PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define THUMB_PIXEL_KERNELS_X86 0
+#endif
+
+// MSVC allows intrinsics of any instruction set in any function; GCC and Clang need them enabled per function
+#if THUMB_PIXEL_KERNELS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define THUMB_TARGET_SSE2 __attribute__((target("sse2")))
+#define THUMB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define THUMB_TARGET_SSE2
+#define THUMB_TARGET_AVX2
+#endif
+
+namespace thumb {
+    namespace {
+        // Scalar kernels. These define the output; the vector kernels below must match them byte for byte.
+
+        void SwapRedBlueScalar(const uint8_t* src, uint8_t* dst, const size_t pixelCount) {
+            for (size_t i = 0; i < pixelCount * 4; i += 4) {
+                const uint8_t r = src[i + 0];
+                dst[i + 0] = src[i + 2];
+                dst[i + 1] = src[i + 1];
+                dst[i + 2] = r;
+                dst[i + 3] = src[i + 3];
+            }
+        }
+
+        void BlendOverlayScalar(uint8_t* base, const uint8_t* overlay, const size_t pixelCount) {
+            for (size_t i = 0; i < pixelCount * 4; i += 4) {
+                const float a = static_cast<float>(overlay[i + 3]) / 255.0f;
+                const float keep = 1.0f - a;
+                for (size_t c = 0; c < 3; ++c) {
+                    const float baseTerm = static_cast<float>(base[i + c]) * keep;
+                    const float overlayTerm = static_cast<float>(overlay[i + c]) * a;
+                    base[i + c] = static_cast<uint8_t>(baseTerm + overlayTerm);
+                }
+                base[i + 3] = std::max(base[i + 3], overlay[i + 3]);
+            }
+        }
+
+        // First and last visible pixel of a row; false when there is none
+        bool FindRowAlphaScalar(const uint8_t* row, const int width, const uint8_t threshold, int& first, int& last) {
+            first = 0;
+            while (first < width && row[first * 4 + 3] < threshold) {
+                ++first;
+            }
+            if (first == width) {
+                return false;
+            }
+            last = width - 1;
+            while (row[last * 4 + 3] < threshold) {
+                --last;
+            }
+            return true;
+        }
+
+        // Source pixels one destination column or row covers, and the share of it each of them covers
+        struct AreaSpan {
+            uint32_t first;
+            uint32_t count;
+            uint32_t weightOffset; // Into AreaTaps::weights
+        };
+
+        struct AreaTaps {
+            std::vector<AreaSpan> spans;
+            std::vector<float> weights;
+        };
+
+        // Every destination pixel averages the source area it covers, so each span's weights sum to one
+        AreaTaps ComputeAreaTaps(const uint32_t srcSize, const uint32_t dstSize) {
+            AreaTaps taps;
+            taps.spans.reserve(dstSize);
+            taps.weights.reserve(static_cast<size_t>(dstSize) * (srcSize / dstSize + 2));
+            const double scale = static_cast<double>(srcSize) / static_cast<double>(dstSize);
+            for (uint32_t i = 0; i < dstSize; ++i) {
+                const double start = i * scale;
+                const double end = std::min((i + 1) * scale, static_cast<double>(srcSize));
+                AreaSpan span{
+                    .first = std::min(static_cast<uint32_t>(start), srcSize - 1),
+                    .count = 0,
+                    .weightOffset = static_cast<uint32_t>(taps.weights.size())
+                };
+                for (uint32_t s = span.first; s < srcSize && s < end; ++s) {
+                    const double covered = std::min(end, s + 1.0) - std::max(start, static_cast<double>(s));
+                    if (covered <= 0.0) {
+                        continue;
+                    }
+                    if (span.count == 0) {
+                        span.first = s;
+                    }
+                    taps.weights.push_back(static_cast<float>(covered / scale));
+                    ++span.count;
+                }
+                taps.spans.push_back(span);
+            }
+            return taps;
+        }
+
+        // Back from premultiplied to straight alpha, rounded to the nearest byte
+        void StoreAreaPixelScalar(const float* sum, uint8_t* dst) {
+            if (sum[3] <= 0.0f) {
+                std::memset(dst, 0, 4);
+                return;
+            }
+            for (int c = 0; c < 4; ++c) {
+                const float value = c < 3 ? sum[c] / sum[3] : sum[3];
+                dst[c] = static_cast<uint8_t>(std::min(value + 0.5f, 255.0f));
+            }
+        }
+
+        void ResizeAreaRowScalar(const uint8_t* src, const size_t srcStride, const AreaSpan& row,
+                                 const float* rowWeights, const AreaTaps& columns, uint8_t* dstRow) {
+            for (size_t x = 0; x < columns.spans.size(); ++x) {
+                const auto& column = columns.spans[x];
+                const float* columnWeights = columns.weights.data() + column.weightOffset;
+                float sum[4] = {};
+                for (uint32_t j = 0; j < row.count; ++j) {
+                    const uint8_t* srcPixel = src + (row.first + j) * srcStride + static_cast<size_t>(column.first) * 4;
+                    for (uint32_t i = 0; i < column.count; ++i, srcPixel += 4) {
+                        const float weight = rowWeights[j] * columnWeights[i];
+                        const float alpha = static_cast<float>(srcPixel[3]);
+                        for (int c = 0; c < 4; ++c) {
+                            const float premultiplied = static_cast<float>(srcPixel[c]) * (c < 3 ? alpha : 1.0f);
+                            sum[c] = sum[c] + premultiplied * weight;
+                        }
+                    }
+                }
+                StoreAreaPixelScalar(sum, dstRow + x * 4);
+            }
+        }
+
+#if THUMB_PIXEL_KERNELS_X86
+        THUMB_TARGET_SSE2 void SwapRedBlueSse2(const uint8_t* src, uint8_t* dst, const size_t pixelCount) {
+            const __m128i keepMask = _mm_set1_epi32(static_cast<int>(0xFF00FF00u));
+            const __m128i lowMask = _mm_set1_epi32(0x000000FF);
+            size_t i = 0;
+            for (; i + 4 <= pixelCount; i += 4) {
+                const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+                const __m128i red = _mm_slli_epi32(_mm_and_si128(p, lowMask), 16);
+                const __m128i blue = _mm_and_si128(_mm_srli_epi32(p, 16), lowMask);
+                const __m128i swapped = _mm_or_si128(_mm_and_si128(p, keepMask), _mm_or_si128(red, blue));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), swapped);
+            }
+            SwapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+        }
+
+        // One pixel as four floats, alpha last
+        THUMB_TARGET_SSE2 __m128 BlendPixelSse2(const __m128 base, const __m128 overlay) {
+            const __m128 a = _mm_div_ps(_mm_shuffle_ps(overlay, overlay, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(255.0f));
+            const __m128 keep = _mm_sub_ps(_mm_set1_ps(1.0f), a);
+            return _mm_add_ps(_mm_mul_ps(base, keep), _mm_mul_ps(overlay, a));
+        }
+
+        THUMB_TARGET_SSE2 void BlendOverlaySse2(uint8_t* base, const uint8_t* overlay, const size_t pixelCount) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            size_t i = 0;
+            for (; i + 4 <= pixelCount; i += 4) {
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i * 4));
+                const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(overlay + i * 4));
+                const __m128i b16[2] = {_mm_unpacklo_epi8(b, zero), _mm_unpackhi_epi8(b, zero)};
+                const __m128i o16[2] = {_mm_unpacklo_epi8(o, zero), _mm_unpackhi_epi8(o, zero)};
+                __m128i blended[4];
+                for (int half = 0; half < 2; ++half) {
+                    for (int pixel = 0; pixel < 2; ++pixel) {
+                        const __m128i bp = pixel == 0 ? _mm_unpacklo_epi16(b16[half], zero)
+                                                      : _mm_unpackhi_epi16(b16[half], zero);
+                        const __m128i op = pixel == 0 ? _mm_unpacklo_epi16(o16[half], zero)
+                                                      : _mm_unpackhi_epi16(o16[half], zero);
+                        blended[half * 2 + pixel] = _mm_cvttps_epi32(
+                            BlendPixelSse2(_mm_cvtepi32_ps(bp), _mm_cvtepi32_ps(op)));
+                    }
+                }
+                const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(blended[0], blended[1]),
+                                                        _mm_packs_epi32(blended[2], blended[3]));
+                const __m128i alpha = _mm_and_si128(_mm_max_epu8(b, o), alphaMask);
+                const __m128i result = _mm_or_si128(_mm_andnot_si128(alphaMask, packed), alpha);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(base + i * 4), result);
+            }
+            BlendOverlayScalar(base + i * 4, overlay + i * 4, pixelCount - i);
+        }
+
+        // Bit i is set when pixel i of the four at p is visible
+        THUMB_TARGET_SSE2 int VisibleMaskSse2(const uint8_t* p, const __m128i belowThreshold) {
+            const __m128i alpha = _mm_srli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), 24);
+            return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(alpha, belowThreshold)));
+        }
+
+        THUMB_TARGET_SSE2 bool FindRowAlphaSse2(const uint8_t* row, const int width, const uint8_t threshold,
+                                                int& first, int& last) {
+            const __m128i belowThreshold = _mm_set1_epi32(static_cast<int>(threshold) - 1);
+            const int vectorEnd = width & ~3;
+            first = -1;
+            for (int x = 0; x < vectorEnd; x += 4) {
+                if (const int mask = VisibleMaskSse2(row + static_cast<size_t>(x) * 4, belowThreshold)) {
+                    first = x + std::countr_zero(static_cast<unsigned>(mask));
+                    break;
+                }
+            }
+            if (first < 0) {
+                // Only the tail can hold visible pixels
+                int tailFirst = 0;
+                int tailLast = 0;
+                if (!FindRowAlphaScalar(row + static_cast<size_t>(vectorEnd) * 4, width - vectorEnd, threshold,
+                                        tailFirst, tailLast)) {
+                    return false;
+                }
+                first = vectorEnd + tailFirst;
+                last = vectorEnd + tailLast;
+                return true;
+            }
+            for (last = width - 1; last >= vectorEnd; --last) {
+                if (row[static_cast<size_t>(last) * 4 + 3] >= threshold) {
+                    return true;
+                }
+            }
+            for (int x = vectorEnd - 4; x >= 0; x -= 4) {
+                if (const int mask = VisibleMaskSse2(row + static_cast<size_t>(x) * 4, belowThreshold)) {
+                    last = x + 31 - std::countl_zero(static_cast<unsigned>(mask));
+                    return true;
+                }
+            }
+            return true; // Not reached: the pixel at first is visible
+        }
+
+        // One pixel per register, with the same operations in the same order as the scalar kernel
+        THUMB_TARGET_SSE2 void ResizeAreaRowSse2(const uint8_t* src, const size_t srcStride, const AreaSpan& row,
+                                                 const float* rowWeights, const AreaTaps& columns, uint8_t* dstRow) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128 alphaLane = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+            const __m128 one = _mm_set1_ps(1.0f);
+            const __m128 half = _mm_set1_ps(0.5f);
+            const __m128 max = _mm_set1_ps(255.0f);
+            for (size_t x = 0; x < columns.spans.size(); ++x) {
+                const auto& column = columns.spans[x];
+                const float* columnWeights = columns.weights.data() + column.weightOffset;
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t j = 0; j < row.count; ++j) {
+                    const uint8_t* srcPixel = src + (row.first + j) * srcStride + static_cast<size_t>(column.first) * 4;
+                    for (uint32_t i = 0; i < column.count; ++i, srcPixel += 4) {
+                        const __m128 weight = _mm_set1_ps(rowWeights[j] * columnWeights[i]);
+                        int packed;
+                        std::memcpy(&packed, srcPixel, 4);
+                        const __m128 pixel = _mm_cvtepi32_ps(
+                            _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero));
+                        const __m128 alpha = _mm_shuffle_ps(pixel, pixel, _MM_SHUFFLE(3, 3, 3, 3));
+                        const __m128 factor = _mm_or_ps(_mm_and_ps(alphaLane, one), _mm_andnot_ps(alphaLane, alpha));
+                        sum = _mm_add_ps(sum, _mm_mul_ps(_mm_mul_ps(pixel, factor), weight));
+                    }
+                }
+
+                uint8_t* dstPixel = dstRow + x * 4;
+                const __m128 coverage = _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 3, 3));
+                if (_mm_cvtss_f32(coverage) <= 0.0f) {
+                    std::memset(dstPixel, 0, 4);
+                    continue;
+                }
+                const __m128 divisor = _mm_or_ps(_mm_and_ps(alphaLane, one), _mm_andnot_ps(alphaLane, coverage));
+                const __m128 straight = _mm_or_ps(_mm_and_ps(alphaLane, sum),
+                                                  _mm_andnot_ps(alphaLane, _mm_div_ps(sum, divisor)));
+                const __m128i rounded = _mm_cvttps_epi32(_mm_min_ps(_mm_add_ps(straight, half), max));
+                const __m128i words = _mm_packs_epi32(rounded, rounded);
+                const int bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+                std::memcpy(dstPixel, &bytes, 4);
+            }
+        }
+
+        THUMB_TARGET_AVX2 void SwapRedBlueAvx2(const uint8_t* src, uint8_t* dst, const size_t pixelCount) {
+            const __m256i shuffle = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                                     2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+            size_t i = 0;
+            for (; i + 8 <= pixelCount; i += 8) {
+                const __m256i p = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), _mm256_shuffle_epi8(p, shuffle));
+            }
+            SwapRedBlueScalar(src + i * 4, dst + i * 4, pixelCount - i);
+        }
+
+        THUMB_TARGET_AVX2 void BlendOverlayAvx2(uint8_t* base, const uint8_t* overlay, const size_t pixelCount) {
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+            const __m256 scale = _mm256_set1_ps(255.0f);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            size_t i = 0;
+            for (; i + 4 <= pixelCount; i += 4) {
+                __m256i blended[2];
+                for (int pair = 0; pair < 2; ++pair) {
+                    const size_t offset = (i + pair * 2) * 4;
+                    const __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(base + offset))));
+                    const __m256 o = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+                        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(overlay + offset))));
+                    // Two pixels per register; the alpha shuffle stays within each pixel's 128-bit lane
+                    const __m256 a = _mm256_div_ps(_mm256_shuffle_ps(o, o, _MM_SHUFFLE(3, 3, 3, 3)), scale);
+                    const __m256 keep = _mm256_sub_ps(one, a);
+                    blended[pair] = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(b, keep), _mm256_mul_ps(o, a)));
+                }
+                const __m128i words = _mm_packs_epi32(_mm256_castsi256_si128(blended[0]),
+                                                      _mm256_extracti128_si256(blended[0], 1));
+                const __m128i words2 = _mm_packs_epi32(_mm256_castsi256_si128(blended[1]),
+                                                       _mm256_extracti128_si256(blended[1], 1));
+                const __m128i packed = _mm_packus_epi16(words, words2);
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i * 4));
+                const __m128i o = _mm_loadu_si128(reinterpret_cast<const __m128i*>(overlay + i * 4));
+                const __m128i alpha = _mm_and_si128(_mm_max_epu8(b, o), alphaMask);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(base + i * 4),
+                                 _mm_or_si128(_mm_andnot_si128(alphaMask, packed), alpha));
+            }
+            BlendOverlayScalar(base + i * 4, overlay + i * 4, pixelCount - i);
+        }
+
+        THUMB_TARGET_AVX2 int VisibleMaskAvx2(const uint8_t* p, const __m256i belowThreshold) {
+            const __m256i alpha = _mm256_srli_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), 24);
+            return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(alpha, belowThreshold)));
+        }
+
+        THUMB_TARGET_AVX2 bool FindRowAlphaAvx2(const uint8_t* row, const int width, const uint8_t threshold,
+                                                int& first, int& last) {
+            const __m256i belowThreshold = _mm256_set1_epi32(static_cast<int>(threshold) - 1);
+            const int vectorEnd = width & ~7;
+            first = -1;
+            for (int x = 0; x < vectorEnd; x += 8) {
+                if (const int mask = VisibleMaskAvx2(row + static_cast<size_t>(x) * 4, belowThreshold)) {
+                    first = x + std::countr_zero(static_cast<unsigned>(mask));
+                    break;
+                }
+            }
+            if (first < 0) {
+                int tailFirst = 0;
+                int tailLast = 0;
+                if (!FindRowAlphaScalar(row + static_cast<size_t>(vectorEnd) * 4, width - vectorEnd, threshold,
+                                        tailFirst, tailLast)) {
+                    return false;
+                }
+                first = vectorEnd + tailFirst;
+                last = vectorEnd + tailLast;
+                return true;
+            }
+            for (last = width - 1; last >= vectorEnd; --last) {
+                if (row[static_cast<size_t>(last) * 4 + 3] >= threshold) {
+                    return true;
+                }
+            }
+            for (int x = vectorEnd - 8; x >= 0; x -= 8) {
+                if (const int mask = VisibleMaskAvx2(row + static_cast<size_t>(x) * 4, belowThreshold)) {
+                    last = x + 31 - std::countl_zero(static_cast<unsigned>(mask));
+                    return true;
+                }
+            }
+            return true;
+        }
+
+        PixelIsa DetectIsa() {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int info[4] = {};
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            bool avx2 = false;
+            if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+#else
+            __builtin_cpu_init();
+            const bool sse2 = __builtin_cpu_supports("sse2");
+            const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+            if (avx2) {
+                return PixelIsa::Avx2;
+            }
+            return sse2 ? PixelIsa::Sse2 : PixelIsa::Scalar;
+        }
+#else
+        PixelIsa DetectIsa() {
+            return PixelIsa::Scalar;
+        }
+#endif
+
+        PixelIsa SupportedIsa() {
+            static const PixelIsa supported = DetectIsa();
+            return supported;
+        }
+
+        std::atomic<PixelIsa>& ActiveIsa() {
+            static std::atomic<PixelIsa> active{SupportedIsa()};
+            return active;
+        }
+
+        PixelIsa CurrentIsa() {
+            return ActiveIsa().load(std::memory_order_relaxed);
+        }
+    }
+
+    void PixelKernels::swapRedBlue(const uint8_t* src, uint8_t* dst, const size_t pixelCount) {
+#if THUMB_PIXEL_KERNELS_X86
+        switch (CurrentIsa()) {
+        case PixelIsa::Avx2:
+            SwapRedBlueAvx2(src, dst, pixelCount);
+            return;
+        case PixelIsa::Sse2:
+            SwapRedBlueSse2(src, dst, pixelCount);
+            return;
+        case PixelIsa::Scalar:
+            break;
+        }
+#endif
+        SwapRedBlueScalar(src, dst, pixelCount);
+    }
+
+    void PixelKernels::blendOverlay(uint8_t* base, const uint8_t* overlay, const size_t pixelCount) {
+#if THUMB_PIXEL_KERNELS_X86
+        switch (CurrentIsa()) {
+        case PixelIsa::Avx2:
+            BlendOverlayAvx2(base, overlay, pixelCount);
+            return;
+        case PixelIsa::Sse2:
+            BlendOverlaySse2(base, overlay, pixelCount);
+            return;
+        case PixelIsa::Scalar:
+            break;
+        }
+#endif
+        BlendOverlayScalar(base, overlay, pixelCount);
+    }
+
+    std::optional<AlphaBounds> PixelKernels::findAlphaBounds(const uint8_t* rgba, const int width, const int height,
+                                                             const uint8_t threshold) {
+        if (!rgba || width <= 0 || height <= 0) {
+            return std::nullopt;
+        }
+
+        auto findRow = &FindRowAlphaScalar;
+#if THUMB_PIXEL_KERNELS_X86
+        switch (CurrentIsa()) {
+        case PixelIsa::Avx2:
+            findRow = &FindRowAlphaAvx2;
+            break;
+        case PixelIsa::Sse2:
+            findRow = &FindRowAlphaSse2;
+            break;
+        case PixelIsa::Scalar:
+            break;
+        }
+#endif
+
+        AlphaBounds bounds{
+            .minX = width,
+            .minY = height,
+            .maxX = -1,
+            .maxY = -1
+        };
+        for (int y = 0; y < height; ++y) {
+            int first = 0;
+            int last = 0;
+            if (!findRow(rgba + static_cast<size_t>(y) * width * 4, width, threshold, first, last)) {
+                continue;
+            }
+            bounds.minX = std::min(bounds.minX, first);
+            bounds.maxX = std::max(bounds.maxX, last);
+            bounds.minY = std::min(bounds.minY, y);
+            bounds.maxY = y;
+        }
+
+        if (bounds.maxX < bounds.minX || bounds.maxY < bounds.minY) {
+            return std::nullopt;
+        }
+        return bounds;
+    }
+
+    void PixelKernels::resizeArea(const uint8_t* src, const uint32_t srcWidth, const uint32_t srcHeight,
+                                  uint8_t* dst, const uint32_t dstWidth, const uint32_t dstHeight,
+                                  const size_t dstStride) {
+        if (srcWidth == 0 || srcHeight == 0 || dstWidth == 0 || dstHeight == 0) {
+            return;
+        }
+
+        const size_t srcStride = static_cast<size_t>(srcWidth) * 4;
+        if (srcWidth == dstWidth && srcHeight == dstHeight) {
+            for (uint32_t y = 0; y < dstHeight; ++y) {
+                std::memcpy(dst + y * dstStride, src + y * srcStride, srcStride);
+            }
+            return;
+        }
+
+        auto resizeRow = &ResizeAreaRowScalar;
+#if THUMB_PIXEL_KERNELS_X86
+        // A pixel fits one SSE register, so AVX2 has nothing to add
+        if (CurrentIsa() != PixelIsa::Scalar) {
+            resizeRow = &ResizeAreaRowSse2;
+        }
+#endif
+
+        const auto columns = ComputeAreaTaps(srcWidth, dstWidth);
+        const auto rows = ComputeAreaTaps(srcHeight, dstHeight);
+        for (uint32_t y = 0; y < dstHeight; ++y) {
+            const auto& row = rows.spans[y];
+            resizeRow(src, srcStride, row, rows.weights.data() + row.weightOffset, columns, dst + y * dstStride);
+        }
+    }
+
+    PixelIsa PixelKernels::supportedIsa() {
+        return SupportedIsa();
+    }
+
+    PixelIsa PixelKernels::isa() {
+        return CurrentIsa();
+    }
+
+    PixelIsa PixelKernels::setIsa(const PixelIsa isa) {
+        const auto effective = std::min(isa, SupportedIsa());
+        ActiveIsa().store(effective, std::memory_order_relaxed);
+        return effective;
+    }
+
+    const char* PixelIsaName(const PixelIsa isa) {
+        switch (isa) {
+        case PixelIsa::Scalar:
+            return "scalar";
+        case PixelIsa::Sse2:
+            return "sse2";
+        case PixelIsa::Avx2:
+            return "avx2";
+        }
+        return "unknown";
+    }
+} // namespace thumb
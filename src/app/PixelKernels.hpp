@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace thumb {
+    // Instruction sets the pixel kernels are implemented for. Every one produces the same bytes.
+    enum class PixelIsa : uint8_t {
+        Scalar,
+        Sse2,
+        Avx2,
+    };
+
+    // Inclusive box around the pixels at or above an alpha threshold
+    struct AlphaBounds {
+        int minX;
+        int minY;
+        int maxX;
+        int maxY;
+    };
+
+    // Per-pixel loops of the thumbnail pipeline, on tightly packed 4-byte pixels. Each kernel picks the
+    // widest instruction set the CPU supports when it runs.
+    class PixelKernels {
+    public:
+        // Swaps the first and third byte of every pixel, turning RGBA into BGRA and back. src may equal dst.
+        static void swapRedBlue(const uint8_t* src, uint8_t* dst, size_t pixelCount);
+
+        // Blends an RGBA overlay over an RGBA base in place by the overlay's alpha. The result keeps the
+        // larger of both alphas, as SC4's night lights are drawn over the day texture.
+        static void blendOverlay(uint8_t* base, const uint8_t* overlay, size_t pixelCount);
+
+        // Bounds of the pixels whose alpha is at least threshold; nullopt when there are none
+        static std::optional<AlphaBounds> findAlphaBounds(const uint8_t* rgba, int width, int height,
+                                                          uint8_t threshold);
+
+        // Area (box) filter scale: every target pixel averages the source pixels it covers, weighted by
+        // coverage and by alpha, so fully transparent pixels do not darken their neighbours' edges. Target
+        // rows start dstStride bytes apart, which lets it draw straight into part of a larger image.
+        static void resizeArea(const uint8_t* src, uint32_t srcWidth, uint32_t srcHeight,
+                               uint8_t* dst, uint32_t dstWidth, uint32_t dstHeight, size_t dstStride);
+
+        // Widest instruction set this CPU and build support
+        [[nodiscard]] static PixelIsa supportedIsa();
+        [[nodiscard]] static PixelIsa isa();
+        // Limits the kernels to isa, or what the CPU supports if that is narrower. For tests and
+        // benchmarks; returns the instruction set now in use.
+        static PixelIsa setIsa(PixelIsa isa);
+    };
+
+    [[nodiscard]] const char* PixelIsaName(PixelIsa isa);
+} // namespace thumb
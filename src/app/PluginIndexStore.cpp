@@ -0,0 +1,124 @@
+#include "PluginIndexStore.hpp"
+
+#include <chrono>
+#include <ctime>
+#include <fstream>
+
+#include <rfl/cbor.hpp>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+    std::tm ToUtcTm(const std::chrono::system_clock::time_point time) {
+        const std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+        std::tm utc{};
+#ifdef _WIN32
+        gmtime_s(&utc, &seconds);
+#else
+        gmtime_r(&seconds, &utc);
+#endif
+        return utc;
+    }
+}
+
+std::optional<PluginFileStamp> StatPluginFile(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto writeTime = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return PluginFileStamp{
+        .fileSize = static_cast<uint64_t>(size),
+        .lastWriteTicks = static_cast<int64_t>(writeTime.time_since_epoch().count())
+    };
+}
+
+std::string PluginPathKey(const std::filesystem::path& path) {
+    const auto utf8 = path.generic_u8string();
+    return {utf8.begin(), utf8.end()};
+}
+
+rfl::Timestamp<"%FT%TZ"> ToIndexTimestamp(const std::filesystem::file_time_type time) {
+    const auto systemTime = std::chrono::file_clock::to_sys(time);
+    return rfl::Timestamp<"%FT%TZ">(ToUtcTm(std::chrono::time_point_cast<std::chrono::system_clock::duration>(systemTime)));
+}
+
+rfl::Timestamp<"%FT%TZ"> CurrentIndexTimestamp() {
+    return rfl::Timestamp<"%FT%TZ">(ToUtcTm(std::chrono::system_clock::now()));
+}
+
+std::optional<PluginIndex> LoadPluginIndex(const std::filesystem::path& path) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return std::nullopt;
+    }
+
+    auto result = rfl::cbor::load<PluginIndex>(path.string());
+    if (!result) {
+        spdlog::warn("Ignoring unreadable plugin index {}: {}", path.string(), result.error().what());
+        return std::nullopt;
+    }
+    if (result->version != kPluginIndexVersion) {
+        spdlog::info("Ignoring plugin index {} with version {} (expected {})",
+                     path.string(), result->version, kPluginIndexVersion);
+        return std::nullopt;
+    }
+    return std::move(*result);
+}
+
+bool SavePluginIndex(const std::filesystem::path& path, const PluginIndex& index) {
+    // Written next to the target and renamed over it, so a failed write keeps the previous index
+    auto tempPath = path;
+    tempPath += ".tmp";
+    std::error_code ec;
+    try {
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                spdlog::error("Failed to open plugin index for writing: {}", tempPath.string());
+                return false;
+            }
+            rfl::cbor::write(index, file);
+            file.close();
+            if (!file) {
+                spdlog::error("Failed to write plugin index: {}", tempPath.string());
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename(tempPath, path, ec);
+        if (ec) {
+            spdlog::error("Failed to replace plugin index {}: {}", path.string(), ec.message());
+            std::filesystem::remove(tempPath, ec);
+            return false;
+        }
+        return true;
+    }
+    catch (const std::exception& error) {
+        spdlog::error("Error writing plugin index {}: {}", path.string(), error.what());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+}
+
+bool IsPluginIndexCurrent(const PluginIndex& index, const std::span<const std::filesystem::path> files) {
+    if (index.files.size() != files.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        const auto& recorded = index.files[i];
+        if (recorded.filePath != PluginPathKey(files[i])) {
+            return false;
+        }
+        const auto stamp = StatPluginFile(files[i]);
+        if (!stamp || stamp->fileSize != recorded.fileSize || stamp->lastWriteTicks != recorded.lastWriteTicks) {
+            return false;
+        }
+    }
+    return true;
+}
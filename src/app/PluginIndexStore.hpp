@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "../shared/index.hpp"
+
+constexpr auto kPluginIndexFileName = "plugin_index.cbor";
+constexpr uint32_t kPluginIndexVersion = 1;
+
+struct PluginFileStamp {
+    uint64_t fileSize = 0;
+    int64_t lastWriteTicks = 0;
+};
+
+// Size and last write time of a plugin file, or nullopt if the file cannot be inspected
+[[nodiscard]] std::optional<PluginFileStamp> StatPluginFile(const std::filesystem::path& path);
+
+// Stable string key for a plugin path, as stored in PluginFileInfo::filePath
+[[nodiscard]] std::string PluginPathKey(const std::filesystem::path& path);
+
+[[nodiscard]] rfl::Timestamp<"%FT%TZ"> ToIndexTimestamp(std::filesystem::file_time_type time);
+[[nodiscard]] rfl::Timestamp<"%FT%TZ"> CurrentIndexTimestamp();
+
+[[nodiscard]] std::optional<PluginIndex> LoadPluginIndex(const std::filesystem::path& path);
+bool SavePluginIndex(const std::filesystem::path& path, const PluginIndex& index);
+
+// True when the given files are exactly the ones recorded in the index, in the same order and with
+// unchanged sizes and write times. Only stats the files, so it is cheap even for large installs.
+[[nodiscard]] bool IsPluginIndexCurrent(const PluginIndex& index, std::span<const std::filesystem::path> files);
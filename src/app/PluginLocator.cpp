@@ -14,6 +14,17 @@ auto PluginLocator::ListDbpfFiles() const -> std::vector<std::filesystem::path>
     return files;
 }
 
+auto LoadOrderLess(const std::filesystem::path& a, const std::filesystem::path& b) -> bool {
+    const auto aName = a.filename().native();
+    const auto bName = b.filename().native();
+    // Windows compares names ignoring case by folding them to upper case, so _ [ \ ] ^ and ` sort after
+    // the letters: z___NAM.dat loads after zzz.dat, not before it
+    return std::ranges::lexicographical_compare(aName, bName, [](const auto l, const auto r) {
+        const auto upper = [](const auto c) { return c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c; };
+        return upper(l) < upper(r);
+    });
+}
+
 auto PluginLocator::CollectFiles_(const std::filesystem::path& root, bool recursive,
                                   std::vector<std::filesystem::path>& out) -> void {
     if (root.empty())
@@ -23,11 +34,27 @@ auto PluginLocator::CollectFiles_(const std::filesystem::path& root, bool recurs
     if (!std::filesystem::exists(root, ec))
         return;
 
-    if (recursive) {
-        FindPlugins(std::filesystem::recursive_directory_iterator(root, kDirectoryOptions, ec),
-             std::filesystem::recursive_directory_iterator(), out);
+    std::vector<std::filesystem::path> files;
+    FindPlugins(std::filesystem::directory_iterator(root, kDirectoryOptions, ec),
+                std::filesystem::directory_iterator(), files);
+    std::ranges::sort(files, LoadOrderLess);
+    out.insert(out.end(), files.begin(), files.end());
+
+    if (!recursive)
+        return;
+
+    std::vector<std::filesystem::path> subdirectories;
+    for (auto it = std::filesystem::directory_iterator(root, kDirectoryOptions, ec);
+         it != std::filesystem::directory_iterator(); it.increment(ec)) {
+        if (ec)
+            break;
+        // Like recursive_directory_iterator, don't follow directory symlinks
+        if (it->is_directory(ec) && !it->is_symlink(ec)) {
+            subdirectories.push_back(it->path());
+        }
     }
-    else {
-        FindPlugins(std::filesystem::directory_iterator(root, ec), std::filesystem::directory_iterator(), out);
+    std::ranges::sort(subdirectories, LoadOrderLess);
+    for (const auto& subdirectory : subdirectories) {
+        CollectFiles_(subdirectory, true, out);
     }
 }
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <unordered_set>
 
 #include "index.hpp"
@@ -20,11 +21,18 @@ auto FindPlugins(Iter begin, Iter end, std::vector<std::filesystem::path>& out)
     }
 }
 
+// Orders paths the way SimCity 4 loads them: by name, ignoring ASCII case by folding to upper case
+auto LoadOrderLess(const std::filesystem::path& a, const std::filesystem::path& b) -> bool;
+
 class PluginLocator {
 public:
     explicit PluginLocator(PluginConfiguration config);
 
+    // All DBPF files in the order the game loads them, so later files override earlier ones: the game
+    // root, the locale directory, then the game and user Plugins folders. Within a folder, its files
+    // come first (sorted by name), then each subfolder in name order, recursively.
     [[nodiscard]] auto ListDbpfFiles() const -> std::vector<std::filesystem::path>;
+    [[nodiscard]] auto config() const -> const PluginConfiguration& { return config_; }
 
 private:
     static auto CollectFiles_(const std::filesystem::path& root, bool recursive, std::vector<std::filesystem::path>& out) -> void;
@@ -0,0 +1,251 @@
+#include "PluginWatcher.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <ranges>
+#include <thread>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+    bool IsDbpfPath(const fs::path& path) {
+        auto ext = path.extension().string();
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return std::tolower(c); });
+        return kDbpfFileExtensions.contains(ext);
+    }
+
+    void SortUnique(std::vector<fs::path>& paths) {
+        std::ranges::sort(paths);
+        const auto duplicates = std::ranges::unique(paths);
+        paths.erase(duplicates.begin(), duplicates.end());
+    }
+}
+
+PluginWatcher::PluginWatcher(PluginConfiguration config, const std::chrono::milliseconds pollInterval)
+    : locator_(std::move(config))
+      , pollInterval_(pollInterval) {
+#ifdef __linux__
+    inotifyFd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd_ >= 0) {
+        const auto& roots = locator_.config();
+        // The same roots as PluginLocator::ListDbpfFiles, with the same recursion
+        bool watching = watchDirectory_(roots.gameRoot, false);
+        if (!roots.localeDir.empty()) {
+            watching = watching && watchDirectory_(roots.gameRoot / roots.localeDir, false);
+        }
+        watching = watching && watchDirectory_(roots.gamePluginsRoot, true);
+        watching = watching && watchDirectory_(roots.userPluginsRoot, true);
+        // Out of watches (fs.inotify.max_user_watches) or nothing to watch: poll instead
+        if (!watching || watches_.empty()) {
+            close(inotifyFd_);
+            inotifyFd_ = -1;
+            watches_.clear();
+        }
+    }
+#endif
+    if (inotifyFd_ < 0) {
+        snapshot_ = takeSnapshot_();
+    }
+}
+
+PluginWatcher::~PluginWatcher() {
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        close(inotifyFd_);
+    }
+#endif
+}
+
+std::vector<fs::path> PluginWatcher::waitForChanges(const std::chrono::milliseconds debounce) {
+#ifdef __linux__
+    if (inotifyFd_ >= 0) {
+        return inotifyChanges_(debounce);
+    }
+#endif
+    return pollChanges_(debounce);
+}
+
+PluginWatcher::Snapshot PluginWatcher::takeSnapshot_() const {
+    Snapshot snapshot;
+    for (const auto& path : locator_.ListDbpfFiles()) {
+        std::error_code ec;
+        const auto size = fs::file_size(path, ec);
+        const auto writeTime = fs::last_write_time(path, ec);
+        snapshot.insert_or_assign(path.string(), std::pair{size, writeTime});
+    }
+    return snapshot;
+}
+
+std::vector<fs::path> PluginWatcher::pollOnce_() {
+    auto current = takeSnapshot_();
+    std::vector<fs::path> changed;
+    for (const auto& [path, state] : current) {
+        const auto previous = snapshot_.find(path);
+        if (previous == snapshot_.end() || previous->second != state) {
+            changed.emplace_back(path);
+        }
+    }
+    for (const auto& path : snapshot_ | std::views::keys) {
+        if (!current.contains(path)) {
+            changed.emplace_back(path);
+        }
+    }
+    snapshot_ = std::move(current);
+    return changed;
+}
+
+std::vector<fs::path> PluginWatcher::pollChanges_(const std::chrono::milliseconds debounce) {
+    std::vector<fs::path> changed;
+    while (changed.empty()) {
+        std::this_thread::sleep_for(pollInterval_);
+        changed = pollOnce_();
+    }
+    // Files still being copied keep changing size; wait until a whole interval passes without changes
+    while (true) {
+        std::this_thread::sleep_for(debounce);
+        const auto more = pollOnce_();
+        if (more.empty()) {
+            break;
+        }
+        changed.insert(changed.end(), more.begin(), more.end());
+    }
+    SortUnique(changed);
+    return changed;
+}
+
+#ifdef __linux__
+bool PluginWatcher::watchDirectory_(const fs::path& directory, const bool recursive) {
+    std::error_code ec;
+    if (directory.empty() || !fs::is_directory(directory, ec)) {
+        return true;
+    }
+
+    // IN_ATTRIB catches touch and tools that restore a file's write time, which the index compares
+    constexpr uint32_t kMask = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+        | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    const int wd = inotify_add_watch(inotifyFd_, directory.c_str(), kMask);
+    if (wd < 0) {
+        return false;
+    }
+    auto& watch = watches_[wd];
+    watch.path = directory;
+    // A folder reached both directly and through a recursive root is watched recursively
+    watch.recursive = watch.recursive || recursive;
+    if (!recursive) {
+        return true;
+    }
+
+    for (auto it = fs::directory_iterator(directory, kDirectoryOptions, ec);
+         !ec && it != fs::directory_iterator(); it.increment(ec)) {
+        // Like PluginLocator, don't follow directory symlinks
+        if (it->is_directory(ec) && !it->is_symlink(ec) && !watchDirectory_(it->path(), true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PluginWatcher::unwatchDirectory_(const fs::path& directory) {
+    for (auto it = watches_.begin(); it != watches_.end();) {
+        const auto& path = it->second.path;
+        if (std::mismatch(directory.begin(), directory.end(), path.begin(), path.end()).first == directory.end()) {
+            inotify_rm_watch(inotifyFd_, it->first);
+            it = watches_.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+bool PluginWatcher::readEvents_(const int timeoutMs, std::vector<fs::path>& changed) {
+    pollfd descriptor{.fd = inotifyFd_, .events = POLLIN, .revents = 0};
+    if (poll(&descriptor, 1, timeoutMs) <= 0) {
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    bool relevant = false;
+    while (true) {
+        const auto length = read(inotifyFd_, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            // Events were dropped, so anything may have changed
+            if (event->mask & IN_Q_OVERFLOW) {
+                relevant = true;
+                continue;
+            }
+            const auto watch = watches_.find(event->wd);
+            if (watch == watches_.end()) {
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                watches_.erase(watch);
+                continue;
+            }
+
+            const auto path = event->len > 0 ? watch->second.path / event->name : watch->second.path;
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+                changed.push_back(path);
+                relevant = true;
+            }
+            else if (event->mask & IN_ISDIR) {
+                // A folder of plugins moved or copied in, or taken out
+                if (!watch->second.recursive
+                    || !(event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))) {
+                    continue;
+                }
+                // Watches follow the folder, not its path, so a moved folder and its subfolders are watched
+                // again under the new path instead of reporting their files under the old one
+                if (event->mask & IN_MOVED_FROM) {
+                    unwatchDirectory_(path);
+                }
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    watchDirectory_(path, true);
+                }
+                changed.push_back(path);
+                relevant = true;
+            }
+            // Files are reported once written and closed, not on every write while they are copied
+            else if ((event->mask & (IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO))
+                     && IsDbpfPath(path)) {
+                changed.push_back(path);
+                relevant = true;
+            }
+        }
+    }
+    return relevant;
+}
+
+std::vector<fs::path> PluginWatcher::inotifyChanges_(const std::chrono::milliseconds debounce) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<fs::path> changed;
+    while (!readEvents_(-1, changed)) {
+    }
+
+    // Only relevant events extend the wait; writes of the scanner's own outputs do not
+    auto deadline = Clock::now() + debounce;
+    while (true) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        if (readEvents_(static_cast<int>(remaining.count()), changed)) {
+            deadline = Clock::now() + debounce;
+        }
+    }
+    SortUnique(changed);
+    return changed;
+}
+#endif
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "PluginLocator.hpp"
+
+// Waits for DBPF files to be added, changed or removed under the directories PluginLocator scans.
+// Uses inotify on Linux, and polls the sizes and write times of the files elsewhere or when inotify
+// is unavailable. Only DBPF files and plugin folders count, so the caches the scanner writes into the
+// user Plugins folder, and their .tmp and .spool files, never trigger a rescan.
+class PluginWatcher {
+public:
+    PluginWatcher(PluginConfiguration config, std::chrono::milliseconds pollInterval);
+    ~PluginWatcher();
+
+    PluginWatcher(const PluginWatcher&) = delete;
+    PluginWatcher& operator=(const PluginWatcher&) = delete;
+
+    // Blocks until something changed, then until nothing further changed for debounce, so a bulk
+    // copy is reported once. Returns the changed files and folders.
+    [[nodiscard]] std::vector<std::filesystem::path> waitForChanges(std::chrono::milliseconds debounce);
+    [[nodiscard]] bool usesInotify() const { return inotifyFd_ >= 0; }
+
+private:
+    // Size and write time of every DBPF file, keyed by path
+    using Snapshot = std::unordered_map<std::string, std::pair<uintmax_t, std::filesystem::file_time_type>>;
+
+    [[nodiscard]] Snapshot takeSnapshot_() const;
+    // Updates snapshot_ and returns the files that differ from it
+    std::vector<std::filesystem::path> pollOnce_();
+    std::vector<std::filesystem::path> pollChanges_(std::chrono::milliseconds debounce);
+
+#ifdef __linux__
+    struct WatchedDirectory {
+        std::filesystem::path path;
+        bool recursive = false;
+    };
+
+    // Returns false if the directory exists but could not be watched
+    bool watchDirectory_(const std::filesystem::path& directory, bool recursive);
+    // Stops watching the directory and everything below it
+    void unwatchDirectory_(const std::filesystem::path& directory);
+    // Waits up to timeoutMs (-1 for ever) for events and reads all that are pending. Appends the
+    // relevant paths to changed and returns whether there were any.
+    bool readEvents_(int timeoutMs, std::vector<std::filesystem::path>& changed);
+    std::vector<std::filesystem::path> inotifyChanges_(std::chrono::milliseconds debounce);
+
+    std::unordered_map<int, WatchedDirectory> watches_;
+#endif
+
+    PluginLocator locator_;
+    std::chrono::milliseconds pollInterval_;
+    Snapshot snapshot_;
+    int inotifyFd_ = -1;
+};
@@ -1,12 +1,73 @@
 #include "PropertyMapper.hpp"
 
 #include <fstream>
+#include <iterator>
 
-#include "rfl/xml/load.hpp"
-#include "rfl/xml/read.hpp"
+#include "../shared/property_xml.hpp"
 #include "spdlog/spdlog.h"
 
+bool PropertyMapper::load(const std::filesystem::path& xmlPath) {
+    const auto source = sourceFor(xmlPath);
+    if (!source) {
+        return false;
+    }
+
+    auto binaryPath = xmlPath;
+    binaryPath.replace_extension(".bin");
+    std::error_code ec;
+    if (*source == binaryPath) {
+        if (loadFromBinary(binaryPath)) {
+            return true;
+        }
+    }
+    else if (std::filesystem::exists(binaryPath, ec)) {
+        spdlog::info("Ignoring {}, {} is newer", binaryPath.string(), xmlPath.filename().string());
+    }
+    return std::filesystem::exists(xmlPath, ec) && loadFromXml(xmlPath);
+}
+
+std::optional<std::filesystem::path> PropertyMapper::sourceFor(const std::filesystem::path& xmlPath) {
+    auto binaryPath = xmlPath;
+    binaryPath.replace_extension(".bin");
+
+    std::error_code ec;
+    const bool xmlExists = std::filesystem::exists(xmlPath, ec);
+    if (std::filesystem::exists(binaryPath, ec)) {
+        const auto binaryTime = std::filesystem::last_write_time(binaryPath, ec);
+        const bool stale = xmlExists && !ec && std::filesystem::last_write_time(xmlPath, ec) > binaryTime && !ec;
+        if (!stale) {
+            return binaryPath;
+        }
+    }
+    if (xmlExists) {
+        return xmlPath;
+    }
+    return std::nullopt;
+}
+
+bool PropertyMapper::loadFromBinary(const std::filesystem::path& binaryPath) {
+    MappedFile file;
+    if (!file.open(binaryPath)) {
+        spdlog::error("Failed to open property dictionary: {}", binaryPath.string());
+        return false;
+    }
+    auto dictionary = PropertyDictionary::fromBytes(file.bytes());
+    if (!dictionary) {
+        spdlog::error("Invalid property dictionary: {}", binaryPath.string());
+        return false;
+    }
+
+    dictionaryFile_ = std::move(file);
+    dictionary_ = dictionary;
+    properties_.clear();
+    propertyNames_.clear();
+    spdlog::info("Loaded {} property definitions from {}", dictionary_->size(), binaryPath.filename().string());
+    return true;
+}
+
 bool PropertyMapper::loadFromXml(const std::filesystem::path& xmlPath) {
+    dictionary_.reset();
+    dictionaryFile_.close();
     try {
         std::ifstream file(xmlPath, std::ios::binary);
         if (!file.is_open()) {
@@ -14,26 +75,18 @@ bool PropertyMapper::loadFromXml(const std::filesystem::path& xmlPath) {
             return false;
         }
 
-        auto result = rfl::xml::read<ExemplarProperties>(file);
-
-        if (!result) {
-            spdlog::error("Failed to parse properties XML: {}", result.error().what());
+        const std::string xml((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        const auto definitions = ReadPropertyXml(xml);
+        if (!definitions) {
+            spdlog::error("Failed to parse properties XML: {}", definitions.error().what());
+            return false;
         }
 
-        const auto& root = result.value();
-        for (const auto& propDef : root.properties().definitions()) {
-            PropertyInfo info{parsePropertyId_(propDef.id().get()), propDef.name().get(),
-                              parseValueType_(propDef.type().get()), parseCount_(propDef.count().get())};
-            auto propOptionList = propDef.options.get();
-            std::unordered_map<std::string, uint32_t> propOptionMap{};
-            if (!propOptionList.empty()) {
-                for (const auto& option : propOptionList) {
-                    uint32_t optionValue = parsePropertyId_(option.value().get());
-                    std::string optionLabel = option.name().get();
-                    propOptionMap[optionLabel] = optionValue;
-                }
-                info.optionNames_ = propOptionMap;
-            }
+        properties_.clear();
+        propertyNames_.clear();
+        for (const auto& definition : *definitions) {
+            PropertyInfo info{definition.id, definition.name, toValueType_(definition.type), definition.count};
+            info.optionNames_.insert(definition.options.begin(), definition.options.end());
 
             properties_[info.id] = info;
             propertyNames_[info.name] = info.id;
@@ -49,6 +102,12 @@ bool PropertyMapper::loadFromXml(const std::filesystem::path& xmlPath) {
 }
 
 std::optional<PropertyInfo> PropertyMapper::propertyInfo(const uint32_t propertyId) const {
+    if (dictionary_) {
+        if (const auto property = dictionary_->find(propertyId)) {
+            return propertyInfoFromDictionary_(*property);
+        }
+        return std::nullopt;
+    }
     if (const auto it = properties_.find(propertyId); it != properties_.end()) {
         return it->second;
     }
@@ -64,6 +123,12 @@ std::optional<PropertyInfo> PropertyMapper::propertyInfo(const std::string& prop
 }
 
 std::string_view PropertyMapper::propertyName(const uint32_t propertyId) const {
+    if (dictionary_) {
+        if (const auto property = dictionary_->find(propertyId)) {
+            return property->name;
+        }
+        return "Unknown";
+    }
     if (const auto it = properties_.find(propertyId); it != properties_.end()) {
         return it->second.name;
     }
@@ -71,6 +136,12 @@ std::string_view PropertyMapper::propertyName(const uint32_t propertyId) const {
 }
 
 std::optional<uint32_t> PropertyMapper::propertyId(const std::string& propertyName) const {
+    if (dictionary_) {
+        if (const auto property = dictionary_->findByName(propertyName)) {
+            return property->id;
+        }
+        return std::nullopt;
+    }
     if (propertyNames_.contains(propertyName)) {
         return propertyNames_.at(propertyName);
     }
@@ -78,6 +149,12 @@ std::optional<uint32_t> PropertyMapper::propertyId(const std::string& propertyNa
 }
 
 std::optional<uint32_t> PropertyMapper::propertyOptionId(const std::string& propertyName, const std::string& optionName) const {
+    if (dictionary_) {
+        if (const auto property = dictionary_->findByName(propertyName)) {
+            return dictionary_->optionValue(*property, optionName);
+        }
+        return std::nullopt;
+    }
     const auto propertyId = this->propertyId(propertyName);
     if (!propertyId) {
         return std::nullopt;
@@ -89,38 +166,32 @@ std::optional<uint32_t> PropertyMapper::propertyOptionId(const std::string& prop
     return std::nullopt;
 }
 
-uint32_t PropertyMapper::parsePropertyId_(const std::string& idStr) {
-    if (idStr.starts_with("0x") || idStr.starts_with("0X")) {
-        return std::stoul(idStr, nullptr, 16);
+PropertyInfo PropertyMapper::propertyInfoFromDictionary_(const PropertyDictionary::Property& property) const {
+    PropertyInfo info{property.id, std::string(property.name), toValueType_(property.type), property.count};
+    for (const auto& [optionName, value] : dictionary_->options(property)) {
+        info.optionNames_.emplace(optionName, value);
     }
-
-    spdlog::trace("Skipping symbolic property ID: {}", idStr);
-    return 0;
+    return info;
 }
 
-Exemplar::ValueType PropertyMapper::parseValueType_(const std::string& typeStr) {
-    if (typeStr == "Uint8")
+Exemplar::ValueType PropertyMapper::toValueType_(const PropertyValueType type) {
+    switch (type) {
+    case PropertyValueType::UInt8:
         return Exemplar::ValueType::UInt8;
-    if (typeStr == "Uint16")
+    case PropertyValueType::UInt16:
         return Exemplar::ValueType::UInt16;
-    if (typeStr == "Uint32")
+    case PropertyValueType::UInt32:
         return Exemplar::ValueType::UInt32;
-    if (typeStr == "Sint32")
+    case PropertyValueType::SInt32:
         return Exemplar::ValueType::SInt32;
-    if (typeStr == "Sint64")
+    case PropertyValueType::SInt64:
         return Exemplar::ValueType::SInt64;
-    if (typeStr == "Float32")
+    case PropertyValueType::Float32:
         return Exemplar::ValueType::Float32;
-    if (typeStr == "Bool")
+    case PropertyValueType::Bool:
         return Exemplar::ValueType::Bool;
-    if (typeStr == "String")
+    case PropertyValueType::String:
         return Exemplar::ValueType::String;
-    // Default to UInt32 for unknown types
+    }
     return Exemplar::ValueType::UInt32;
 }
-
-int PropertyMapper::parseCount_(const std::optional<std::string>& countStr) {
-    if (!countStr)
-        return 1;
-    return std::stoi(countStr.value());
-}
@@ -2,38 +2,13 @@
 
 
 #include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
 
 #include "ExemplarReader.h"
-#include "rfl/Attribute.hpp"
-#include "rfl/Rename.hpp"
-
-using BoolLiteral = rfl::Literal<"Y", "N">;
-
-// XML structure for <OPTION Value="..." Name="..."/>
-struct PropertyOption {
-    rfl::Rename<"Value", rfl::Attribute<std::string>> value;
-    rfl::Rename<"Name", rfl::Attribute<std::string>> name;
-};
-
-struct PropertyDefinition {
-    rfl::Rename<"ID", rfl::Attribute<std::string>> id;
-    rfl::Rename<"Name", rfl::Attribute<std::string>> name;
-    rfl::Rename<"Type", rfl::Attribute<std::string>> type;
-
-    rfl::Rename<"Count", rfl::Attribute<std::optional<std::string>>> count;
-    std::optional<rfl::Rename<"ShowAsHex", rfl::Attribute<BoolLiteral>>> showAsHex;
-    rfl::Rename<"Default", rfl::Attribute<std::optional<std::string>>> defaultValue;
-
-    rfl::Rename<"HELP", std::optional<std::string>> helpText;
-    rfl::Rename<"OPTION", std::vector<PropertyOption>> options;
-};
-
-struct ExemplarProperties {
-    struct Properties {
-        rfl::Rename<"PROPERTY", std::vector<PropertyDefinition>> definitions;
-    };
-    rfl::Rename<"PROPERTIES", Properties> properties;
-};
+#include "MappedFile.hpp"
+#include "../shared/property_dictionary.hpp"
 
 // Property metadata from XML
 struct PropertyInfo {
@@ -46,7 +21,14 @@ struct PropertyInfo {
 
 class PropertyMapper {
 public:
+    // Loads the binary dictionary compiled from xmlPath (the same path with a .bin extension) when it
+    // exists and is not older than the XML, and the XML itself otherwise
+    bool load(const std::filesystem::path& xmlPath);
+    // The file load(xmlPath) reads first, by the same rule; nullopt when neither exists
+    [[nodiscard]] static std::optional<std::filesystem::path> sourceFor(const std::filesystem::path& xmlPath);
     bool loadFromXml(const std::filesystem::path& xmlPath);
+    // Maps a dictionary written by tools/convert_properties; lookups then read it in place
+    bool loadFromBinary(const std::filesystem::path& binaryPath);
 
     [[nodiscard]] std::optional<PropertyInfo> propertyInfo(uint32_t propertyId) const;
     [[nodiscard]] std::optional<PropertyInfo> propertyInfo(const std::string& propertyName) const;
@@ -77,11 +59,15 @@ private:
         return "unknown";
     }
 
-    [[nodiscard]] static uint32_t parsePropertyId_(const std::string& idStr);
-    [[nodiscard]] static Exemplar::ValueType parseValueType_(const std::string& typeStr);
-    [[nodiscard]] static int parseCount_(const std::optional<std::string>& countStr);
+    [[nodiscard]] PropertyInfo propertyInfoFromDictionary_(const PropertyDictionary::Property& property) const;
+    [[nodiscard]] static Exemplar::ValueType toValueType_(PropertyValueType type);
 
 private:
+    // Loaded from the XML
     std::unordered_map<uint32_t, PropertyInfo> properties_;
     std::unordered_map<std::string, uint32_t> propertyNames_;
+
+    // Loaded from the binary dictionary, which is used instead of the maps above when present
+    MappedFile dictionaryFile_;
+    std::optional<PropertyDictionary> dictionary_;
 };
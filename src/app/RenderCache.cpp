@@ -0,0 +1,238 @@
+#include "RenderCache.hpp"
+
+#include <cstring>
+#include <ranges>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+namespace thumb {
+    namespace {
+        constexpr char kMagic[4] = {'S', 'P', 'R', 'C'};
+        constexpr uint32_t kFormatVersion = 1;
+        constexpr uint64_t kHeaderSize = 8;
+        constexpr uint64_t kRecordHeaderSize = 16;
+        // Smaller caches are never compacted; rewriting them would cost more than it saves
+        constexpr uint64_t kMinCompactBytes = 16ull * 1024 * 1024;
+
+        uint64_t PixelBytes(const uint32_t width, const uint32_t height) {
+            return static_cast<uint64_t>(width) * height * 4;
+        }
+
+        void WriteRecordHeader(std::ostream& out, const uint64_t key, const uint32_t width, const uint32_t height) {
+            out.write(reinterpret_cast<const char*>(&key), 8);
+            out.write(reinterpret_cast<const char*>(&width), 4);
+            out.write(reinterpret_cast<const char*>(&height), 4);
+        }
+    }
+
+    RenderCache::RenderCache(std::filesystem::path path)
+        : path_(std::move(path)) {
+        load_();
+    }
+
+    RenderCache::~RenderCache() {
+        close();
+    }
+
+    bool RenderCache::isOpen() const {
+        return file_.is_open();
+    }
+
+    RenderCache::Lookup RenderCache::find(const uint64_t key) {
+        const auto it = slots_.find(key);
+        if (it == slots_.end() || !file_.is_open()) {
+            ++stats_.misses;
+            return {};
+        }
+
+        auto& slot = it->second;
+        slot.used = true;
+        ++stats_.hits;
+        if (slot.width == 0) {
+            return {.found = true, .image = std::nullopt};
+        }
+
+        RenderedImage image;
+        image.width = slot.width;
+        image.height = slot.height;
+        image.pixels.resize(PixelBytes(slot.width, slot.height));
+        file_.seekg(static_cast<std::streamoff>(slot.pixelOffset));
+        file_.read(reinterpret_cast<char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+        if (!file_) {
+            spdlog::warn("Render cache {} could not be read, discarding it", path_.string());
+            reset_();
+            --stats_.hits;
+            ++stats_.misses;
+            return {};
+        }
+        return {.found = true, .image = std::move(image)};
+    }
+
+    void RenderCache::store(const uint64_t key, const std::optional<RenderedImage>& image, const bool renderFailed) {
+        if (!file_.is_open() || slots_.contains(key) || (!image && renderFailed)) {
+            return;
+        }
+
+        const uint32_t width = image ? image->width : 0;
+        const uint32_t height = image ? image->height : 0;
+        if (image && image->pixels.size() != PixelBytes(width, height)) {
+            return;
+        }
+
+        file_.seekp(static_cast<std::streamoff>(end_));
+        WriteRecordHeader(file_, key, width, height);
+        if (image) {
+            file_.write(reinterpret_cast<const char*>(image->pixels.data()),
+                        static_cast<std::streamsize>(image->pixels.size()));
+        }
+        if (!file_) {
+            spdlog::warn("Render cache {} could not be written, disabling it for this scan", path_.string());
+            file_.close();
+            return;
+        }
+
+        slots_.emplace(key, Slot{
+                           .pixelOffset = end_ + kRecordHeaderSize,
+                           .width = width,
+                           .height = height,
+                           .used = true
+                       });
+        end_ += kRecordHeaderSize + PixelBytes(width, height);
+        ++stats_.stored;
+        stats_.entries = slots_.size();
+    }
+
+    void RenderCache::close() {
+        if (!file_.is_open()) {
+            return;
+        }
+        file_.flush();
+        compact_();
+        file_.close();
+    }
+
+    void RenderCache::load_() {
+        std::error_code ec;
+        if (!std::filesystem::exists(path_, ec)) {
+            reset_();
+            return;
+        }
+
+        file_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+        if (!file_) {
+            spdlog::warn("Render cache {} could not be opened, starting a new one", path_.string());
+            reset_();
+            return;
+        }
+
+        char magic[4] = {};
+        uint32_t version = 0;
+        file_.read(magic, 4);
+        file_.read(reinterpret_cast<char*>(&version), 4);
+        if (!file_ || std::memcmp(magic, kMagic, 4) != 0 || version != kFormatVersion) {
+            spdlog::info("Render cache {} has an unknown format, starting a new one", path_.string());
+            reset_();
+            return;
+        }
+
+        const auto fileSize = static_cast<uint64_t>(std::filesystem::file_size(path_, ec));
+        uint64_t offset = kHeaderSize;
+        while (offset + kRecordHeaderSize <= fileSize) {
+            uint64_t key = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            file_.seekg(static_cast<std::streamoff>(offset));
+            file_.read(reinterpret_cast<char*>(&key), 8);
+            file_.read(reinterpret_cast<char*>(&width), 4);
+            file_.read(reinterpret_cast<char*>(&height), 4);
+            const uint64_t next = offset + kRecordHeaderSize + PixelBytes(width, height);
+            if (!file_ || next > fileSize) {
+                break;
+            }
+            slots_.insert_or_assign(key, Slot{.pixelOffset = offset + kRecordHeaderSize, .width = width, .height = height});
+            offset = next;
+        }
+        file_.clear();
+
+        // Drop a record cut short by an interrupted scan, so new records are appended after the last whole one
+        if (offset != fileSize) {
+            spdlog::debug("Render cache {} ends in a partial record, truncating it", path_.string());
+            file_.close();
+            std::filesystem::resize_file(path_, offset, ec);
+            file_.open(path_, std::ios::binary | std::ios::in | std::ios::out);
+            if (ec || !file_) {
+                reset_();
+                return;
+            }
+        }
+
+        end_ = offset;
+        stats_.entries = slots_.size();
+        spdlog::debug("Loaded render cache {} with {} entries", path_.string(), slots_.size());
+    }
+
+    void RenderCache::reset_() {
+        if (file_.is_open()) {
+            file_.close();
+        }
+        slots_.clear();
+        file_.open(path_, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+        if (!file_) {
+            spdlog::warn("Render cache {} could not be created, rendering without it", path_.string());
+            return;
+        }
+        file_.write(kMagic, 4);
+        file_.write(reinterpret_cast<const char*>(&kFormatVersion), 4);
+        end_ = kHeaderSize;
+        stats_.entries = 0;
+    }
+
+    void RenderCache::compact_() {
+        uint64_t usedBytes = kHeaderSize;
+        for (const auto& slot : slots_ | std::views::values) {
+            if (slot.used) {
+                usedBytes += kRecordHeaderSize + PixelBytes(slot.width, slot.height);
+            }
+        }
+        if (end_ < kMinCompactBytes || usedBytes * 2 > end_) {
+            return;
+        }
+
+        auto tempPath = path_;
+        tempPath += ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            out.write(kMagic, 4);
+            out.write(reinterpret_cast<const char*>(&kFormatVersion), 4);
+            std::vector<char> pixels;
+            for (const auto& [key, slot] : slots_) {
+                if (!slot.used) {
+                    continue;
+                }
+                pixels.resize(PixelBytes(slot.width, slot.height));
+                file_.seekg(static_cast<std::streamoff>(slot.pixelOffset));
+                file_.read(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+                WriteRecordHeader(out, key, slot.width, slot.height);
+                out.write(pixels.data(), static_cast<std::streamsize>(pixels.size()));
+            }
+            if (!file_ || !out) {
+                std::error_code ec;
+                std::filesystem::remove(tempPath, ec);
+                return;
+            }
+        }
+
+        file_.close();
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path_, ec);
+        if (ec) {
+            std::filesystem::remove(tempPath, ec);
+            return;
+        }
+        const auto dropped = std::erase_if(slots_, [](const auto& entry) { return !entry.second.used; });
+        stats_.compactedEntries += dropped;
+        stats_.entries = slots_.size();
+        spdlog::info("Compacted render cache {}: dropped {} unused entries", path_.string(), dropped);
+    }
+} // namespace thumb
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <unordered_map>
+
+#include "ThumbnailRenderer.hpp"
+
+constexpr auto kRenderCacheFileName = "render_cache.bin";
+
+namespace thumb {
+    // 64-bit FNV-1a, used to address renders by the content they were drawn from
+    class ContentHash {
+    public:
+        void add(const std::span<const uint8_t> bytes) {
+            for (const auto byte : bytes) {
+                hash_ = (hash_ ^ byte) * 0x100000001B3ull;
+            }
+        }
+
+        void add(const uint64_t value) {
+            uint8_t bytes[8];
+            for (int i = 0; i < 8; ++i) {
+                bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+            add(bytes);
+        }
+
+        [[nodiscard]] uint64_t value() const {
+            return hash_;
+        }
+
+    private:
+        uint64_t hash_ = 0xCBF29CE484222325ull;
+    };
+
+    // Rendered thumbnails that persist between scans, keyed by a hash of everything the render was drawn
+    // from: model bytes, texture bytes, size and renderer version. A key that is still found after
+    // plugins changed is therefore still valid, whatever file the model moved to.
+    //
+    // Format (little endian):
+    //   Header: char[4] magic = "SPRC", uint32 version
+    //   Records, appended as renders happen:
+    //     uint64 key, uint32 width, uint32 height, width * height * 4 RGBA bytes
+    //   A record with width 0 remembers a model that could not be rendered.
+    //
+    // Only the record index is held in memory; pixels are read back on a hit.
+    class RenderCache {
+    public:
+        struct Lookup {
+            bool found = false;
+            std::optional<RenderedImage> image; // nullopt for a cached failure
+        };
+
+        struct Stats {
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t stored = 0;
+            uint64_t entries = 0;
+            uint64_t compactedEntries = 0; // Entries dropped by close() because no scan used them
+        };
+
+        explicit RenderCache(std::filesystem::path path);
+        ~RenderCache();
+        RenderCache(const RenderCache&) = delete;
+        RenderCache& operator=(const RenderCache&) = delete;
+
+        [[nodiscard]] bool isOpen() const;
+        [[nodiscard]] Lookup find(uint64_t key);
+        // A nullopt image is recorded as a model that cannot be rendered. When renderFailed says the
+        // renderer itself failed instead (no render target, a failed readback), nothing is recorded, so
+        // the next scan tries the model again.
+        void store(uint64_t key, const std::optional<RenderedImage>& image, bool renderFailed);
+
+        // Flushes the file. When entries this scan did not use make up most of it, they are dropped
+        // so the cache does not keep growing with models that were removed or changed.
+        void close();
+
+        [[nodiscard]] const Stats& stats() const {
+            return stats_;
+        }
+
+    private:
+        struct Slot {
+            uint64_t pixelOffset = 0;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            bool used = false;
+        };
+
+        void load_();
+        void reset_();
+        void compact_();
+
+        std::filesystem::path path_;
+        std::fstream file_;
+        uint64_t end_ = 0;
+        std::unordered_map<uint64_t, Slot> slots_;
+        Stats stats_;
+    };
+} // namespace thumb
@@ -0,0 +1,232 @@
+#include "ScanMetrics.hpp"
+
+#include <algorithm>
+#include <fstream>
+
+#include <rfl/json.hpp>
+
+#include "spdlog/spdlog.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <time.h>
+#endif
+
+namespace {
+    constexpr std::array<const char*, kScanPhaseCount> kPhaseNames = {
+        "indexing",
+        "exemplarPass",
+        "lotConfigPass",
+        "normalisation",
+        "writes",
+        "ltextResolution",
+        "modelBounds",
+        "thumbnailRendering",
+    };
+
+    constexpr bool IsNestedPhase(const ScanPhase phase) {
+        return phase >= ScanPhase::Normalisation;
+    }
+
+#ifdef _WIN32
+    std::chrono::nanoseconds FileTimeToNs(const FILETIME& time) {
+        ULARGE_INTEGER value;
+        value.LowPart = time.dwLowDateTime;
+        value.HighPart = time.dwHighDateTime;
+        return std::chrono::nanoseconds(value.QuadPart * 100);
+    }
+
+    std::chrono::nanoseconds ProcessCpuTime() {
+        FILETIME creation, exit, kernel, user;
+        if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+            return {};
+        }
+        return FileTimeToNs(kernel) + FileTimeToNs(user);
+    }
+
+    std::chrono::nanoseconds ThreadCpuTime() {
+        FILETIME creation, exit, kernel, user;
+        if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+            return {};
+        }
+        return FileTimeToNs(kernel) + FileTimeToNs(user);
+    }
+
+    uint64_t PeakMemoryBytes() {
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return 0;
+        }
+        return counters.PeakWorkingSetSize;
+    }
+#else
+    std::chrono::nanoseconds ClockTime(const clockid_t clock) {
+        timespec time{};
+        if (clock_gettime(clock, &time) != 0) {
+            return {};
+        }
+        return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+    }
+
+    std::chrono::nanoseconds ProcessCpuTime() {
+        return ClockTime(CLOCK_PROCESS_CPUTIME_ID);
+    }
+
+    std::chrono::nanoseconds ThreadCpuTime() {
+        return ClockTime(CLOCK_THREAD_CPUTIME_ID);
+    }
+
+    uint64_t PeakMemoryBytes() {
+        rusage usage{};
+        if (getrusage(RUSAGE_SELF, &usage) != 0) {
+            return 0;
+        }
+#ifdef __APPLE__
+        return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+
+    std::chrono::nanoseconds CpuTime(const ScanPhase phase) {
+        return IsNestedPhase(phase) ? ThreadCpuTime() : ProcessCpuTime();
+    }
+
+    double ToMs(const int64_t ns) {
+        return static_cast<double>(ns) / 1e6;
+    }
+
+    void SortSlowest(std::vector<ScanSlowItem>& items, const size_t topN) {
+        std::ranges::sort(items, std::greater{}, &ScanSlowItem::wallMs);
+        if (items.size() > topN) {
+            items.resize(topN);
+        }
+    }
+}
+
+ScanMetrics::Timer::Timer(ScanMetrics* metrics, const ScanPhase phase)
+    : metrics_(metrics)
+    , phase_(phase) {
+    if (metrics_) {
+        wallStart_ = std::chrono::steady_clock::now();
+        cpuStart_ = CpuTime(phase_);
+    }
+}
+
+ScanMetrics::Timer::~Timer() {
+    if (metrics_) {
+        metrics_->addTime_(phase_, std::chrono::steady_clock::now() - wallStart_, CpuTime(phase_) - cpuStart_);
+    }
+}
+
+double ScanMetrics::Timer::elapsedMs() const {
+    if (!metrics_) {
+        return 0.0;
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart_).count();
+}
+
+ScanMetrics::ScanMetrics(const size_t topN)
+    : topN_(topN)
+    , wallStart_(std::chrono::steady_clock::now())
+    , cpuStart_(ProcessCpuTime()) {}
+
+void ScanMetrics::addItems(const ScanPhase phase, const uint64_t count) {
+    phases_[static_cast<size_t>(phase)].items.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ScanMetrics::addBytesRead(const ScanPhase phase, const uint64_t bytes) {
+    phases_[static_cast<size_t>(phase)].bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void ScanMetrics::addBytesWritten(const ScanPhase phase, const uint64_t bytes) {
+    phases_[static_cast<size_t>(phase)].bytesWritten.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void ScanMetrics::recordFile(const std::string& name, const double wallMs) {
+    std::lock_guard lock(slowMutex_);
+    recordSlow_(slowestFiles_, name, wallMs);
+}
+
+void ScanMetrics::recordModel(const std::string& name, const double wallMs) {
+    std::lock_guard lock(slowMutex_);
+    recordSlow_(slowestModels_, name, wallMs);
+}
+
+void ScanMetrics::recordEstimate(const std::string& name, const double ms, const std::string& basis) {
+    std::lock_guard lock(slowMutex_);
+    estimates_.push_back(ScanEstimate{.name = name, .ms = ms, .basis = basis});
+}
+
+void ScanMetrics::addTime_(const ScanPhase phase, const std::chrono::nanoseconds wall,
+                           const std::chrono::nanoseconds cpu) {
+    auto& counters = phases_[static_cast<size_t>(phase)];
+    counters.wallNs.fetch_add(wall.count(), std::memory_order_relaxed);
+    counters.cpuNs.fetch_add(cpu.count(), std::memory_order_relaxed);
+    if (!IsNestedPhase(phase)) {
+        counters.peakMemoryBytes.store(PeakMemoryBytes(), std::memory_order_relaxed);
+    }
+}
+
+void ScanMetrics::recordSlow_(std::vector<ScanSlowItem>& items, const std::string& name, const double wallMs) {
+    // Only trimmed once the list doubles, so most calls are a plain append
+    if (items.size() >= topN_ * 2) {
+        SortSlowest(items, topN_);
+    }
+    if (items.size() >= topN_ && !items.empty() && wallMs <= items.back().wallMs) {
+        return;
+    }
+    items.push_back(ScanSlowItem{.name = name, .wallMs = wallMs});
+}
+
+ScanMetricsReport ScanMetrics::report() const {
+    ScanMetricsReport report;
+    report.totalWallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart_).count();
+    report.totalCpuMs = ToMs((ProcessCpuTime() - cpuStart_).count());
+    report.peakMemoryBytes = PeakMemoryBytes();
+
+    report.phases.reserve(kScanPhaseCount);
+    for (size_t i = 0; i < kScanPhaseCount; ++i) {
+        const auto& counters = phases_[i];
+        report.phases.push_back(ScanPhaseReport{
+            .name = kPhaseNames[i],
+            .nested = IsNestedPhase(static_cast<ScanPhase>(i)),
+            .wallMs = ToMs(counters.wallNs.load(std::memory_order_relaxed)),
+            .cpuMs = ToMs(counters.cpuNs.load(std::memory_order_relaxed)),
+            .items = counters.items.load(std::memory_order_relaxed),
+            .bytesRead = counters.bytesRead.load(std::memory_order_relaxed),
+            .bytesWritten = counters.bytesWritten.load(std::memory_order_relaxed),
+            .peakMemoryBytes = counters.peakMemoryBytes.load(std::memory_order_relaxed),
+        });
+    }
+
+    {
+        std::lock_guard lock(slowMutex_);
+        report.slowestFiles = slowestFiles_;
+        report.slowestModels = slowestModels_;
+        report.estimates = estimates_;
+    }
+    SortSlowest(report.slowestFiles, topN_);
+    SortSlowest(report.slowestModels, topN_);
+    return report;
+}
+
+bool ScanMetrics::write(const std::filesystem::path& path) const {
+    try {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            spdlog::error("Failed to open metrics file for writing: {}", path.string());
+            return false;
+        }
+        rfl::json::write(report(), file, rfl::json::pretty);
+        return static_cast<bool>(file);
+    }
+    catch (const std::exception& error) {
+        spdlog::error("Error writing metrics {}: {}", path.string(), error.what());
+        return false;
+    }
+}
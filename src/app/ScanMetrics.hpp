@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Phases of a cache-building scan. The first three run one after the other on the main thread; the
+// nested ones happen inside or between them, possibly on several threads at once. Normalisation and
+// writes are nested because records are written out as soon as they are final.
+enum class ScanPhase : uint8_t {
+    Indexing,
+    ExemplarPass,
+    LotConfigPass,
+    Normalisation,
+    Writes,
+    LTextResolution,
+    ModelBounds,
+    ThumbnailRendering,
+};
+constexpr size_t kScanPhaseCount = 8;
+
+struct ScanPhaseReport {
+    std::string name;
+    // Nested phases add up the time of every thread that entered them, so their wall time can exceed
+    // that of the enclosing pass. Their CPU time is that of those threads only; top-level
+    // phases report CPU time of the whole process.
+    bool nested = false;
+    double wallMs = 0.0;
+    double cpuMs = 0.0;
+    uint64_t items = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    // Process peak resident memory when a top-level phase ended; 0 for nested phases
+    uint64_t peakMemoryBytes = 0;
+};
+
+struct ScanSlowItem {
+    std::string name;
+    double wallMs = 0.0;
+};
+
+// A figure derived from other measurements rather than measured itself, with how it was derived
+struct ScanEstimate {
+    std::string name;
+    double ms = 0.0;
+    std::string basis;
+};
+
+struct ScanMetricsReport {
+    uint32_t version = 1;
+    double totalWallMs = 0.0;
+    double totalCpuMs = 0.0;
+    uint64_t peakMemoryBytes = 0;
+    std::vector<ScanPhaseReport> phases;
+    std::vector<ScanSlowItem> slowestFiles;
+    std::vector<ScanSlowItem> slowestModels;
+    std::vector<ScanEstimate> estimates;
+};
+
+// Collects timings and counters for one scan, for --metrics-out. All methods are thread-safe.
+class ScanMetrics {
+public:
+    // Measures the enclosing scope and adds it to a phase. Does nothing when metrics is null, so
+    // call sites don't need to check whether metrics were requested.
+    class Timer {
+    public:
+        Timer(ScanMetrics* metrics, ScanPhase phase);
+        ~Timer();
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        [[nodiscard]] double elapsedMs() const;
+
+    private:
+        ScanMetrics* metrics_;
+        ScanPhase phase_;
+        std::chrono::steady_clock::time_point wallStart_;
+        std::chrono::nanoseconds cpuStart_;
+    };
+
+    explicit ScanMetrics(size_t topN = 20);
+
+    void addItems(ScanPhase phase, uint64_t count);
+    void addBytesRead(ScanPhase phase, uint64_t bytes);
+    void addBytesWritten(ScanPhase phase, uint64_t bytes);
+    void recordFile(const std::string& name, double wallMs);
+    void recordModel(const std::string& name, double wallMs);
+    void recordEstimate(const std::string& name, double ms, const std::string& basis);
+
+    [[nodiscard]] ScanMetricsReport report() const;
+    // Writes the report as pretty-printed JSON; returns false if the file could not be written
+    bool write(const std::filesystem::path& path) const;
+
+private:
+    struct PhaseCounters {
+        std::atomic<int64_t> wallNs{0};
+        std::atomic<int64_t> cpuNs{0};
+        std::atomic<uint64_t> items{0};
+        std::atomic<uint64_t> bytesRead{0};
+        std::atomic<uint64_t> bytesWritten{0};
+        std::atomic<uint64_t> peakMemoryBytes{0};
+    };
+
+    void addTime_(ScanPhase phase, std::chrono::nanoseconds wall, std::chrono::nanoseconds cpu);
+    void recordSlow_(std::vector<ScanSlowItem>& items, const std::string& name, double wallMs);
+
+    size_t topN_;
+    std::chrono::steady_clock::time_point wallStart_;
+    std::chrono::nanoseconds cpuStart_;
+    std::array<PhaseCounters, kScanPhaseCount> phases_;
+    mutable std::mutex slowMutex_;
+    std::vector<ScanSlowItem> slowestFiles_;
+    std::vector<ScanSlowItem> slowestModels_;
+    // Also guarded by slowMutex_
+    std::vector<ScanEstimate> estimates_;
+};
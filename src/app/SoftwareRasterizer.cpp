@@ -0,0 +1,283 @@
+#include "SoftwareRasterizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "raymath.h"
+#include "rlgl.h"
+
+namespace thumb {
+    namespace {
+        // Anything less opaque would round to nothing in the 8-bit target
+        constexpr float kAlphaTestCutoff = 0.5f / 255.0f;
+        constexpr float kMinClipW = 1e-6f;
+        // Edges are evaluated on a fixed-point grid, so two triangles sharing an edge agree exactly on
+        // which pixels are theirs and blended pixels along it are not drawn twice
+        constexpr int kSubpixelBits = 8;
+        constexpr int64_t kSubpixelScale = int64_t{1} << kSubpixelBits;
+        constexpr float kGuardBand = static_cast<float>(1 << 19);
+
+        struct Vec4 {
+            float x, y, z, w;
+        };
+
+        Vec4 TransformPoint(const Matrix& m, const Vec4& p) {
+            return Vec4{
+                m.m0 * p.x + m.m4 * p.y + m.m8 * p.z + m.m12 * p.w,
+                m.m1 * p.x + m.m5 * p.y + m.m9 * p.z + m.m13 * p.w,
+                m.m2 * p.x + m.m6 * p.y + m.m10 * p.z + m.m14 * p.w,
+                m.m3 * p.x + m.m7 * p.y + m.m11 * p.z + m.m15 * p.w
+            };
+        }
+
+        struct FixedPoint {
+            int64_t x;
+            int64_t y;
+        };
+
+        FixedPoint ToFixed(const float x, const float y) {
+            return FixedPoint{
+                std::llround(std::clamp(x, -kGuardBand, kGuardBand) * kSubpixelScale),
+                std::llround(std::clamp(y, -kGuardBand, kGuardBand) * kSubpixelScale)
+            };
+        }
+
+        int64_t EdgeFunction(const FixedPoint& a, const FixedPoint& b, const int64_t px, const int64_t py) {
+            return (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+        }
+
+        // Pixels centered exactly on an edge belong to the triangle only if it is a top or left edge
+        // (y points down, triangles wound so that their area is positive)
+        int64_t EdgeBias(const FixedPoint& a, const FixedPoint& b) {
+            const int64_t dx = b.x - a.x;
+            const int64_t dy = b.y - a.y;
+            return (dy == 0 && dx > 0) || dy < 0 ? 0 : -1;
+        }
+
+        int WrapTexel(const int coordinate, const int size, const bool clamp) {
+            if (clamp) {
+                return std::clamp(coordinate, 0, size - 1);
+            }
+            const int wrapped = coordinate % size;
+            return wrapped < 0 ? wrapped + size : wrapped;
+        }
+
+        // Reduces a texture coordinate to [0, 1], as the wrap mode would
+        float WrapCoordinate(const float coordinate, const bool clamp) {
+            if (!std::isfinite(coordinate)) {
+                return 0.0f;
+            }
+            return clamp ? std::clamp(coordinate, 0.0f, 1.0f) : coordinate - std::floor(coordinate);
+        }
+
+        void FetchTexel(const SoftwareTexture& texture, const int x, const int y, float out[4]) {
+            const uint8_t* texel = texture.image->rgba.data() + (static_cast<size_t>(y) * texture.image->width + x) * 4;
+            for (int i = 0; i < 4; ++i) {
+                out[i] = texel[i] / 255.0f;
+            }
+        }
+
+        void SampleTexture(const SoftwareTexture& texture, const float u, const float v, float out[4]) {
+            const float s = WrapCoordinate(u, texture.clamp) * texture.image->width;
+            const float t = WrapCoordinate(v, texture.clamp) * texture.image->height;
+            if (!texture.bilinear) {
+                FetchTexel(texture,
+                           WrapTexel(static_cast<int>(s), texture.image->width, texture.clamp),
+                           WrapTexel(static_cast<int>(t), texture.image->height, texture.clamp),
+                           out);
+                return;
+            }
+
+            // Texel centers sit at half-integer coordinates, as on the GPU
+            const float fx = s - 0.5f;
+            const float fy = t - 0.5f;
+            const int x0 = static_cast<int>(std::floor(fx));
+            const int y0 = static_cast<int>(std::floor(fy));
+            const float tx = fx - x0;
+            const float ty = fy - y0;
+            const int xs[2] = {
+                WrapTexel(x0, texture.image->width, texture.clamp),
+                WrapTexel(x0 + 1, texture.image->width, texture.clamp)
+            };
+            const int ys[2] = {
+                WrapTexel(y0, texture.image->height, texture.clamp),
+                WrapTexel(y0 + 1, texture.image->height, texture.clamp)
+            };
+
+            float corners[4][4];
+            FetchTexel(texture, xs[0], ys[0], corners[0]);
+            FetchTexel(texture, xs[1], ys[0], corners[1]);
+            FetchTexel(texture, xs[0], ys[1], corners[2]);
+            FetchTexel(texture, xs[1], ys[1], corners[3]);
+            for (int i = 0; i < 4; ++i) {
+                const float top = corners[0][i] + (corners[1][i] - corners[0][i]) * tx;
+                const float bottom = corners[2][i] + (corners[3][i] - corners[2][i]) * tx;
+                out[i] = top + (bottom - top) * ty;
+            }
+        }
+    }
+
+    SoftwareRasterizer::SoftwareRasterizer(const int width, const int height)
+        : width_(width),
+          height_(height),
+          color_(static_cast<size_t>(width) * height * 4, 0),
+          depth_(static_cast<size_t>(width) * height, 1.0f) {}
+
+    void SoftwareRasterizer::setCamera(const Camera3D& camera) {
+        const double aspect = static_cast<double>(width_) / static_cast<double>(height_);
+        if (camera.projection == CAMERA_ORTHOGRAPHIC) {
+            const double top = camera.fovy / 2.0;
+            const double right = top * aspect;
+            projection_ = MatrixOrtho(-right, right, -top, top, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+        }
+        else {
+            projection_ = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR,
+                                            RL_CULL_DISTANCE_FAR);
+        }
+        view_ = MatrixLookAt(camera.position, camera.target, camera.up);
+    }
+
+    void SoftwareRasterizer::drawMesh(const MeshVertices& mesh, const SoftwareTexture* texture) {
+        if (texture && (!texture->image || texture->image->width <= 0 || texture->image->height <= 0 ||
+                        texture->image->rgba.size() <
+                            static_cast<size_t>(texture->image->width) * texture->image->height * 4)) {
+            texture = nullptr;
+        }
+
+        const size_t vertexCount = mesh.positions.size();
+        std::vector<ScreenVertex> screen(vertexCount);
+        std::vector<char> inFront(vertexCount, 0);
+        for (size_t i = 0; i < vertexCount; ++i) {
+            const auto& position = mesh.positions[i];
+            const Vec4 eye = TransformPoint(view_, Vec4{position.x, position.y, position.z, 1.0f});
+            const Vec4 clip = TransformPoint(projection_, eye);
+            if (clip.w <= kMinClipW) {
+                continue;
+            }
+            inFront[i] = 1;
+
+            auto& vertex = screen[i];
+            vertex.invW = 1.0f / clip.w;
+            vertex.x = (clip.x * vertex.invW * 0.5f + 0.5f) * static_cast<float>(width_);
+            vertex.y = (0.5f - clip.y * vertex.invW * 0.5f) * static_cast<float>(height_);
+            vertex.z = clip.z * vertex.invW;
+            vertex.u = mesh.texcoords[i].x * vertex.invW;
+            vertex.v = mesh.texcoords[i].y * vertex.invW;
+            const auto& color = mesh.colors[i];
+            vertex.color[0] = color.r / 255.0f * vertex.invW;
+            vertex.color[1] = color.g / 255.0f * vertex.invW;
+            vertex.color[2] = color.b / 255.0f * vertex.invW;
+            vertex.color[3] = color.a / 255.0f * vertex.invW;
+        }
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            const uint16_t i0 = mesh.indices[i + 0];
+            const uint16_t i1 = mesh.indices[i + 1];
+            const uint16_t i2 = mesh.indices[i + 2];
+            if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) {
+                continue;
+            }
+            // Triangles crossing behind the camera are dropped rather than clipped; the thumbnail camera
+            // is orthographic and placed in front of the whole model, so this never happens there
+            if (!inFront[i0] || !inFront[i1] || !inFront[i2]) {
+                continue;
+            }
+            drawTriangle_(screen[i0], screen[i1], screen[i2], texture);
+        }
+    }
+
+    void SoftwareRasterizer::drawTriangle_(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c,
+                                           const SoftwareTexture* texture) {
+        const ScreenVertex* va = &a;
+        const ScreenVertex* vb = &b;
+        const ScreenVertex* vc = &c;
+        FixedPoint pa = ToFixed(a.x, a.y);
+        FixedPoint pb = ToFixed(b.x, b.y);
+        FixedPoint pc = ToFixed(c.x, c.y);
+        int64_t area = EdgeFunction(pa, pb, pc.x, pc.y);
+        if (area == 0) {
+            return;
+        }
+        // No backface culling: flip back-facing triangles into the same winding
+        if (area < 0) {
+            std::swap(vb, vc);
+            std::swap(pb, pc);
+            area = -area;
+        }
+        const float invArea = 1.0f / static_cast<float>(area);
+        const int64_t bias0 = EdgeBias(pb, pc);
+        const int64_t bias1 = EdgeBias(pc, pa);
+        const int64_t bias2 = EdgeBias(pa, pb);
+
+        const int minX = std::max(0, static_cast<int>(std::floor(std::min({a.x, b.x, c.x}))));
+        const int maxX = std::min(width_ - 1, static_cast<int>(std::ceil(std::max({a.x, b.x, c.x}))));
+        const int minY = std::max(0, static_cast<int>(std::floor(std::min({a.y, b.y, c.y}))));
+        const int maxY = std::min(height_ - 1, static_cast<int>(std::ceil(std::max({a.y, b.y, c.y}))));
+
+        for (int y = minY; y <= maxY; ++y) {
+            const int64_t py = y * kSubpixelScale + kSubpixelScale / 2;
+            for (int x = minX; x <= maxX; ++x) {
+                const int64_t px = x * kSubpixelScale + kSubpixelScale / 2;
+                const int64_t e0 = EdgeFunction(pb, pc, px, py);
+                const int64_t e1 = EdgeFunction(pc, pa, px, py);
+                const int64_t e2 = EdgeFunction(pa, pb, px, py);
+                if (e0 + bias0 < 0 || e1 + bias1 < 0 || e2 + bias2 < 0) {
+                    continue;
+                }
+                const float w0 = static_cast<float>(e0) * invArea;
+                const float w1 = static_cast<float>(e1) * invArea;
+                const float w2 = static_cast<float>(e2) * invArea;
+
+                const float z = w0 * va->z + w1 * vb->z + w2 * vc->z;
+                const size_t pixel = static_cast<size_t>(y) * width_ + x;
+                if (z < -1.0f || z > 1.0f || z > depth_[pixel]) {
+                    continue;
+                }
+
+                const float w = 1.0f / (w0 * va->invW + w1 * vb->invW + w2 * vc->invW);
+                float fragment[4];
+                if (texture) {
+                    SampleTexture(*texture,
+                                  (w0 * va->u + w1 * vb->u + w2 * vc->u) * w,
+                                  (w0 * va->v + w1 * vb->v + w2 * vc->v) * w,
+                                  fragment);
+                }
+                else {
+                    std::fill_n(fragment, 4, 1.0f);
+                }
+                for (int i = 0; i < 4; ++i) {
+                    const float vertexColor = (w0 * va->color[i] + w1 * vb->color[i] + w2 * vc->color[i]) * w;
+                    fragment[i] = std::clamp(fragment[i] * vertexColor, 0.0f, 1.0f);
+                }
+
+                const float alpha = fragment[3];
+                if (alpha < kAlphaTestCutoff) {
+                    continue;
+                }
+
+                // SRC_ALPHA / ONE_MINUS_SRC_ALPHA on every channel, alpha included
+                uint8_t* target = color_.data() + pixel * 4;
+                for (int i = 0; i < 4; ++i) {
+                    const float blended = fragment[i] * alpha + target[i] / 255.0f * (1.0f - alpha);
+                    target[i] = static_cast<uint8_t>(std::clamp(blended, 0.0f, 1.0f) * 255.0f + 0.5f);
+                }
+                depth_[pixel] = z;
+            }
+        }
+    }
+
+    Image SoftwareRasterizer::toImage() const {
+        Image image{};
+        image.data = MemAlloc(static_cast<unsigned int>(color_.size()));
+        if (!image.data) {
+            return image;
+        }
+        std::memcpy(image.data, color_.data(), color_.size());
+        image.width = width_;
+        image.height = height_;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        return image;
+    }
+} // namespace thumb
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "MeshBuilder.hpp"
+#include "TextureLoader.hpp"
+#include "raylib.h"
+
+namespace thumb {
+    // Decoded texture with the wrap and filter modes ModelFactory would set on its GPU copy
+    struct SoftwareTexture {
+        std::shared_ptr<const TextureImage> image;
+        bool clamp = false;    // Clamp to edge instead of repeat
+        bool bilinear = false; // Bilinear instead of nearest filtering
+    };
+
+    // Draws meshes into an RGBA8 image on the CPU, the way raylib draws them with its default shader:
+    // texel times vertex color, alpha blending and a depth test, with backface culling off.
+    // Attributes are interpolated perspective-correct. Fragments that are fully transparent are
+    // alpha-tested away, so cut-out texels neither color nor hide what is behind them.
+    //
+    // Needs no window or GL context; an instance owns its buffers, so use one per thread.
+    class SoftwareRasterizer {
+    public:
+        SoftwareRasterizer(int width, int height);
+
+        // Same view and projection as BeginMode3D with this camera
+        void setCamera(const Camera3D& camera);
+        void drawMesh(const MeshVertices& mesh, const SoftwareTexture* texture);
+
+        // Copies the color buffer into an image, top row first; the caller unloads it
+        [[nodiscard]] Image toImage() const;
+
+    private:
+        struct ScreenVertex {
+            float x = 0.0f;
+            float y = 0.0f;
+            float z = 0.0f;    // Normalised device depth, -1 at the near plane
+            float invW = 0.0f; // Attributes below are premultiplied by this
+            float u = 0.0f;
+            float v = 0.0f;
+            float color[4] = {};
+        };
+
+        void drawTriangle_(const ScreenVertex& a, const ScreenVertex& b, const ScreenVertex& c,
+                           const SoftwareTexture* texture);
+
+        int width_;
+        int height_;
+        Matrix view_{};
+        Matrix projection_{};
+        std::vector<uint8_t> color_;
+        std::vector<float> depth_;
+    };
+} // namespace thumb
@@ -0,0 +1,64 @@
+#include "TextureCache.hpp"
+
+#include "DbpfIndexService.hpp"
+
+namespace thumb {
+    std::shared_ptr<const TextureImage> TextureCache::get(
+        const Key& key, const std::function<std::optional<TextureImage>()>& decode) {
+        {
+            std::lock_guard lock(mutex_);
+            ++stats_.requests;
+            if (const auto it = entries_.find(key); it != entries_.end()) {
+                ++stats_.hits;
+                if (it->second.image) {
+                    lru_.splice(lru_.begin(), lru_, it->second.lruPosition);
+                }
+                DbpfIndexService::recordDependencies(it->second.dependencies);
+                return it->second.image;
+            }
+        }
+
+        Entry entry;
+        {
+            DbpfIndexService::DependencyScope scope(entry.dependencies);
+            if (auto decoded = decode()) {
+                entry.image = std::make_shared<const TextureImage>(std::move(*decoded));
+            }
+        }
+        auto image = entry.image;
+
+        std::lock_guard lock(mutex_);
+        if (entries_.contains(key)) {
+            return image;
+        }
+        if (!entry.image) {
+            entries_.emplace(key, std::move(entry));
+            return image;
+        }
+        const size_t bytes = entry.image->rgba.size();
+        if (bytes > maxBytes_) {
+            return image;
+        }
+        cachedBytes_ += bytes;
+        lru_.push_front(key);
+        entry.lruPosition = lru_.begin();
+        entries_.emplace(key, std::move(entry));
+        evict_();
+        return image;
+    }
+
+    TextureCacheStats TextureCache::stats() const {
+        std::lock_guard lock(mutex_);
+        return stats_;
+    }
+
+    void TextureCache::evict_() {
+        while (cachedBytes_ > maxBytes_ && !lru_.empty()) {
+            const auto it = entries_.find(lru_.back());
+            cachedBytes_ -= it->second.image->rgba.size();
+            entries_.erase(it);
+            lru_.pop_back();
+            ++stats_.evictions;
+        }
+    }
+} // namespace thumb
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "DBPFReader.h"
+#include "TextureLoader.hpp"
+#include "ThumbnailRenderer.hpp"
+
+namespace thumb {
+    // Decoded RGBA8 textures shared by every model the renderer builds. Models of the same group reuse
+    // the same textures, so most of them only need to be decoded from FSH once per scan.
+    //
+    // Textures are looked up in the model's own file before the index, so the file is part of the key.
+    // Safe to use from several threads at once; two threads missing the same key both decode it.
+    class TextureCache {
+    public:
+        struct Key {
+            uint32_t fileIndex = 0; // File the model was read from
+            uint32_t group = 0;     // Group of the model
+            uint32_t instance = 0;  // Texture ID of the material
+            bool nightMode = false;
+            bool nightOverlay = false;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        explicit TextureCache(size_t maxBytes = kDefaultTextureCacheBytes) : maxBytes_(maxBytes) {}
+
+        // Returns the cached texture, or decodes it. Null when it could not be decoded; failures are
+        // remembered too. The lookups the decode made are replayed into the active DependencyScope on hits.
+        std::shared_ptr<const TextureImage> get(const Key& key,
+                                                const std::function<std::optional<TextureImage>()>& decode);
+
+        [[nodiscard]] TextureCacheStats stats() const;
+
+    private:
+        struct KeyHash {
+            size_t operator()(const Key& key) const noexcept {
+                uint64_t hash = key.fileIndex;
+                hash = hash * 0x9E3779B97F4A7C15ull ^ key.group;
+                hash = hash * 0x9E3779B97F4A7C15ull ^ key.instance;
+                hash = hash * 0x9E3779B97F4A7C15ull ^ (key.nightMode ? 1u : 0u) ^ (key.nightOverlay ? 2u : 0u);
+                return static_cast<size_t>(hash ^ hash >> 32);
+            }
+        };
+
+        struct Entry {
+            std::shared_ptr<const TextureImage> image;
+            std::vector<DBPF::Tgi> dependencies;
+            // Position in lru_; only set when image is not null
+            std::list<Key>::iterator lruPosition;
+        };
+
+        void evict_();
+
+        mutable std::mutex mutex_;
+        std::unordered_map<Key, Entry, KeyHash> entries_;
+        std::list<Key> lru_; // Most recently used first
+        size_t maxBytes_;
+        size_t cachedBytes_ = 0;
+        TextureCacheStats stats_;
+    };
+} // namespace thumb
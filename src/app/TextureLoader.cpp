@@ -4,10 +4,11 @@
 #include <utility>
 #include <vector>
 
+#include "PixelKernels.hpp"
 #include "spdlog/spdlog.h"
 
 namespace thumb {
-    std::optional<Texture2D> TextureLoader::loadTextureForMaterial(
+    std::optional<TextureImage> TextureLoader::loadImageForMaterial(
         const DBPF::Reader& reader,
         DBPF::Tgi tgi,
         const uint32_t textureId,
@@ -64,14 +65,7 @@ namespace thumb {
                     if (FSH::Reader::ConvertToRGBA8(dayBmp, dayRgba) &&
                         FSH::Reader::ConvertToRGBA8(nightBmp, rgba)) {
                         const size_t pxCount = dayBmp.width * dayBmp.height;
-                        for (size_t i = 0; i < pxCount; ++i) {
-                            const size_t idx = i * 4;
-                            const float a = static_cast<float>(rgba[idx + 3]) / 255.0f;
-                            dayRgba[idx + 0] = static_cast<uint8_t>(dayRgba[idx + 0] * (1.0f - a) + rgba[idx + 0] * a);
-                            dayRgba[idx + 1] = static_cast<uint8_t>(dayRgba[idx + 1] * (1.0f - a) + rgba[idx + 1] * a);
-                            dayRgba[idx + 2] = static_cast<uint8_t>(dayRgba[idx + 2] * (1.0f - a) + rgba[idx + 2] * a);
-                            dayRgba[idx + 3] = dayRgba[idx + 3] > rgba[idx + 3] ? dayRgba[idx + 3] : rgba[idx + 3];
-                        }
+                        PixelKernels::blendOverlay(dayRgba.data(), rgba.data(), pxCount);
                         rgba.swap(dayRgba);
                     }
                 }
@@ -84,10 +78,18 @@ namespace thumb {
             }
         }
 
+        return TextureImage{
+            .rgba = std::move(rgba),
+            .width = static_cast<int>(night->entries[0].bitmaps[0].width),
+            .height = static_cast<int>(night->entries[0].bitmaps[0].height),
+        };
+    }
+
+    std::optional<Texture2D> TextureLoader::uploadImage(const TextureImage& image) {
         Image img{
-            .data = rgba.data(),
-            .width = night->entries[0].bitmaps[0].width,
-            .height = night->entries[0].bitmaps[0].height,
+            .data = const_cast<uint8_t*>(image.rgba.data()),
+            .width = image.width,
+            .height = image.height,
             .mipmaps = 1,
             .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
         };
@@ -98,4 +100,18 @@ namespace thumb {
         }
         return texture;
     }
+
+    std::optional<Texture2D> TextureLoader::loadTextureForMaterial(
+        const DBPF::Reader& reader,
+        const DBPF::Tgi tgi,
+        const uint32_t textureId,
+        const bool nightMode,
+        const bool nightOverlay,
+        std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)> extraLookup) {
+        auto decoded = loadImageForMaterial(reader, tgi, textureId, nightMode, nightOverlay, std::move(extraLookup));
+        if (!decoded) {
+            return std::nullopt;
+        }
+        return uploadImage(*decoded);
+    }
 } // namespace thumb
@@ -3,14 +3,33 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <vector>
 
 #include "DBPFReader.h"
 #include "FSHReader.h"
 #include "raylib.h"
 
 namespace thumb {
+    struct TextureImage {
+        std::vector<uint8_t> rgba;
+        int width = 0;
+        int height = 0;
+    };
+
     class TextureLoader {
     public:
+        // Decodes the texture to RGBA8 without touching the GPU
+        static std::optional<TextureImage> loadImageForMaterial(
+            const DBPF::Reader& reader,
+            DBPF::Tgi tgi,
+            uint32_t textureId,
+            bool nightMode,
+            bool nightOverlay,
+            std::function<std::optional<FSH::Record>(uint32_t inst, uint32_t group)> extraLookup = {});
+
+        // Uploads a decoded texture to the GPU
+        static std::optional<Texture2D> uploadImage(const TextureImage& image);
+
         static std::optional<Texture2D> loadTextureForMaterial(
             const DBPF::Reader& reader,
             DBPF::Tgi tgi,
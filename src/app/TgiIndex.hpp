@@ -0,0 +1,168 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "TGI.h"
+
+// Read-only map from TGI to the indices of the files containing it, in load order.
+//
+// Built once from every (TGI, file index) pair of a scan. Keys live in an open-addressed table with
+// linear probing; each slot refers to a run of file indices in one shared array. A lookup is a
+// handful of probes over contiguous memory and never allocates, unlike a node-based map holding a
+// vector per key.
+class TgiIndex {
+public:
+    struct Entry {
+        DBPF::Tgi tgi;
+        uint32_t fileIndex = 0;
+    };
+
+    TgiIndex() = default;
+
+    // Entries must be in load order; files sharing a TGI keep that order in find()
+    explicit TgiIndex(const std::span<const Entry> entries) {
+        build(entries);
+    }
+
+    void build(const std::span<const Entry> entries) {
+        clear();
+        if (entries.empty()) {
+            return;
+        }
+
+        // Every entry could be a distinct key, so this keeps the load factor at or below 0.75
+        const size_t capacity = std::bit_ceil(std::max<size_t>(16, entries.size() + entries.size() / 3));
+        slots_.assign(capacity, Slot{});
+        mask_ = capacity - 1;
+
+        // First pass: claim a slot per distinct key and count its files
+        std::vector<uint32_t> entrySlots(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto slot = findOrInsert_(entries[i].tgi);
+            ++slots_[slot].count;
+            entrySlots[i] = static_cast<uint32_t>(slot);
+        }
+
+        // Lay out each key's run of file indices
+        uint32_t offset = 0;
+        for (auto& slot : slots_) {
+            slot.offset = offset;
+            offset += slot.count;
+        }
+
+        // Second pass: fill the runs, reusing offset as the write cursor
+        fileIndices_.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i) {
+            auto& slot = slots_[entrySlots[i]];
+            fileIndices_[slot.offset++] = entries[i].fileIndex;
+        }
+        for (auto& slot : slots_) {
+            slot.offset -= slot.count;
+        }
+    }
+
+    void clear() {
+        slots_.clear();
+        fileIndices_.clear();
+        mask_ = 0;
+        size_ = 0;
+    }
+
+    // Indices of the files containing tgi, in load order; empty if it is not indexed.
+    // The span stays valid until the index is rebuilt or cleared.
+    [[nodiscard]] std::span<const uint32_t> find(const DBPF::Tgi& tgi) const {
+        if (slots_.empty()) {
+            return {};
+        }
+        for (size_t pos = Hash(tgi) & mask_;; pos = (pos + 1) & mask_) {
+            const auto& slot = slots_[pos];
+            if (slot.count == 0) {
+                return {};
+            }
+            if (slot.tgi == tgi) {
+                return {fileIndices_.data() + slot.offset, slot.count};
+            }
+        }
+    }
+
+    // The file whose copy of tgi is used: the last one to contain it in load order
+    [[nodiscard]] std::optional<uint32_t> winner(const DBPF::Tgi& tgi) const {
+        const auto files = find(tgi);
+        if (files.empty()) {
+            return std::nullopt;
+        }
+        return files.back();
+    }
+
+    [[nodiscard]] bool contains(const DBPF::Tgi& tgi) const {
+        return !find(tgi).empty();
+    }
+
+    // Calls fn(tgi, fileIndices) for every indexed TGI, in no particular order
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& slot : slots_) {
+            if (slot.count != 0) {
+                fn(slot.tgi, std::span<const uint32_t>(fileIndices_.data() + slot.offset, slot.count));
+            }
+        }
+    }
+
+    // Number of distinct TGIs
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_t memoryBytes() const {
+        return slots_.capacity() * sizeof(Slot) + fileIndices_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    // count == 0 marks an empty slot, since every indexed key has at least one file
+    struct Slot {
+        DBPF::Tgi tgi;
+        uint32_t offset = 0;
+        uint32_t count = 0;
+    };
+
+    static size_t Hash(const DBPF::Tgi& tgi) {
+        // Instance IDs carry most of the entropy; mix all three words so that types and groups
+        // sharing instance ranges still spread out
+        uint64_t h = (static_cast<uint64_t>(tgi.type) << 32 | tgi.group) * 0x9E3779B97F4A7C15ull;
+        h ^= tgi.instance + 0x632BE59BD9B4E019ull + (h << 6) + (h >> 2);
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return static_cast<size_t>(h);
+    }
+
+    size_t findOrInsert_(const DBPF::Tgi& tgi) {
+        for (size_t pos = Hash(tgi) & mask_;; pos = (pos + 1) & mask_) {
+            auto& slot = slots_[pos];
+            if (slot.count == 0) {
+                slot.tgi = tgi;
+                ++size_;
+                return pos;
+            }
+            if (slot.tgi == tgi) {
+                return pos;
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> fileIndices_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+};
@@ -32,70 +32,154 @@
 
 namespace ThumbnailBin {
 
-    inline void Write(const std::filesystem::path& path, std::vector<std::pair<uint64_t, Thumbnail>> entries) {
-        if (entries.empty()) {
-            return;
+    // Builds a thumbnail file from entries added one at a time, in any order. Pixel data goes straight
+    // to a spool file next to the output, so only the keys are held in memory; finish() then writes the
+    // sorted file from the spool.
+    class Spool {
+    public:
+        explicit Spool(std::filesystem::path binPath)
+            : binPath_(std::move(binPath)) {
+            spoolPath_ = binPath_;
+            spoolPath_ += ".spool";
         }
 
-        // Determine common dimensions from first entry (all thumbnails must match).
-        uint16_t commonWidth = 0;
-        uint16_t commonHeight = 0;
-        rfl::visit(
-            [&](const auto& variant) {
-                commonWidth = static_cast<uint16_t>(variant.width);
-                commonHeight = static_cast<uint16_t>(variant.height);
-            },
-            entries[0].second);
-
-        for (const auto& thumbnail : entries | std::views::values) {
+        ~Spool() {
+            discard();
+        }
+
+        Spool(const Spool&) = delete;
+        Spool& operator=(const Spool&) = delete;
+
+        // Every thumbnail must have the dimensions of the first one added
+        void add(const uint64_t key, const Thumbnail& thumbnail) {
             rfl::visit(
                 [&](const auto& variant) {
-                    if (variant.width != commonWidth || variant.height != commonHeight) {
-                        throw std::runtime_error("ThumbnailBin::Write requires uniform thumbnail dimensions");
+                    if (spooled_ == 0) {
+                        width_ = static_cast<uint16_t>(variant.width);
+                        height_ = static_cast<uint16_t>(variant.height);
+                        spool_.open(spoolPath_, std::ios::binary | std::ios::trunc);
+                        if (!spool_) {
+                            throw std::runtime_error("ThumbnailBin::Spool could not open " + spoolPath_.string());
+                        }
                     }
-                    const size_t expectedSize = static_cast<size_t>(commonWidth) * commonHeight * 4;
-                    if (variant.data.size() != expectedSize) {
-                        throw std::runtime_error("ThumbnailBin::Write received malformed RGBA thumbnail data");
+                    if (variant.width != width_ || variant.height != height_) {
+                        throw std::runtime_error("ThumbnailBin::Spool requires uniform thumbnail dimensions");
                     }
+                    if (variant.data.size() != blobSize_()) {
+                        throw std::runtime_error("ThumbnailBin::Spool received malformed RGBA thumbnail data");
+                    }
+                    spool_.write(reinterpret_cast<const char*>(variant.data.data()),
+                                 static_cast<std::streamsize>(variant.data.size()));
                 },
                 thumbnail);
+            entries_.push_back({key, spooled_++});
         }
 
-        // Sort by gi_key so the reader can easily binary-search.
-        std::ranges::sort(entries, [](const auto& a, const auto& b) { return a.first < b.first; });
+        // Drops the entries whose key does not satisfy keep; their pixels stay in the spool unused
+        template<typename Pred>
+        void retainIf(Pred&& keep) {
+            std::erase_if(entries_, [&](const Entry& entry) { return !keep(entry.key); });
+        }
 
-        std::ofstream file(path, std::ios::binary);
-        if (!file) {
-            return;
+        [[nodiscard]] size_t size() const {
+            return entries_.size();
         }
 
-        // Header
-        constexpr char magic[4] = {'S', 'P', 'T', 'H'};
-        constexpr uint16_t version = 1;
-        constexpr uint16_t reserved = 0;
-        const auto count = entries.size();
-
-        file.write(magic, 4);
-        file.write(reinterpret_cast<const char*>(&version), 2);
-        file.write(reinterpret_cast<const char*>(&reserved), 2);
-        file.write(reinterpret_cast<const char*>(&count), 4);
-        file.write(reinterpret_cast<const char*>(&commonWidth), 2);
-        file.write(reinterpret_cast<const char*>(&commonHeight), 2);
-
-        // Index
-        for (const auto& key : entries | std::views::keys) {
-            file.write(reinterpret_cast<const char*>(&key), 8);
+        [[nodiscard]] bool empty() const {
+            return entries_.empty();
         }
 
-        // Data
-        for (const auto& thumbnail : entries | std::views::values) {
-            rfl::visit(
-                [&](const auto& variant) {
-                    file.write(reinterpret_cast<const char*>(variant.data.data()),
-                               static_cast<std::streamsize>(variant.data.size()));
-                },
-                thumbnail);
+        // Writes the thumbnail file and removes the spool. Returns false, and keeps the previous file, if
+        // there was nothing to write or the file could not be written.
+        bool finish() {
+            if (entries_.empty()) {
+                discard();
+                return false;
+            }
+            spool_.close();
+
+            // Sort by gi_key so the reader can easily binary-search.
+            std::ranges::sort(entries_, {}, &Entry::key);
+
+            // Written next to the target and renamed over it, so readers never see a partial file
+            auto tempPath = binPath_;
+            tempPath += ".tmp";
+            std::ifstream spool(spoolPath_, std::ios::binary);
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            if (!spool || !file) {
+                discard();
+                return false;
+            }
+
+            // Header
+            constexpr char magic[4] = {'S', 'P', 'T', 'H'};
+            constexpr uint16_t version = 1;
+            constexpr uint16_t reserved = 0;
+            const auto count = static_cast<uint32_t>(entries_.size());
+
+            file.write(magic, 4);
+            file.write(reinterpret_cast<const char*>(&version), 2);
+            file.write(reinterpret_cast<const char*>(&reserved), 2);
+            file.write(reinterpret_cast<const char*>(&count), 4);
+            file.write(reinterpret_cast<const char*>(&width_), 2);
+            file.write(reinterpret_cast<const char*>(&height_), 2);
+
+            // Index
+            for (const auto& entry : entries_) {
+                file.write(reinterpret_cast<const char*>(&entry.key), 8);
+            }
+
+            // Data, copied from the spool in index order
+            std::vector<char> blob(blobSize_());
+            for (const auto& entry : entries_) {
+                spool.seekg(static_cast<std::streamoff>(entry.slot * blob.size()));
+                spool.read(blob.data(), static_cast<std::streamsize>(blob.size()));
+                file.write(blob.data(), static_cast<std::streamsize>(blob.size()));
+            }
+            file.close();
+            bool written = spool && file;
+
+            spool.close();
+            discard();
+            std::error_code ec;
+            if (written) {
+                std::filesystem::rename(tempPath, binPath_, ec);
+                written = !ec;
+            }
+            if (!written) {
+                std::filesystem::remove(tempPath, ec);
+            }
+            return written;
         }
-    }
+
+        // Forgets all entries and deletes the spool file
+        void discard() {
+            if (spool_.is_open()) {
+                spool_.close();
+            }
+            entries_.clear();
+            spooled_ = 0;
+            std::error_code ec;
+            std::filesystem::remove(spoolPath_, ec);
+        }
+
+    private:
+        struct Entry {
+            uint64_t key;
+            uint64_t slot;  // Position of the pixels in the spool, in blobs
+        };
+
+        [[nodiscard]] size_t blobSize_() const {
+            return static_cast<size_t>(width_) * height_ * 4;
+        }
+
+        std::filesystem::path binPath_;
+        std::filesystem::path spoolPath_;
+        std::ofstream spool_;
+        std::vector<Entry> entries_;
+        uint64_t spooled_ = 0;
+        uint16_t width_ = 0;
+        uint16_t height_ = 0;
+    };
 
 } // namespace ThumbnailBin
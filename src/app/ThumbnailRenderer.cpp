@@ -3,11 +3,18 @@
 #include <algorithm>
 #include <cmath>
 
+#include "GpuTileAtlas.hpp"
+#include "MeshBuilder.hpp"
 #include "ModelFactory.hpp"
+#include "PixelKernels.hpp"
+#include "RenderCache.hpp"
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
 #include "S3DStructures.h"
+#include "SoftwareRasterizer.hpp"
+#include "TextureCache.hpp"
+#include "TextureLoader.hpp"
 #include "spdlog/spdlog.h"
 
 namespace thumb {
@@ -15,6 +22,11 @@ namespace thumb {
         constexpr auto kTypeIdS3D = 0x5AD0E817u;
         constexpr auto kTypeIdFSH = 0x7AB50E44u;
         constexpr auto kTypeIdATC = 0x29A5D1ECu;
+        constexpr auto kFallbackTextureGroup = 0x1ABE787Du;
+        // Part of every persistent render cache key. Bump it whenever a change here alters the pixels
+        // rendered for the same model, so that thumbnails from older builds are not reused.
+        constexpr uint64_t kRendererVersion = 1;
+        constexpr uint64_t kCpuBackendKeyTag = 0x435055; // "CPU"
         constexpr bool kEnableSilhouettePostFit = true;
         constexpr uint32_t kSupersampleFactor = 2;
         constexpr uint8_t kAlphaFitThreshold = 12;
@@ -33,63 +45,302 @@ namespace thumb {
         };
         constexpr size_t kThumbnailZoomIndex = 4; // SC4 zoom 5 framing
 
-        struct AlphaBounds {
-            int minX;
-            int minY;
-            int maxX;
-            int maxY;
-        };
-
         std::optional<AlphaBounds> FindVisibleAlphaBounds(const Image& image, const uint8_t alphaThreshold) {
             if (!image.data || image.width <= 0 || image.height <= 0 || image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
                 return std::nullopt;
             }
 
-            const auto* pixels = static_cast<const uint8_t*>(image.data);
-            AlphaBounds bounds{
-                .minX = image.width,
-                .minY = image.height,
-                .maxX = -1,
-                .maxY = -1
+            return PixelKernels::findAlphaBounds(static_cast<const uint8_t*>(image.data), image.width, image.height,
+                                                 alphaThreshold);
+        }
+
+        // Points the SC4 thumbnail camera at bounds and sizes the orthographic view to fit them.
+        // Nullopt for degenerate bounds.
+        std::optional<Camera3D> FrameModel(const BoundingBox& bounds, const uint32_t size, const uint32_t renderSize,
+                                           const DBPF::Tgi& tgi) {
+            const Vector3 sizeVec = Vector3Subtract(bounds.max, bounds.min);
+
+            const auto maxDim = std::max(std::max(sizeVec.x, sizeVec.y), sizeVec.z);
+            if (maxDim <= 0.001f) {
+                spdlog::warn("Thumbnail renderer: degenerate bounds for {} (maxDim={})", tgi.ToString(), maxDim);
+                return std::nullopt;
+            }
+            const Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
+            const Vector3 framingTarget{
+                center.x,
+                bounds.min.y,
+                center.z
+            };
+
+            Camera3D camera{};
+            camera.projection = CAMERA_ORTHOGRAPHIC;
+
+            camera.fovy = static_cast<float>(size) / 2.0f;
+            camera.up = Vector3{0.0f, 1.0f, 0.0f};
+            camera.target = framingTarget;
+
+            const Vector3 dir{
+                std::cos(kSc4DefaultYawRadians) * std::cos(kSc4DefaultPitchRadians[kThumbnailZoomIndex]),
+                std::sin(kSc4DefaultPitchRadians[kThumbnailZoomIndex]),
+                std::sin(kSc4DefaultYawRadians) * std::cos(kSc4DefaultPitchRadians[kThumbnailZoomIndex])
             };
 
-            for (int y = 0; y < image.height; ++y) {
-                for (int x = 0; x < image.width; ++x) {
-                    const size_t index = (static_cast<size_t>(y) * image.width + x) * 4;
-                    if (pixels[index + 3] < alphaThreshold) {
-                        continue;
+            // Compute ortho size to tightly fit all corners after rotation
+            // We project all 8 corners of the bounding box onto the camera basis and
+            // compute both viewport extents and the depth needed to keep the camera
+            // in front of the closest geometry.
+            Vector3 forward = Vector3Normalize(Vector3Negate(dir));
+            Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+            Vector3 camUp = Vector3Normalize(Vector3CrossProduct(right, forward));
+
+            auto minRight = std::numeric_limits<float>::max();
+            auto maxRight = std::numeric_limits<float>::lowest();
+            auto minUp = std::numeric_limits<float>::max();
+            auto maxUp = std::numeric_limits<float>::lowest();
+            auto minForward = std::numeric_limits<float>::max();
+            auto maxForward = std::numeric_limits<float>::lowest();
+            for (auto xi = 0; xi < 2; ++xi) {
+                for (auto yi = 0; yi < 2; ++yi) {
+                    for (auto zi = 0; zi < 2; ++zi) {
+                        Vector3 corner{
+                            xi ? bounds.max.x : bounds.min.x,
+                            yi ? bounds.max.y : bounds.min.y,
+                            zi ? bounds.max.z : bounds.min.z
+                        };
+                        Vector3 toCorner = Vector3Subtract(corner, framingTarget);
+                        const float projRight = Vector3DotProduct(toCorner, right);
+                        const float projUp = Vector3DotProduct(toCorner, camUp);
+                        const float projForward = Vector3DotProduct(toCorner, forward);
+                        minRight = std::min(minRight, projRight);
+                        maxRight = std::max(maxRight, projRight);
+                        minUp = std::min(minUp, projUp);
+                        maxUp = std::max(maxUp, projUp);
+                        minForward = std::min(minForward, projForward);
+                        maxForward = std::max(maxForward, projForward);
                     }
-                    bounds.minX = std::min(bounds.minX, x);
-                    bounds.minY = std::min(bounds.minY, y);
-                    bounds.maxX = std::max(bounds.maxX, x);
-                    bounds.maxY = std::max(bounds.maxY, y);
                 }
             }
 
-            if (bounds.maxX < bounds.minX || bounds.maxY < bounds.minY) {
-                return std::nullopt;
+            const float leftBound = minRight * kHorizontalPadding;
+            const float rightBound = maxRight * kHorizontalPadding;
+            const float bottomBound = minUp * kBottomPadding;
+            const float topBound = maxUp * kTopPadding;
+
+            const float centerRight = (leftBound + rightBound) * 0.5f;
+            const float centerUp = (bottomBound + topBound) * 0.5f;
+
+            float orthoHalfSize = std::max({
+                std::abs(leftBound - centerRight),
+                std::abs(rightBound - centerRight),
+                std::abs(bottomBound - centerUp),
+                std::abs(topBound - centerUp)
+            });
+            if (orthoHalfSize <= 0.0f) {
+                orthoHalfSize = static_cast<float>(renderSize) / 2.0f;
             }
 
-            return bounds;
+            const float nearMargin = std::max(maxDim * 0.25f, 4.0f);
+            const float maxDistance = std::max(nearMargin, 900.0f - std::max(0.0f, maxForward));
+            const float camDistance = std::clamp(-minForward + nearMargin, nearMargin, maxDistance);
+            const float targetOffsetX = centerRight;
+            const float targetOffsetY = centerUp;
+            const Vector3 cameraTarget = Vector3Add(
+                framingTarget,
+                Vector3Add(Vector3Scale(right, targetOffsetX), Vector3Scale(camUp, targetOffsetY)));
+            camera.target = cameraTarget;
+            camera.position = Vector3Add(cameraTarget, Vector3Scale(dir, camDistance));
+            camera.fovy = orthoHalfSize * 2.0f;
+
+            spdlog::trace(
+                "Thumbnail renderer camera for {}: maxDim={}, camDistance={}, orthoHalfSize={}, focusY={}, offset=({}, {}), depth=[{}, {}], sc4Camera[yaw={}, pitchZoom{}={}]",
+                tgi.ToString(), maxDim, camDistance, orthoHalfSize, framingTarget.y, targetOffsetX, targetOffsetY,
+                minForward, maxForward, kSc4DefaultYawRadians, kThumbnailZoomIndex + 1,
+                kSc4DefaultPitchRadians[kThumbnailZoomIndex]);
+            return camera;
+        }
+
+        // Crops a supersampled render to its silhouette and scales it into a size x size BGRA thumbnail.
+        // Nullopt when nothing visible was drawn.
+        std::optional<RenderedImage> FitThumbnail(const Image& image, const uint32_t size, const uint32_t renderSize) {
+            Image finalImage{};
+            if (kEnableSilhouettePostFit) {
+                std::optional<AlphaBounds> visibleBounds = FindVisibleAlphaBounds(image, kAlphaFitThreshold);
+                if (!visibleBounds.has_value()) {
+                    return std::nullopt;
+                }
+
+                const int visibleWidth = visibleBounds->maxX - visibleBounds->minX + 1;
+                const int visibleHeight = visibleBounds->maxY - visibleBounds->minY + 1;
+                const int margin = std::max(1, static_cast<int>(std::ceil(std::max(visibleWidth, visibleHeight) * kPostFitMarginRatio)));
+                Rectangle cropRect{
+                    static_cast<float>(std::max(0, visibleBounds->minX - margin)),
+                    static_cast<float>(std::max(0, visibleBounds->minY - margin)),
+                    static_cast<float>(std::min(static_cast<int>(renderSize), visibleBounds->maxX + margin + 1) -
+                                       std::max(0, visibleBounds->minX - margin)),
+                    static_cast<float>(std::min(static_cast<int>(renderSize), visibleBounds->maxY + margin + 1) -
+                                       std::max(0, visibleBounds->minY - margin))
+                };
+
+                Image cropped = ImageFromImage(image, cropRect);
+                if (cropped.data == nullptr) {
+                    return std::nullopt;
+                }
+
+                const float fitScale = std::min(
+                    static_cast<float>(size) / static_cast<float>(cropped.width),
+                    static_cast<float>(size) / static_cast<float>(cropped.height));
+                const int fittedWidth = std::max(1, static_cast<int>(std::round(cropped.width * fitScale)));
+                const int fittedHeight = std::max(1, static_cast<int>(std::round(cropped.height * fitScale)));
+
+                ImageResize(&cropped, fittedWidth, fittedHeight);
+                ImageFormat(&cropped, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+                finalImage = GenImageColor(static_cast<int>(size), static_cast<int>(size), BLANK);
+                const Rectangle srcRect{
+                    0.0f,
+                    0.0f,
+                    static_cast<float>(cropped.width),
+                    static_cast<float>(cropped.height)
+                };
+                const Rectangle dstRect{
+                    std::floor((static_cast<float>(size) - cropped.width) * 0.5f),
+                    std::floor((static_cast<float>(size) - cropped.height) * 0.5f),
+                    static_cast<float>(cropped.width),
+                    static_cast<float>(cropped.height)
+                };
+                ImageDraw(&finalImage, cropped, srcRect, dstRect, WHITE);
+                UnloadImage(cropped);
+            }
+            else {
+                finalImage = ImageCopy(image);
+                ImageResize(&finalImage, static_cast<int>(size), static_cast<int>(size));
+                ImageFormat(&finalImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            }
+
+            RenderedImage rendered;
+            rendered.width = size;
+            rendered.height = size;
+            rendered.pixels.resize(size * size * 4);
+            if (finalImage.data) {
+                PixelKernels::swapRedBlue(static_cast<const uint8_t*>(finalImage.data),
+                                          reinterpret_cast<uint8_t*>(rendered.pixels.data()),
+                                          rendered.pixels.size() / 4);
+            }
+            UnloadImage(finalImage);
+            return rendered;
         }
     }
 
-    ThumbnailRenderer::ThumbnailRenderer(const DbpfIndexService& indexService)
+    ThumbnailRenderer::ThumbnailRenderer(const DbpfIndexService& indexService,
+                                         const RenderBackend backend,
+                                         const size_t renderCacheBytes)
         : indexService_(indexService),
-          modelFactory_(std::make_shared<ModelFactory>()) {}
+          backend_(backend),
+          textureCache_(std::make_unique<TextureCache>()),
+          modelFactory_(std::make_shared<ModelFactory>(textureCache_.get())),
+          renderCacheBytes_(renderCacheBytes) {}
 
     ThumbnailRenderer::~ThumbnailRenderer() {
+        atlas_.reset();
         if (initialized_) {
             CloseWindow();
         }
     }
 
     std::optional<RenderedImage> ThumbnailRenderer::renderModel(const DBPF::Tgi& tgi, const uint32_t size) {
+        return render_(tgi, size, false);
+    }
+
+    void ThumbnailRenderer::prerenderModel(const DBPF::Tgi& tgi, const uint32_t size) {
+        if (tgi.type == kTypeIdS3D) {
+            render_(tgi, size, true);
+        }
+    }
+
+    void ThumbnailRenderer::prerenderModels(const std::span<const DBPF::Tgi> tgis, const uint32_t size) {
         if (size == 0) {
-            return std::nullopt;
+            return;
+        }
+        if (rendersConcurrently()) {
+            for (const auto& tgi : tgis) {
+                prerenderModel(tgi, size);
+            }
+            return;
+        }
+
+        struct BatchItem {
+            RenderKey key;
+            std::optional<uint64_t> contentKey;
+            CachedRender cached;
+            bool resolved = false;
+        };
+        std::vector<BatchItem> batch;
+        {
+            std::unordered_set<RenderKey, RenderKeyHash> queued;
+            std::lock_guard lock(renderMutex_);
+            for (const auto& tgi : tgis) {
+                const RenderKey key{tgi, size};
+                if (tgi.type != kTypeIdS3D || renderCache_.contains(key) || !queued.insert(key).second) {
+                    continue;
+                }
+                batch.push_back(BatchItem{.key = key});
+            }
+        }
+
+        std::vector<GpuTile> tiles;
+        for (auto& item : batch) {
+            DbpfIndexService::DependencyScope scope(item.cached.dependencies);
+            std::optional<S3D::Record> model;
+            item.contentKey = persistentKey_(item.key.tgi, size, model);
+            if (item.contentKey) {
+                if (findPersistent_(*item.contentKey, item.cached.image)) {
+                    item.resolved = true;
+                    continue;
+                }
+            }
+            tiles.push_back(GpuTile{.tgi = item.key.tgi, .model = std::move(model)});
+        }
+
+        if (!tiles.empty() && !ensureInitialized_()) {
+            spdlog::warn("Thumbnail renderer failed to initialize raylib, rendering on the CPU instead");
+            backend_.store(RenderBackend::Cpu, std::memory_order_release);
+            for (const auto& tile : tiles) {
+                prerenderModel(tile.tgi, size);
+            }
+            tiles.clear();
+        }
+        else if (!tiles.empty()) {
+            drawGpuTiles_(tiles, size);
+            auto tile = tiles.begin();
+            for (auto& item : batch) {
+                if (item.resolved) {
+                    continue;
+                }
+                item.cached.image = std::move(tile->image);
+                item.cached.dependencies.insert(item.cached.dependencies.end(),
+                                                tile->dependencies.begin(), tile->dependencies.end());
+                if (item.contentKey) {
+                    storePersistent_(*item.contentKey, item.cached.image, tile->renderFailed);
+                }
+                item.resolved = true;
+                ++tile;
+            }
         }
-        if (!ensureInitialized_()) {
-            spdlog::warn("Thumbnail renderer failed to initialize raylib");
+
+        std::lock_guard lock(renderMutex_);
+        for (auto& item : batch) {
+            if (!item.resolved) {
+                continue;
+            }
+            ++renderCacheStats_.renders;
+            item.cached.prerendered = true;
+            insertRender_(item.key, std::move(item.cached));
+        }
+    }
+
+    std::optional<RenderedImage> ThumbnailRenderer::render_(const DBPF::Tgi& tgi, const uint32_t size,
+                                                            const bool prerender) {
+        if (size == 0) {
             return std::nullopt;
         }
 
@@ -103,219 +354,411 @@ namespace thumb {
             return std::nullopt;
         }
 
-        const auto modelHandle = loadModel_(tgi);
-        if (!modelHandle) {
-            spdlog::trace("Thumbnail renderer could not build model {}", tgi.ToString());
-            return std::nullopt;
+        const RenderKey key{tgi, size};
+        std::unique_lock lock(renderMutex_);
+        if (!prerender) {
+            ++renderCacheStats_.requests;
+        }
+        while (true) {
+            if (const auto it = renderCache_.find(key); it != renderCache_.end()) {
+                if (prerender) {
+                    return std::nullopt;
+                }
+                if (it->second.prerendered) {
+                    it->second.prerendered = false;
+                }
+                else {
+                    ++renderCacheStats_.hits;
+                }
+                // Report what the render depended on, as if it had been drawn again
+                DbpfIndexService::recordDependencies(it->second.dependencies);
+                if (it->second.image) {
+                    renderLru_.splice(renderLru_.begin(), renderLru_, it->second.lruPosition);
+                }
+                return it->second.image;
+            }
+            if (!rendersInFlight_.contains(key)) {
+                break;
+            }
+            if (prerender) {
+                return std::nullopt;
+            }
+            renderDone_.wait(lock);
+        }
+        rendersInFlight_.insert(key);
+        lock.unlock();
+
+        CachedRender cached;
+        cached.prerendered = prerender;
+        try {
+            DbpfIndexService::DependencyScope scope(cached.dependencies);
+            cached.image = renderUncached_(tgi, size);
+        }
+        catch (...) {
+            lock.lock();
+            rendersInFlight_.erase(key);
+            lock.unlock();
+            renderDone_.notify_all();
+            throw;
         }
 
-        const uint32_t renderSize = size * kSupersampleFactor;
-        const RenderTexture2D target = LoadRenderTexture(static_cast<int>(renderSize), static_cast<int>(renderSize));
-        if (target.id == 0) {
-            return std::nullopt;
+        auto result = cached.image;
+        lock.lock();
+        rendersInFlight_.erase(key);
+        ++renderCacheStats_.renders;
+        insertRender_(key, std::move(cached));
+        lock.unlock();
+        renderDone_.notify_all();
+        return result;
+    }
+
+    void ThumbnailRenderer::insertRender_(const RenderKey& key, CachedRender cached) {
+        if (renderCache_.contains(key)) {
+            return;
+        }
+        if (!cached.image) {
+            renderCache_.emplace(key, std::move(cached));
+            return;
+        }
+        const size_t bytes = cached.image->pixels.size();
+        if (bytes > renderCacheBytes_) {
+            return;
+        }
+        renderCachedBytes_ += bytes;
+        renderLru_.push_front(key);
+        cached.lruPosition = renderLru_.begin();
+        renderCache_.emplace(key, std::move(cached));
+        evictRenders_();
+    }
+
+    RenderCacheStats ThumbnailRenderer::renderCacheStats() const {
+        std::lock_guard lock(renderMutex_);
+        return renderCacheStats_;
+    }
+
+    TextureCacheStats ThumbnailRenderer::textureCacheStats() const {
+        return textureCache_->stats();
+    }
+
+    std::optional<RenderedImage> ThumbnailRenderer::renderUncached_(const DBPF::Tgi& tgi, const uint32_t size) {
+        const auto backend = this->backend();
+        std::optional<S3D::Record> model;
+        const auto contentKey = persistentKey_(tgi, size, model);
+        if (contentKey) {
+            if (std::optional<RenderedImage> image; findPersistent_(*contentKey, image)) {
+                return image;
+            }
         }
 
-        const BoundingBox bounds = GetModelBoundingBox(modelHandle->model);
-        const Vector3 sizeVec = Vector3Subtract(bounds.max, bounds.min);
+        if (backend == RenderBackend::Gpu && !ensureInitialized_()) {
+            spdlog::warn("Thumbnail renderer failed to initialize raylib, rendering on the CPU instead");
+            backend_.store(RenderBackend::Cpu, std::memory_order_release);
+            return renderUncached_(tgi, size);
+        }
 
-        const auto maxDim = std::max(std::max(sizeVec.x, sizeVec.y), sizeVec.z);
-        if (maxDim <= 0.001f) {
-            spdlog::warn("Thumbnail renderer: degenerate bounds for {} (maxDim={})", tgi.ToString(), maxDim);
-            UnloadRenderTexture(target);
+        bool renderFailed = false;
+        auto image = backend == RenderBackend::Gpu
+            ? drawModelGpu_(tgi, size, std::move(model), renderFailed)
+            : drawModelCpu_(tgi, size, std::move(model), renderFailed);
+        if (contentKey) {
+            storePersistent_(*contentKey, image, renderFailed);
+        }
+        return image;
+    }
+
+    std::optional<uint64_t> ThumbnailRenderer::persistentKey_(const DBPF::Tgi& tgi, const uint32_t size,
+                                                              std::optional<S3D::Record>& model) {
+        {
+            std::lock_guard lock(persistentCacheMutex_);
+            if (!persistentCache_ || !persistentCache_->isOpen()) {
+                return std::nullopt;
+            }
+        }
+        return contentKey_(tgi, size, model);
+    }
+
+    bool ThumbnailRenderer::findPersistent_(const uint64_t contentKey, std::optional<RenderedImage>& image) {
+        std::lock_guard lock(persistentCacheMutex_);
+        if (!persistentCache_) {
+            return false;
+        }
+        auto lookup = persistentCache_->find(contentKey);
+        if (lookup.found) {
+            image = std::move(lookup.image);
+        }
+        return lookup.found;
+    }
+
+    void ThumbnailRenderer::storePersistent_(const uint64_t contentKey, const std::optional<RenderedImage>& image,
+                                             const bool renderFailed) {
+        std::lock_guard lock(persistentCacheMutex_);
+        if (persistentCache_) {
+            persistentCache_->store(contentKey, image, renderFailed);
+        }
+    }
+
+    std::optional<uint64_t> ThumbnailRenderer::contentKey_(const DBPF::Tgi& tgi, const uint32_t size,
+                                                           std::optional<S3D::Record>& model) const {
+        const auto fileIndex = indexService_.winningFile(tgi);
+        if (!fileIndex) {
+            return std::nullopt;
+        }
+        const auto reader = indexService_.getReader(*fileIndex);
+        if (!reader) {
             return std::nullopt;
         }
-        const Vector3 center = Vector3Scale(Vector3Add(bounds.min, bounds.max), 0.5f);
-        const Vector3 framingTarget{
-            center.x,
-            bounds.min.y,
-            center.z
+        const auto modelBytes = reader->ReadEntryData(tgi);
+        if (!modelBytes) {
+            return std::nullopt;
+        }
+        auto record = reader->LoadS3D(tgi);
+        if (!record.has_value()) {
+            return std::nullopt;
+        }
+
+        ContentHash hash;
+        hash.add(kRendererVersion);
+        // Both backends draw the same framing, but not the same pixels
+        if (backend() == RenderBackend::Cpu) {
+            hash.add(kCpuBackendKeyTag);
+        }
+        hash.add(size);
+        hash.add(modelBytes->size());
+        hash.add(*modelBytes);
+
+        const auto addEntry = [&](const std::optional<std::vector<uint8_t>>& bytes) {
+            hash.add(bytes ? bytes->size() + 1 : 0);
+            if (bytes) {
+                hash.add(*bytes);
+            }
         };
 
-        Camera3D camera{};
-        camera.projection = CAMERA_ORTHOGRAPHIC;
+        // The texture loader looks in the model's own file first and then wherever the game loads the texture
+        // from, so both copies are part of the key
+        const auto addTexture = [&](const DBPF::Tgi& textureTgi) {
+            addEntry(reader->ReadEntryData(textureTgi));
+            const auto winner = indexService_.winningFile(textureTgi);
+            if (winner && *winner != *fileIndex) {
+                const auto winnerReader = indexService_.getReader(*winner);
+                addEntry(winnerReader ? winnerReader->ReadEntryData(textureTgi) : std::nullopt);
+            }
+            else {
+                addEntry(std::nullopt);
+            }
+        };
 
-        camera.fovy = static_cast<float>(size) / 2.0f;
-        camera.up = Vector3{0.0f, 1.0f, 0.0f};
-        camera.target = framingTarget;
+        for (const auto& material : record->materials) {
+            for (const auto& texture : material.textures) {
+                addTexture(DBPF::Tgi{kTypeIdFSH, tgi.group, texture.textureID});
+                addTexture(DBPF::Tgi{kTypeIdFSH, kFallbackTextureGroup, texture.textureID});
+            }
+        }
+        model = std::move(*record);
+        return hash.value();
+    }
 
-        const Vector3 dir{
-            std::cos(kSc4DefaultYawRadians) * std::cos(kSc4DefaultPitchRadians[kThumbnailZoomIndex]),
-            std::sin(kSc4DefaultPitchRadians[kThumbnailZoomIndex]),
-            std::sin(kSc4DefaultYawRadians) * std::cos(kSc4DefaultPitchRadians[kThumbnailZoomIndex])
-        };
+    std::optional<RenderedImage> ThumbnailRenderer::drawModelGpu_(const DBPF::Tgi& tgi, const uint32_t size,
+                                                                  std::optional<S3D::Record> model,
+                                                                  bool& renderFailed) {
+        GpuTile tile{.tgi = tgi, .model = std::move(model)};
+        drawGpuTiles_(std::span(&tile, 1), size);
+        renderFailed = tile.renderFailed;
+        return std::move(tile.image);
+    }
 
-        // Compute ortho size to tightly fit all corners after rotation
-        // We project all 8 corners of the bounding box onto the camera basis and
-        // compute both viewport extents and the depth needed to keep the camera
-        // in front of the closest geometry.
-        Vector3 forward = Vector3Normalize(Vector3Negate(dir));
-        Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
-        Vector3 camUp = Vector3Normalize(Vector3CrossProduct(right, forward));
-
-        auto minRight = std::numeric_limits<float>::max();
-        auto maxRight = std::numeric_limits<float>::lowest();
-        auto minUp = std::numeric_limits<float>::max();
-        auto maxUp = std::numeric_limits<float>::lowest();
-        auto minForward = std::numeric_limits<float>::max();
-        auto maxForward = std::numeric_limits<float>::lowest();
-        for (auto xi = 0; xi < 2; ++xi) {
-            for (auto yi = 0; yi < 2; ++yi) {
-                for (auto zi = 0; zi < 2; ++zi) {
-                    Vector3 corner{
-                        xi ? bounds.max.x : bounds.min.x,
-                        yi ? bounds.max.y : bounds.min.y,
-                        zi ? bounds.max.z : bounds.min.z
-                    };
-                    Vector3 toCorner = Vector3Subtract(corner, framingTarget);
-                    const float projRight = Vector3DotProduct(toCorner, right);
-                    const float projUp = Vector3DotProduct(toCorner, camUp);
-                    const float projForward = Vector3DotProduct(toCorner, forward);
-                    minRight = std::min(minRight, projRight);
-                    maxRight = std::max(maxRight, projRight);
-                    minUp = std::min(minUp, projUp);
-                    maxUp = std::max(maxUp, projUp);
-                    minForward = std::min(minForward, projForward);
-                    maxForward = std::max(maxForward, projForward);
-                }
+    void ThumbnailRenderer::drawGpuTiles_(const std::span<GpuTile> tiles, const uint32_t size) {
+        const uint32_t renderSize = size * kSupersampleFactor;
+        if (!atlas_) {
+            atlas_ = std::make_unique<GpuTileAtlas>();
+        }
+        if (!atlas_->prepare(renderSize)) {
+            spdlog::warn("Thumbnail renderer could not create a {} px render target", renderSize);
+            for (auto& tile : tiles) {
+                tile.renderFailed = true;
             }
+            return;
         }
 
-        const float leftBound = minRight * kHorizontalPadding;
-        const float rightBound = maxRight * kHorizontalPadding;
-        const float bottomBound = minUp * kBottomPadding;
-        const float topBound = maxUp * kTopPadding;
-
-        const float centerRight = (leftBound + rightBound) * 0.5f;
-        const float centerUp = (bottomBound + topBound) * 0.5f;
-
-        float orthoHalfSize = std::max({
-            std::abs(leftBound - centerRight),
-            std::abs(rightBound - centerRight),
-            std::abs(bottomBound - centerUp),
-            std::abs(topBound - centerUp)
-        });
-        if (orthoHalfSize <= 0.0f) {
-            orthoHalfSize = static_cast<float>(renderSize) / 2.0f;
-        }
-
-        const float nearMargin = std::max(maxDim * 0.25f, 4.0f);
-        const float maxDistance = std::max(nearMargin, 900.0f - std::max(0.0f, maxForward));
-        const float camDistance = std::clamp(-minForward + nearMargin, nearMargin, maxDistance);
-        const float targetOffsetX = centerRight;
-        const float targetOffsetY = centerUp;
-        const Vector3 cameraTarget = Vector3Add(
-            framingTarget,
-            Vector3Add(Vector3Scale(right, targetOffsetX), Vector3Scale(camUp, targetOffsetY)));
-        camera.target = cameraTarget;
-        camera.position = Vector3Add(cameraTarget, Vector3Scale(dir, camDistance));
-        camera.fovy = orthoHalfSize * 2.0f;
-
-        spdlog::trace(
-            "Thumbnail renderer camera for {}: maxDim={}, camDistance={}, orthoHalfSize={}, focusY={}, offset=({}, {}), depth=[{}, {}], sc4Camera[yaw={}, pitchZoom{}={}]",
-            tgi.ToString(), maxDim, camDistance, orthoHalfSize, framingTarget.y, targetOffsetX, targetOffsetY,
-            minForward, maxForward, kSc4DefaultYawRadians, kThumbnailZoomIndex + 1,
-            kSc4DefaultPitchRadians[kThumbnailZoomIndex]);
-
-        BeginTextureMode(target);
-        ClearBackground(BLANK);
-        BeginMode3D(camera);
-        rlDisableBackfaceCulling();
-        DrawModelEx(modelHandle->model, Vector3Zero(), Vector3{0, 1, 0}, 0.0f,
-                    Vector3One(), WHITE);
-        rlEnableBackfaceCulling();
-        EndMode3D();
-        EndTextureMode();
-
-        Image image = LoadImageFromTexture(target.texture);
-        ImageFlipVertical(&image);
-        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
-
-        Image finalImage{};
-        if (kEnableSilhouettePostFit) {
-            std::optional<AlphaBounds> visibleBounds = FindVisibleAlphaBounds(image, kAlphaFitThreshold);
-            if (!visibleBounds.has_value()) {
-                UnloadImage(image);
-                UnloadRenderTexture(target);
-                modelCache_.erase(tgi);
-                return std::nullopt;
+        struct Pass {
+            GpuTileAtlas::Readback readback;
+            std::vector<GpuTile*> tiles;
+        };
+        const auto finishPass = [&](const Pass& pass) {
+            const uint8_t* pixels = atlas_->pixels(pass.readback);
+            if (!pixels) {
+                spdlog::warn("Thumbnail renderer could not read back {} rendered tiles", pass.tiles.size());
+            }
+            for (uint32_t i = 0; i < pass.tiles.size(); ++i) {
+                Image image = atlas_->tileImage(pixels, pass.readback, i);
+                if (image.data) {
+                    pass.tiles[i]->image = FitThumbnail(image, size, renderSize);
+                    UnloadImage(image);
+                }
+                else {
+                    // The model was drawn; only reading it back failed
+                    pass.tiles[i]->renderFailed = true;
+                }
             }
+            atlas_->release(pass.readback);
+        };
 
-            const int visibleWidth = visibleBounds->maxX - visibleBounds->minX + 1;
-            const int visibleHeight = visibleBounds->maxY - visibleBounds->minY + 1;
-            const int margin = std::max(1, static_cast<int>(std::ceil(std::max(visibleWidth, visibleHeight) * kPostFitMarginRatio)));
-            Rectangle cropRect{
-                static_cast<float>(std::max(0, visibleBounds->minX - margin)),
-                static_cast<float>(std::max(0, visibleBounds->minY - margin)),
-                static_cast<float>(std::min(static_cast<int>(renderSize), visibleBounds->maxX + margin + 1) -
-                                   std::max(0, visibleBounds->minX - margin)),
-                static_cast<float>(std::min(static_cast<int>(renderSize), visibleBounds->maxY + margin + 1) -
-                                   std::max(0, visibleBounds->minY - margin))
-            };
+        // Each pass fills the atlas and queues its readback, then crops the tiles of the previous pass
+        // while the GPU is still busy with this one
+        std::optional<Pass> previous;
+        size_t next = 0;
+        while (next < tiles.size()) {
+            Pass pass;
+            atlas_->beginPass();
+            while (next < tiles.size() && pass.tiles.size() < atlas_->capacity()) {
+                auto& tile = tiles[next++];
+                DbpfIndexService::DependencyScope scope(tile.dependencies);
+                const auto modelHandle = loadModel_(tile.tgi, std::move(tile.model));
+                tile.model.reset();
+                if (!modelHandle) {
+                    spdlog::trace("Thumbnail renderer could not build model {}", tile.tgi.ToString());
+                    continue;
+                }
 
-            Image cropped = ImageFromImage(image, cropRect);
-            if (cropped.data == nullptr) {
-                UnloadImage(image);
-                UnloadRenderTexture(target);
-                modelCache_.erase(tgi);
-                return std::nullopt;
-            }
+                const auto camera = FrameModel(GetModelBoundingBox(modelHandle->model), size, renderSize, tile.tgi);
+                if (camera) {
+                    atlas_->beginTile(static_cast<uint32_t>(pass.tiles.size()));
+                    BeginMode3D(*camera);
+                    rlDisableBackfaceCulling();
+                    DrawModelEx(modelHandle->model, Vector3Zero(), Vector3{0, 1, 0}, 0.0f,
+                                Vector3One(), WHITE);
+                    rlEnableBackfaceCulling();
+                    EndMode3D();
+                    pass.tiles.push_back(&tile);
+                }
 
-            const float fitScale = std::min(
-                static_cast<float>(size) / static_cast<float>(cropped.width),
-                static_cast<float>(size) / static_cast<float>(cropped.height));
-            const int fittedWidth = std::max(1, static_cast<int>(std::round(cropped.width * fitScale)));
-            const int fittedHeight = std::max(1, static_cast<int>(std::round(cropped.height * fitScale)));
+                // Evict the model from cache to free GPU resources (textures, meshes) as soon as its
+                // draw is submitted. In the cache builder each model is only rendered once, so keeping
+                // them around just accumulates VRAM until the process runs out of memory.
+                modelCache_.erase(tile.tgi);
+            }
+            atlas_->endPass();
+            if (pass.tiles.empty()) {
+                continue;
+            }
 
-            ImageResize(&cropped, fittedWidth, fittedHeight);
-            ImageFormat(&cropped, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            pass.readback = atlas_->readback(static_cast<uint32_t>(pass.tiles.size()));
+            if (previous) {
+                finishPass(*previous);
+            }
+            previous = std::move(pass);
+        }
+        if (previous) {
+            finishPass(*previous);
+        }
+    }
 
-            finalImage = GenImageColor(static_cast<int>(size), static_cast<int>(size), BLANK);
-            const Rectangle srcRect{
-                0.0f,
-                0.0f,
-                static_cast<float>(cropped.width),
-                static_cast<float>(cropped.height)
-            };
-            const Rectangle dstRect{
-                std::floor((static_cast<float>(size) - cropped.width) * 0.5f),
-                std::floor((static_cast<float>(size) - cropped.height) * 0.5f),
-                static_cast<float>(cropped.width),
-                static_cast<float>(cropped.height)
-            };
-            ImageDraw(&finalImage, cropped, srcRect, dstRect, WHITE);
-            UnloadImage(cropped);
+    std::optional<RenderedImage> ThumbnailRenderer::drawModelCpu_(const DBPF::Tgi& tgi, const uint32_t size,
+                                                                  std::optional<S3D::Record> model,
+                                                                  bool& renderFailed) const {
+        const auto fileIndex = indexService_.winningFile(tgi);
+        if (!fileIndex) {
+            return std::nullopt;
         }
-        else {
-            finalImage = ImageCopy(image);
-            ImageResize(&finalImage, static_cast<int>(size), static_cast<int>(size));
-            ImageFormat(&finalImage, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        const auto reader = indexService_.getReader(*fileIndex);
+        if (!reader) {
+            return std::nullopt;
+        }
+        if (!model) {
+            auto loaded = reader->LoadS3D(tgi);
+            if (!loaded.has_value()) {
+                return std::nullopt;
+            }
+            model = std::move(*loaded);
         }
+        const auto& record = model;
 
-        RenderedImage rendered;
-        rendered.width = size;
-        rendered.height = size;
-        rendered.pixels.resize(size * size * 4);
-        if (finalImage.data) {
-            std::memcpy(rendered.pixels.data(), finalImage.data, rendered.pixels.size());
-            for (size_t i = 0; i + 3 < rendered.pixels.size(); i += 4) {
-                std::byte tmp = rendered.pixels[i];
-                rendered.pixels[i] = rendered.pixels[i + 2];
-                rendered.pixels[i + 2] = tmp;
+        // Same geometry and texture choice as ModelFactory builds for the GPU, without uploading anything
+        const auto meshSources = MeshBuilder::collectMeshSources(*record);
+        if (meshSources.empty()) {
+            spdlog::trace("Thumbnail renderer could not build model {}", tgi.ToString());
+            return std::nullopt;
+        }
+        const Vector3 center = MeshBuilder::calculateModelCenter(*record);
+        const float yLift = center.y - record->bbMin.y;
+
+        std::vector<MeshVertices> meshes(meshSources.size());
+        std::vector<std::optional<SoftwareTexture>> textures(meshSources.size());
+        BoundingBox bounds{
+            Vector3{std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                    std::numeric_limits<float>::max()},
+            Vector3{std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest(),
+                    std::numeric_limits<float>::lowest()}
+        };
+        for (size_t i = 0; i < meshSources.size(); ++i) {
+            if (!MeshBuilder::buildVertices(meshSources[i], center, yLift, meshes[i])) {
+                spdlog::trace("Thumbnail renderer could not build model {}", tgi.ToString());
+                return std::nullopt;
+            }
+            for (const auto& position : meshes[i].positions) {
+                bounds.min = Vector3Min(bounds.min, position);
+                bounds.max = Vector3Max(bounds.max, position);
+            }
+
+            const auto* material = meshSources[i].material;
+            if (!material) {
+                continue;
+            }
+            for (const auto& texInfo : material->textures) {
+                const TextureCache::Key key{.fileIndex = *fileIndex, .group = tgi.group, .instance = texInfo.textureID};
+                auto image = textureCache_->get(key, [&] {
+                    return TextureLoader::loadImageForMaterial(*reader,
+                                                               tgi,
+                                                               texInfo.textureID,
+                                                               false,
+                                                               false,
+                                                               [this](uint32_t inst, uint32_t group) {
+                                                                   return loadTexture_(inst, group);
+                                                               });
+                });
+                if (image) {
+                    textures[i] = SoftwareTexture{
+                        .image = std::move(image),
+                        .clamp = texInfo.wrapS == 1 || texInfo.wrapT == 1,
+                        .bilinear = texInfo.minFilter > 0,
+                    };
+                    break;
+                }
+                spdlog::warn("Could not load texture for material {}", texInfo.textureID);
             }
         }
 
-        UnloadImage(finalImage);
-        UnloadImage(image);
-        UnloadRenderTexture(target);
+        const uint32_t renderSize = size * kSupersampleFactor;
+        const auto camera = FrameModel(bounds, size, renderSize, tgi);
+        if (!camera) {
+            return std::nullopt;
+        }
 
-        // Evict the model from cache to free GPU resources (textures, meshes).
-        // In the cache builder each model is only rendered once, so keeping them
-        // around just accumulates VRAM until the process runs out of memory.
-        modelCache_.erase(tgi);
+        SoftwareRasterizer rasterizer(static_cast<int>(renderSize), static_cast<int>(renderSize));
+        rasterizer.setCamera(*camera);
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            rasterizer.drawMesh(meshes[i], textures[i] ? &*textures[i] : nullptr);
+        }
 
+        Image image = rasterizer.toImage();
+        if (!image.data) {
+            renderFailed = true;
+            return std::nullopt;
+        }
+        auto rendered = FitThumbnail(image, size, renderSize);
+        UnloadImage(image);
         return rendered;
     }
 
+    void ThumbnailRenderer::evictRenders_() {
+        while (renderCachedBytes_ > renderCacheBytes_ && !renderLru_.empty()) {
+            const auto it = renderCache_.find(renderLru_.back());
+            renderCachedBytes_ -= it->second.image->pixels.size();
+            renderCache_.erase(it);
+            renderLru_.pop_back();
+            ++renderCacheStats_.evictions;
+        }
+    }
+
     bool ThumbnailRenderer::ensureInitialized_() {
         if (initialized_) {
             return true;
@@ -328,69 +771,81 @@ namespace thumb {
         return initialized_;
     }
 
-    std::shared_ptr<LoadedModelHandle> ThumbnailRenderer::loadModel_(const DBPF::Tgi& tgi) {
+    std::shared_ptr<LoadedModelHandle> ThumbnailRenderer::loadModel_(const DBPF::Tgi& tgi,
+                                                                     std::optional<S3D::Record> model) {
         if (auto it = modelCache_.find(tgi); it != modelCache_.end()) {
             return it->second;
         }
-        if (failedModels_.contains(tgi)) {
+        if (auto it = failedModels_.find(tgi); it != failedModels_.end()) {
+            // Report what the failed attempt depended on, as if it had been retried
+            DbpfIndexService::recordDependencies(it->second);
             return nullptr;
         }
 
-        auto filePaths = indexService_.lookupFiles(tgi);
-        if (filePaths.empty()) {
-            failedModels_.insert(tgi);
-            return nullptr;
+        std::vector<DBPF::Tgi> dependencies;
+        std::shared_ptr<LoadedModelHandle> handle;
+        {
+            DbpfIndexService::DependencyScope scope(dependencies);
+            handle = buildModel_(tgi, std::move(model));
+        }
+        if (!handle) {
+            failedModels_.emplace(tgi, std::move(dependencies));
         }
+        return handle;
+    }
 
-        for (const auto& path : filePaths) {
-            DBPF::Reader* reader = indexService_.getReader(path);
-            if (!reader) {
-                continue;
-            }
+    std::shared_ptr<LoadedModelHandle> ThumbnailRenderer::buildModel_(const DBPF::Tgi& tgi,
+                                                                      std::optional<S3D::Record> model) {
+        const auto fileIndex = indexService_.winningFile(tgi);
+        if (!fileIndex) {
+            return nullptr;
+        }
 
-            auto record = reader->LoadS3D(tgi);
-            if (!record.has_value()) {
-                continue;
-            }
+        const auto reader = indexService_.getReader(*fileIndex);
+        if (!reader) {
+            return nullptr;
+        }
 
-            auto model = modelFactory_->build(*record,
-                                              tgi,
-                                              *reader,
-                                              false,
-                                              false,
-                                              false,
-                                              0.0f,
-                                              [this](uint32_t inst, uint32_t group) {
-                                                  return loadTexture_(inst, group);
-                                              });
-            if (model) {
-                modelCache_[tgi] = model;
-                return model;
+        if (!model) {
+            auto loaded = reader->LoadS3D(tgi);
+            if (!loaded.has_value()) {
+                return nullptr;
             }
+            model = std::move(*loaded);
         }
 
-        failedModels_.insert(tgi);
-        return nullptr;
+        auto handle = modelFactory_->build(*model,
+                                           tgi,
+                                           *reader,
+                                           false,
+                                           false,
+                                           false,
+                                           0.0f,
+                                           [this](uint32_t inst, uint32_t group) {
+                                               return loadTexture_(inst, group);
+                                           },
+                                           *fileIndex);
+        if (handle) {
+            modelCache_[tgi] = handle;
+        }
+        return handle;
     }
 
     std::optional<FSH::Record> ThumbnailRenderer::loadTexture_(uint32_t inst, uint32_t group) const {
         DBPF::Tgi tgi{kTypeIdFSH, group, inst};
-        auto filePaths = indexService_.lookupFiles(tgi);
-        if (filePaths.empty()) {
+        const auto fileIndex = indexService_.winningFile(tgi);
+        if (!fileIndex) {
             return std::nullopt;
         }
 
-        for (const auto& path : filePaths) {
-            const DBPF::Reader* reader = indexService_.getReader(path);
-            if (!reader) {
-                continue;
-            }
-            auto record = reader->LoadFSH(tgi);
-            if (record.has_value()) {
-                return *record;
-            }
+        const auto reader = indexService_.getReader(*fileIndex);
+        if (!reader) {
+            return std::nullopt;
+        }
+        auto record = reader->LoadFSH(tgi);
+        if (record.has_value()) {
+            return *record;
         }
-
         return std::nullopt;
     }
 } // namespace thumb
@@ -1,7 +1,14 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -11,7 +18,10 @@
 
 namespace thumb {
     struct LoadedModelHandle;
+    class GpuTileAtlas;
     class ModelFactory;
+    class RenderCache;
+    class TextureCache;
 
     struct RenderedImage {
         std::vector<std::byte> pixels;
@@ -19,22 +29,141 @@ namespace thumb {
         uint32_t height = 0;
     };
 
+    struct RenderCacheStats {
+        uint64_t requests = 0;  // renderModel calls for S3D models
+        uint64_t renders = 0;   // Requests that drew the model
+        uint64_t hits = 0;      // Requests answered by the render cache, failed renders included
+        uint64_t evictions = 0; // Rendered images dropped to stay within the byte budget
+    };
+
+    struct TextureCacheStats {
+        uint64_t requests = 0;  // Material textures looked up
+        uint64_t hits = 0;      // Requests answered without decoding, failed decodes included
+        uint64_t evictions = 0; // Decoded textures dropped to stay within the byte budget
+    };
+
+    // Rendered images kept for models shared by several exemplars
+    constexpr size_t kDefaultRenderCacheBytes = 64ull * 1024 * 1024;
+    // Decoded textures kept for models that share them
+    constexpr size_t kDefaultTextureCacheBytes = 64ull * 1024 * 1024;
+
+    enum class RenderBackend : uint8_t {
+        Gpu, // raylib in a hidden window; one thread only. Falls back to Cpu when no window can be opened.
+        Cpu, // Software rasterizer; any number of threads, one model each, no window or GPU needed
+    };
+
     class ThumbnailRenderer {
     public:
-        explicit ThumbnailRenderer(const DbpfIndexService& indexService);
+        explicit ThumbnailRenderer(const DbpfIndexService& indexService,
+                                   RenderBackend backend = RenderBackend::Gpu,
+                                   size_t renderCacheBytes = kDefaultRenderCacheBytes);
         ~ThumbnailRenderer();
 
+        // Renders each (model, size) once; later requests get a copy of the cached result. Failed
+        // renders are remembered too, successful ones are evicted least recently used first.
+        // Callers asking for a model that is being rendered on another thread wait for that render.
         std::optional<RenderedImage> renderModel(const DBPF::Tgi& tgi, uint32_t size);
+        // Renders into the cache for a renderModel call that follows later, typically from another
+        // thread. The later call counts as the request; it is not reported as a cache hit.
+        void prerenderModel(const DBPF::Tgi& tgi, uint32_t size);
+        // Prerenders many models at once. The GPU backend draws them side by side into one render target
+        // and reads each pass back asynchronously, instead of one target and one blocking readback per
+        // model; the CPU backend just renders them one after the other.
+        void prerenderModels(std::span<const DBPF::Tgi> tgis, uint32_t size);
+
+        [[nodiscard]] RenderBackend backend() const { return backend_.load(std::memory_order_acquire); }
+        // True when renderModel may be called from several threads at once
+        [[nodiscard]] bool rendersConcurrently() const { return backend() == RenderBackend::Cpu; }
+
+        [[nodiscard]] RenderCacheStats renderCacheStats() const;
+        [[nodiscard]] TextureCacheStats textureCacheStats() const;
+
+        // Renders missing from the in-memory cache are looked up in, and added to, this persistent cache.
+        // Null disables it.
+        void setPersistentCache(RenderCache* cache) { persistentCache_ = cache; }
 
     private:
+        struct RenderKey {
+            DBPF::Tgi tgi;
+            uint32_t size = 0;
+
+            bool operator==(const RenderKey&) const = default;
+        };
+
+        struct RenderKeyHash {
+            size_t operator()(const RenderKey& key) const noexcept {
+                return DBPF::TgiHash{}(key.tgi) ^ (static_cast<size_t>(key.size) * 0x9E3779B97F4A7C15ull);
+            }
+        };
+
+        struct CachedRender {
+            std::optional<RenderedImage> image;
+            // Entries the render looked up, replayed on every hit
+            std::vector<DBPF::Tgi> dependencies;
+            // Position in renderLru_; only set when image holds pixels
+            std::list<RenderKey>::iterator lruPosition;
+            // Drawn by prerenderModel and not requested since
+            bool prerendered = false;
+        };
+
+        struct GpuTile {
+            DBPF::Tgi tgi;
+            // Decoded while building the content key, so the draw does not decode it again
+            std::optional<S3D::Record> model;
+            std::optional<RenderedImage> image;
+            std::vector<DBPF::Tgi> dependencies;
+            // No image because the renderer failed, not the model; such results are not persisted
+            bool renderFailed = false;
+        };
+
+        std::optional<RenderedImage> render_(const DBPF::Tgi& tgi, uint32_t size, bool prerender);
+        // Adds a finished render to the cache; renderMutex_ must be held
+        void insertRender_(const RenderKey& key, CachedRender cached);
+        std::optional<RenderedImage> renderUncached_(const DBPF::Tgi& tgi, uint32_t size);
+        // Content key of a render when a persistent cache is open, with the model decoded for it
+        [[nodiscard]] std::optional<uint64_t> persistentKey_(const DBPF::Tgi& tgi, uint32_t size,
+                                                             std::optional<S3D::Record>& model);
+        // True on a hit; image is left as cached, nullopt for a cached failure
+        bool findPersistent_(uint64_t contentKey, std::optional<RenderedImage>& image);
+        void storePersistent_(uint64_t contentKey, const std::optional<RenderedImage>& image, bool renderFailed);
+        // The draw functions set renderFailed when they return nullopt because of the renderer, not the model.
+        // They decode the model themselves unless it is passed in.
+        std::optional<RenderedImage> drawModelGpu_(const DBPF::Tgi& tgi, uint32_t size,
+                                                   std::optional<S3D::Record> model, bool& renderFailed);
+        // Draws tiles in atlas passes; a tile whose model could not be drawn keeps no image
+        void drawGpuTiles_(std::span<GpuTile> tiles, uint32_t size);
+        std::optional<RenderedImage> drawModelCpu_(const DBPF::Tgi& tgi, uint32_t size,
+                                                   std::optional<S3D::Record> model, bool& renderFailed) const;
+        // Hash of everything a render of tgi at size is drawn from; nullopt if the model is missing. Leaves
+        // the model it decoded to list the textures in model.
+        [[nodiscard]] std::optional<uint64_t> contentKey_(const DBPF::Tgi& tgi, uint32_t size,
+                                                          std::optional<S3D::Record>& model) const;
+        void evictRenders_();
         bool ensureInitialized_();
-        std::shared_ptr<LoadedModelHandle> loadModel_(const DBPF::Tgi& tgi);
+        std::shared_ptr<LoadedModelHandle> loadModel_(const DBPF::Tgi& tgi, std::optional<S3D::Record> model);
+        std::shared_ptr<LoadedModelHandle> buildModel_(const DBPF::Tgi& tgi, std::optional<S3D::Record> model);
         std::optional<FSH::Record> loadTexture_(uint32_t inst, uint32_t group) const;
 
         const DbpfIndexService& indexService_;
+        std::atomic<RenderBackend> backend_;
+        // Shared by every model built on either backend
+        std::unique_ptr<TextureCache> textureCache_;
         std::shared_ptr<ModelFactory> modelFactory_;
         std::unordered_map<DBPF::Tgi, std::shared_ptr<LoadedModelHandle>, DBPF::TgiHash> modelCache_;
-        std::unordered_set<DBPF::Tgi, DBPF::TgiHash> failedModels_;
+        // Models that failed to load, with the entries the attempt looked up
+        std::unordered_map<DBPF::Tgi, std::vector<DBPF::Tgi>, DBPF::TgiHash> failedModels_;
+        // Guards the render cache, its stats and rendersInFlight_
+        mutable std::mutex renderMutex_;
+        std::condition_variable renderDone_;
+        std::unordered_set<RenderKey, RenderKeyHash> rendersInFlight_;
+        std::unordered_map<RenderKey, CachedRender, RenderKeyHash> renderCache_;
+        std::list<RenderKey> renderLru_; // Most recently used first
+        size_t renderCacheBytes_;
+        size_t renderCachedBytes_ = 0;
+        RenderCacheStats renderCacheStats_;
+        std::mutex persistentCacheMutex_;
+        RenderCache* persistentCache_ = nullptr;
+        std::unique_ptr<GpuTileAtlas> atlas_;
         bool initialized_ = false;
     };
 } // namespace thumb
@@ -23,31 +23,27 @@ namespace {
     }
 }
 
-size_t SanitizeStrings(std::vector<Building>& allBuildings, std::vector<Prop>& allProps) {
+size_t SanitizeStrings(Building& building) {
+    const auto groupId = building.groupId.value();
+    const auto instanceId = building.instanceId.value();
     size_t sanitizedFields = 0;
-    const auto sanitizeAndCount = [&](std::string& value, std::string_view fieldName, auto&&... ids) {
-        sanitizedFields += static_cast<size_t>(SanitizeField(value, fieldName, ids...));
-    };
+    sanitizedFields += static_cast<size_t>(SanitizeField(building.name, "building.name", groupId, instanceId));
+    sanitizedFields += static_cast<size_t>(
+        SanitizeField(building.description, "building.description", groupId, instanceId));
 
-    for (auto& building : allBuildings) {
-        sanitizeAndCount(building.name, "building.name", building.groupId.value(), building.instanceId.value());
-        sanitizeAndCount(building.description, "building.description", building.groupId.value(),
-                         building.instanceId.value());
-
-        for (auto& lot : building.lots) {
-            sanitizeAndCount(lot.name, "lot.name", lot.groupId.value(), lot.instanceId.value());
-        }
-    }
-
-    for (auto& prop : allProps) {
-        sanitizeAndCount(prop.exemplarName, "prop.exemplarName", prop.groupId.value(), prop.instanceId.value());
-        sanitizeAndCount(prop.visibleName, "prop.visibleName", prop.groupId.value(), prop.instanceId.value());
-    }
-
-    if (sanitizedFields > 0) {
-        spdlog::warn("Sanitized {} invalid UTF-8 fields before writing output", sanitizedFields);
+    for (auto& lot : building.lots) {
+        sanitizedFields += static_cast<size_t>(
+            SanitizeField(lot.name, "lot.name", lot.groupId.value(), lot.instanceId.value()));
     }
+    return sanitizedFields;
+}
 
+size_t SanitizeStrings(Prop& prop) {
+    const auto groupId = prop.groupId.value();
+    const auto instanceId = prop.instanceId.value();
+    size_t sanitizedFields = 0;
+    sanitizedFields += static_cast<size_t>(SanitizeField(prop.exemplarName, "prop.exemplarName", groupId, instanceId));
+    sanitizedFields += static_cast<size_t>(SanitizeField(prop.visibleName, "prop.visibleName", groupId, instanceId));
     return sanitizedFields;
 }
 
@@ -4,5 +4,7 @@
 #include <spdlog/logger.h>
 #include "../shared/entities.hpp"
 
-size_t SanitizeStrings(std::vector<Building>& allBuildings, std::vector<Prop>& allProps);
+// Replace invalid UTF-8 in the names of a record before it is written; return the number of fields fixed
+size_t SanitizeStrings(Building& building);
+size_t SanitizeStrings(Prop& prop);
 std::string SanitizeString(const std::string_view text);
\ No newline at end of file
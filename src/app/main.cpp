@@ -1,13 +1,21 @@
 #include <args.hxx>
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstring>
 #include <exception>
 #include <filesystem>
+#include <format>
 #include <iostream>
+#include <map>
+#include <mutex>
 #include <optional>
+#include <ranges>
 #include <set>
+#include <span>
 #include <string_view>
 #include <thread>
 #include <unordered_map>
@@ -19,14 +27,22 @@
 
 #include <fstream>
 
+#include "../shared/catalog_writer.hpp"
 #include "../shared/entities.hpp"
 #include "../shared/index.hpp"
 #include "DBPFReader.h"
 #include "DbpfIndexService.hpp"
 #include "ExemplarParser.hpp"
 #include "BuiltinPropFamilyNames.hpp"
+#include "ParseCache.hpp"
+#include "PixelKernels.hpp"
+#include "PluginIndexStore.hpp"
 #include "PluginLocator.hpp"
+#include "PluginWatcher.hpp"
 #include "PropertyMapper.hpp"
+#include "RenderCache.hpp"
+#include "ScanMetrics.hpp"
+#include "ThumbnailRenderer.hpp"
 #include "Utils.hpp"
 
 #include <rfl/cbor.hpp>
@@ -45,6 +61,9 @@ namespace {
     constexpr uint32_t kTypeIdCohort = 0x05342861u;
     constexpr uint32_t kMinThumbnailSize = kDefaultThumbnailSize / 2;
     constexpr uint32_t kMaxThumbnailSize = kDefaultThumbnailSize * 4;
+    // --watch rescans once no plugin changed for kWatchDebounce, so a bulk copy triggers one rebuild
+    constexpr auto kWatchDebounce = std::chrono::seconds(2);
+    constexpr auto kWatchPollInterval = std::chrono::seconds(2);
 
     const char* GetFirstEnvironmentValue(std::initializer_list<const char*> names) {
         for (const char* name : names) {
@@ -55,93 +74,41 @@ namespace {
         return nullptr;
     }
 
-    struct RgbaImage {
-        std::vector<std::byte> pixels;
-        uint32_t width = 0;
-        uint32_t height = 0;
-    };
-
-    RgbaImage ResizeRgbaImage(const RgbaImage& source, const uint32_t targetWidth, const uint32_t targetHeight) {
-        if (source.width == 0 || source.height == 0 || source.pixels.empty() || targetWidth == 0 || targetHeight == 0) {
-            return {};
-        }
-
-        if (source.width == targetWidth && source.height == targetHeight) {
-            return source;
-        }
-
-        RgbaImage resized;
-        resized.width = targetWidth;
-        resized.height = targetHeight;
-        resized.pixels.resize(static_cast<size_t>(targetWidth) * targetHeight * 4);
-
-        const float scaleX = static_cast<float>(source.width) / static_cast<float>(targetWidth);
-        const float scaleY = static_cast<float>(source.height) / static_cast<float>(targetHeight);
-
-        for (uint32_t y = 0; y < targetHeight; ++y) {
-            const uint32_t srcY = std::min(static_cast<uint32_t>(y * scaleY), source.height - 1);
-            for (uint32_t x = 0; x < targetWidth; ++x) {
-                const uint32_t srcX = std::min(static_cast<uint32_t>(x * scaleX), source.width - 1);
-                const size_t srcIndex = (static_cast<size_t>(srcY) * source.width + srcX) * 4;
-                const size_t dstIndex = (static_cast<size_t>(y) * targetWidth + x) * 4;
-                for (size_t c = 0; c < 4; ++c) {
-                    resized.pixels[dstIndex + c] = source.pixels[srcIndex + c];
-                }
-            }
-        }
-
-        return resized;
-    }
-
+    // Scales a thumbnail to fit targetSize, keeping its aspect ratio, and centres it on a transparent
+    // square. Icons are scaled up to fill it as well; renders are only ever scaled down. The source is
+    // resampled straight into the square, without intermediate images.
     Thumbnail NormalizeThumbnailToSquare(const Thumbnail& thumbnail, const uint32_t targetSize) {
         return rfl::visit(
             [targetSize](const auto& variant) -> Thumbnail {
                 using Variant = std::decay_t<decltype(variant)>;
 
-                RgbaImage source;
-                source.width = variant.width;
-                source.height = variant.height;
-                source.pixels.resize(variant.data.size());
-                std::memcpy(source.pixels.data(), variant.data.data(), variant.data.size());
-
-                if (source.width == 0 || source.height == 0) {
-                    Variant normalized;
-                    normalized.width = targetSize;
-                    normalized.height = targetSize;
-                    normalized.data = rfl::Bytestring(std::vector<std::byte>(static_cast<size_t>(targetSize) * targetSize * 4));
-                    return Thumbnail{std::move(normalized)};
-                }
-
-                RgbaImage content = source;
-                if constexpr (std::is_same_v<Variant, Icon>) {
-                    if (source.width != targetSize || source.height != targetSize) {
-                        const float scale = std::min(
-                            static_cast<float>(targetSize) / static_cast<float>(source.width),
-                            static_cast<float>(targetSize) / static_cast<float>(source.height));
-                        const uint32_t scaledWidth = std::max(1u, static_cast<uint32_t>(source.width * scale));
-                        const uint32_t scaledHeight = std::max(1u, static_cast<uint32_t>(source.height * scale));
-                        content = ResizeRgbaImage(source, scaledWidth, scaledHeight);
-                    }
-                }
-                else if (source.width > targetSize || source.height > targetSize) {
-                    const float scale = std::min(
-                        static_cast<float>(targetSize) / static_cast<float>(source.width),
-                        static_cast<float>(targetSize) / static_cast<float>(source.height));
-                    const uint32_t scaledWidth = std::max(1u, static_cast<uint32_t>(source.width * scale));
-                    const uint32_t scaledHeight = std::max(1u, static_cast<uint32_t>(source.height * scale));
-                    content = ResizeRgbaImage(source, scaledWidth, scaledHeight);
-                }
-
                 std::vector<std::byte> squarePixels(static_cast<size_t>(targetSize) * targetSize * 4, std::byte{0});
-                const uint32_t offsetX = (targetSize - content.width) / 2;
-                const uint32_t offsetY = (targetSize - content.height) / 2;
+                const uint32_t sourceWidth = variant.width;
+                const uint32_t sourceHeight = variant.height;
+                const bool valid = sourceWidth != 0 && sourceHeight != 0
+                    && variant.data.size() >= static_cast<size_t>(sourceWidth) * sourceHeight * 4;
+
+                if (valid) {
+                    uint32_t contentWidth = sourceWidth;
+                    uint32_t contentHeight = sourceHeight;
+                    const bool scale = std::is_same_v<Variant, Icon>
+                        ? sourceWidth != targetSize || sourceHeight != targetSize
+                        : sourceWidth > targetSize || sourceHeight > targetSize;
+                    if (scale) {
+                        const float factor = std::min(
+                            static_cast<float>(targetSize) / static_cast<float>(sourceWidth),
+                            static_cast<float>(targetSize) / static_cast<float>(sourceHeight));
+                        contentWidth = std::clamp(static_cast<uint32_t>(sourceWidth * factor), 1u, targetSize);
+                        contentHeight = std::clamp(static_cast<uint32_t>(sourceHeight * factor), 1u, targetSize);
+                    }
 
-                for (uint32_t y = 0; y < content.height; ++y) {
-                    const size_t srcOffset = static_cast<size_t>(y) * content.width * 4;
-                    const size_t dstOffset =
-                        (static_cast<size_t>(y + offsetY) * targetSize + offsetX) * 4;
-                    std::memcpy(squarePixels.data() + dstOffset, content.pixels.data() + srcOffset,
-                                static_cast<size_t>(content.width) * 4);
+                    const uint32_t offsetX = (targetSize - contentWidth) / 2;
+                    const uint32_t offsetY = (targetSize - contentHeight) / 2;
+                    const size_t stride = static_cast<size_t>(targetSize) * 4;
+                    thumb::PixelKernels::resizeArea(
+                        reinterpret_cast<const uint8_t*>(variant.data.data()), sourceWidth, sourceHeight,
+                        reinterpret_cast<uint8_t*>(squarePixels.data()) + offsetY * stride + offsetX * 4,
+                        contentWidth, contentHeight, stride);
                 }
 
                 Variant normalized;
@@ -153,10 +120,29 @@ namespace {
             thumbnail);
     }
 
-    void NormalizeThumbnailEntries(std::vector<std::pair<uint64_t, Thumbnail>>& entries, const uint32_t targetSize) {
-        for (auto& [_, thumbnail] : entries) {
-            thumbnail = NormalizeThumbnailToSquare(thumbnail, targetSize);
+    // Thumbnail waiting to be normalised and spooled
+    struct PendingThumbnail {
+        ThumbnailBin::Spool* spool;
+        uint64_t key;
+        Thumbnail thumbnail;
+    };
+
+    // Normalises a batch of thumbnails on up to threadCount threads, each taking the next one in turn
+    void NormalizeThumbnails(std::vector<PendingThumbnail>& thumbnails, const uint32_t targetSize,
+                             const size_t threadCount, ScanMetrics* metrics) {
+        std::atomic<size_t> next{0};
+        const auto normalize = [&] {
+            ScanMetrics::Timer timer(metrics, ScanPhase::Normalisation);
+            for (size_t i = next.fetch_add(1); i < thumbnails.size(); i = next.fetch_add(1)) {
+                thumbnails[i].thumbnail = NormalizeThumbnailToSquare(thumbnails[i].thumbnail, targetSize);
+            }
+        };
+
+        std::vector<std::jthread> helpers;
+        for (size_t i = 1; i < std::min(threadCount, thumbnails.size()); ++i) {
+            helpers.emplace_back(normalize);
         }
+        normalize();
     }
 
     PluginConfiguration GetDefaultPluginConfiguration() {
@@ -196,10 +182,526 @@ namespace {
         return begin == fs::directory_iterator();
     }
 
+    struct ScanOptions {
+        bool renderModelThumbnails = false;
+        uint32_t thumbnailSize = kDefaultThumbnailSize;
+        thumb::RenderBackend renderBackend = thumb::RenderBackend::Gpu;
+        uint32_t indexThreads = 0; // 0 = one per hardware thread
+        uint32_t parseThreads = 0; // 0 = one per hardware thread
+        ReaderCacheLimits readerCache;
+        bool forceRescan = false;
+        fs::path metricsOut;       // Empty = no metrics report
+    };
+
+    // What a scan leaves behind for the next one when the scanner stays resident (--watch): the plugin
+    // index and parse cache it wrote, so a rescan neither reads them back from disk nor decodes them again
+    struct WarmScanState {
+        std::optional<PluginIndex> pluginIndex;
+        std::string cacheSignature;
+        std::unordered_map<std::string, ParseCacheFile> parseCache;
+    };
+
+    std::optional<thumb::RenderBackend> ParseRenderBackend(const std::string_view name) {
+        if (name == "gpu") {
+            return thumb::RenderBackend::Gpu;
+        }
+        if (name == "cpu") {
+            return thumb::RenderBackend::Cpu;
+        }
+        return std::nullopt;
+    }
+
+    std::string_view RenderBackendName(const thumb::RenderBackend backend) {
+        return backend == thumb::RenderBackend::Cpu ? "cpu" : "gpu";
+    }
+
+    std::vector<fs::path> PropertyMapperLocations(const PluginConfiguration& config) {
+        return {
+            fs::path("PropertyMapper.xml"),
+            fs::current_path() / "PropertyMapper.xml",
+            config.gameRoot / "PropertyMapper.xml"
+        };
+    }
+
+    // The header of a compiled property dictionary as hex: its format version and table sizes
+    std::string DictionaryHeaderHex(const fs::path& path) {
+        std::array<char, PropertyDictionaryFormat::kHeaderSize> header{};
+        std::ifstream file(path, std::ios::binary);
+        file.read(header.data(), header.size());
+        std::string hex;
+        for (const auto byte : std::span(header.data(), static_cast<size_t>(file.gcount()))) {
+            hex += std::format("{:02x}", static_cast<uint8_t>(byte));
+        }
+        return hex;
+    }
+
+    // Everything besides the plugin files themselves that changes what a scan produces. A stored
+    // index is only trusted for a no-op run when its signature matches this one.
+    std::string MakeCacheSignature(const PluginConfiguration& config, const ScanOptions& options) {
+        auto signature = std::format("{};render={};renderer={};size={}", SC4_PLOP_AND_PAINT_VERSION,
+                                     options.renderModelThumbnails ? 1 : 0, RenderBackendName(options.renderBackend),
+                                     options.thumbnailSize);
+        // The file each location would load, which is the compiled dictionary rather than the XML when
+        // it is current, or even when the XML is missing. Every location is included, since one whose
+        // file does not load passes on to the next.
+        for (const auto& loc : PropertyMapperLocations(config)) {
+            const auto source = PropertyMapper::sourceFor(loc);
+            const auto stamp = source ? StatPluginFile(*source) : std::nullopt;
+            if (!stamp) {
+                continue;
+            }
+            signature += std::format(";mapper={}:{}:{}", PluginPathKey(*source), stamp->fileSize,
+                                     stamp->lastWriteTicks);
+            if (*source != loc) {
+                signature += std::format(":{}", DictionaryHeaderHex(*source));
+            }
+        }
+        return signature;
+    }
+
+    bool IsKnownEntity(const ParseCacheRecord& record,
+                       const std::unordered_set<uint64_t>& seenPropKeys,
+                       const std::unordered_set<uint64_t>& seenFloraKeys) {
+        const uint64_t key = MakeGIKey(record.group, record.instance);
+        if (record.kind == ParsedRecordKind::Prop) {
+            return seenPropKeys.contains(key);
+        }
+        if (record.kind == ParsedRecordKind::Flora) {
+            return seenFloraKeys.contains(key);
+        }
+        return false;
+    }
+
+    // First-pass result for one exemplar or cohort. Fresh parses carry the parsed exemplar until the merge
+    // turns it into its catalog entity; icons and thumbnails are only attached on the merging thread, and
+    // only for entities that are not skipped as duplicates. The CPU renderer draws the models ahead on
+    // the parse workers; the GPU renderer draws them on the merging thread, which owns its window.
+    struct PendingRecord {
+        ParseCacheRecord record;
+        bool fresh = false;
+        std::optional<ParsedBuildingExemplar> building;
+        std::optional<ParsedPropExemplar> prop;
+        std::optional<ParsedFloraExemplar> flora;
+        std::vector<DBPF::Tgi> dependencies;
+    };
+
+    // What the classification pass made of the exemplars it read, for the summary after the pass
+    struct ExemplarClassCounts {
+        uint64_t buildings = 0;
+        uint64_t lotConfigs = 0;
+        uint64_t props = 0;
+        uint64_t flora = 0;
+        uint64_t skipped = 0;   // Exemplars the catalog has no use for, never decoded
+        uint64_t undecided = 0; // Decoded in full to classify them, e.g. text exemplars
+        uint64_t fullLoads = 0; // Exemplars and cohorts decoded in full
+        std::chrono::nanoseconds classifyTime{0};
+        std::chrono::nanoseconds fullLoadTime{0};
+
+        void add(const ExemplarClassCounts& other) {
+            buildings += other.buildings;
+            lotConfigs += other.lotConfigs;
+            props += other.props;
+            flora += other.flora;
+            skipped += other.skipped;
+            undecided += other.undecided;
+            fullLoads += other.fullLoads;
+            classifyTime += other.classifyTime;
+            fullLoadTime += other.fullLoadTime;
+        }
+    };
+
+    // A lot configuration from the first pass, waiting for the building it belongs to
+    struct PendingLot {
+        Lot lot;
+        uint32_t buildingReference = 0;
+    };
+
+    struct FileParseResult {
+        const PluginFileInfo* fileInfo = nullptr;
+        std::vector<PendingRecord> records;
+        size_t cachedRecords = 0;
+        uint32_t parseErrors = 0;
+        bool readerFailed = false;
+        ExemplarClassCounts classCounts;
+    };
+
+    // Thumbnails normalised per batch; enough to keep every core busy, small enough to hold in memory
+    constexpr size_t kThumbnailNormaliseBatch = 512;
+
+    // Models the GPU renderer draws per batch ahead of the merge; at most one atlas pass of small
+    // thumbnails, and well within the render cache at the largest size
+    constexpr size_t kThumbnailPrerenderBatch = 256;
+
+    // Files each parse worker may run ahead of the merge. Bounds the parsed records, thumbnails included,
+    // held while the merge waits for a slow file.
+    constexpr size_t kParseAheadFilesPerThread = 4;
+
+    // Adds the models the merge of a file will render thumbnails for, skipping entities that are
+    // already known and so will be dropped as duplicates
+    void CollectThumbnailModels(const FileParseResult& fileResult,
+                                const std::unordered_set<uint64_t>& seenPropKeys,
+                                const std::unordered_set<uint64_t>& seenFloraKeys,
+                                std::vector<DBPF::Tgi>& modelTgis) {
+        for (const auto& pending : fileResult.records) {
+            if (IsKnownEntity(pending.record, seenPropKeys, seenFloraKeys)) {
+                continue;
+            }
+            if (!pending.fresh) {
+                // Reused records get their thumbnail back from the render cache; a miss renders it again
+                if (const auto& model = pending.record.thumbnailModel; model.size() == 3) {
+                    modelTgis.push_back(DBPF::Tgi{model[0], model[1], model[2]});
+                }
+                continue;
+            }
+            if (pending.building && pending.building->modelTgi && !pending.building->iconTgi) {
+                modelTgis.push_back(*pending.building->modelTgi);
+            }
+            else if (pending.prop && pending.prop->modelTgi) {
+                modelTgis.push_back(*pending.prop->modelTgi);
+            }
+            else if (pending.flora && pending.flora->modelTgi) {
+                modelTgis.push_back(*pending.flora->modelTgi);
+            }
+        }
+    }
+
+    void ParseExemplarInto(PendingRecord& pending,
+                           const ExemplarParser& parser,
+                           const Exemplar::Record* exemplarResult,
+                           const DBPF::Tgi& tgi) {
+        auto& record = pending.record;
+        if (!exemplarResult) {
+            return;
+        }
+
+        if (tgi.type == kTypeIdCohort) {
+            if (auto parsedFamily = parser.parsePropFamilyFromCohort(*exemplarResult)) {
+                record.kind = ParsedRecordKind::PropFamily;
+                record.propFamily = std::move(*parsedFamily);
+            }
+            return;
+        }
+
+        const auto exemplarType = parser.getExemplarType(*exemplarResult);
+        if (!exemplarType || tgi.type != kTypeIdExemplar) {
+            return;
+        }
+
+        switch (*exemplarType) {
+        case ExemplarType::Building:
+            if (auto building = parser.parseBuilding(*exemplarResult, tgi)) {
+                record.kind = ParsedRecordKind::Building;
+                record.buildingFamilyIds = building->familyIds;
+                pending.building = std::move(*building);
+                // Buildings with an icon only get a rendered thumbnail if the icon fails to decode
+                if (pending.building->modelTgi && !pending.building->iconTgi) {
+                    parser.prerenderThumbnail(*pending.building->modelTgi);
+                }
+            }
+            break;
+        case ExemplarType::LotConfig:
+            record.kind = ParsedRecordKind::LotConfig;
+            if (auto lot = parser.parseLotConfig(*exemplarResult, tgi)) {
+                record.lot = parser.lotFromParsed(*lot);
+                record.lotBuildingReference = lot->buildingReference;
+            }
+            break;
+        case ExemplarType::Prop:
+            record.kind = ParsedRecordKind::Prop;
+            pending.prop = parser.parseProp(*exemplarResult, tgi);
+            if (pending.prop && pending.prop->modelTgi) {
+                parser.prerenderThumbnail(*pending.prop->modelTgi);
+            }
+            break;
+        case ExemplarType::Flora:
+            record.kind = ParsedRecordKind::Flora;
+            pending.flora = parser.parseFlora(*exemplarResult, tgi);
+            if (pending.flora && pending.flora->modelTgi) {
+                parser.prerenderThumbnail(*pending.flora->modelTgi);
+            }
+            break;
+        }
+    }
+
+    // Parses one exemplar or cohort, recording every entry it looked up through the index. exemplar is
+    // null when it could not be loaded. Safe to call from several threads at once.
+    PendingRecord ParseExemplarRecord(const ExemplarParser& parser, const Exemplar::Record* exemplar,
+                                      const DBPF::Tgi& tgi) {
+        PendingRecord pending;
+        pending.fresh = true;
+        pending.record = ParseCacheRecord{.type = tgi.type, .group = tgi.group, .instance = tgi.instance};
+
+        DbpfIndexService::DependencyScope scope(pending.dependencies);
+        ParseExemplarInto(pending, parser, exemplar, tgi);
+        return pending;
+    }
+
+    PendingRecord ParseExemplarRecord(const ExemplarParser& parser, DBPF::Reader& reader, const DBPF::Tgi& tgi) {
+        const auto exemplar = reader.LoadExemplar(tgi);
+        return ParseExemplarRecord(parser, exemplar.has_value() ? &*exemplar : nullptr, tgi);
+    }
+
+    // Reads only the Exemplar Type of an exemplar entry. Returns the finished record of an exemplar the
+    // catalog has no use for, or nullopt when the exemplar has to be decoded in full from the entry left
+    // in data.
+    std::optional<PendingRecord> ClassifyExemplar(const ExemplarParser& parser, const DBPF::Reader& reader,
+                                                  const DBPF::Tgi& tgi, ExemplarClassCounts& counts,
+                                                  std::optional<std::vector<uint8_t>>& data) {
+        const auto start = std::chrono::steady_clock::now();
+        PendingRecord pending;
+        pending.fresh = true;
+        pending.record = ParseCacheRecord{.type = tgi.type, .group = tgi.group, .instance = tgi.instance};
+
+        ExemplarClassification classification;
+        {
+            DbpfIndexService::DependencyScope scope(pending.dependencies);
+            data = reader.ReadEntryData(tgi);
+            if (data) {
+                classification = parser.classifyExemplar(*data);
+            }
+        }
+        counts.classifyTime += std::chrono::steady_clock::now() - start;
+
+        if (!classification.decided) {
+            counts.undecided++;
+            return std::nullopt;
+        }
+        if (!classification.type) {
+            counts.skipped++;
+            return pending;
+        }
+        switch (*classification.type) {
+        case ExemplarType::Building:
+            counts.buildings++;
+            return std::nullopt;
+        case ExemplarType::LotConfig:
+            counts.lotConfigs++;
+            return std::nullopt;
+        case ExemplarType::Prop:
+            counts.props++;
+            return std::nullopt;
+        case ExemplarType::Flora:
+            counts.flora++;
+            return std::nullopt;
+        }
+        return std::nullopt;
+    }
+
+    // The thumbnail of the building, prop or flora a record holds; null for other records
+    std::optional<Thumbnail>* RecordThumbnail(ParseCacheRecord& record) {
+        if (record.building) {
+            return &record.building->thumbnail;
+        }
+        if (record.prop) {
+            return &record.prop->thumbnail;
+        }
+        if (record.flora) {
+            return &record.flora->thumbnail;
+        }
+        return nullptr;
+    }
+
+    bool IsRenderedThumbnail(const Thumbnail& thumbnail) {
+        return rfl::visit([](const auto& variant) {
+            return std::is_same_v<std::decay_t<decltype(variant)>, PreRendered>;
+        }, thumbnail);
+    }
+
+    // Builds the catalog entity of a freshly parsed record. Props and flora that are already known are
+    // only classified, since the merge skips them anyway.
+    void FinishExemplarRecord(PendingRecord& pending,
+                              const ExemplarParser& parser,
+                              const std::unordered_set<uint64_t>& seenPropKeys,
+                              const std::unordered_set<uint64_t>& seenFloraKeys) {
+        auto& record = pending.record;
+        {
+            DbpfIndexService::DependencyScope scope(pending.dependencies);
+            if (record.kind == ParsedRecordKind::Building && pending.building) {
+                record.building = parser.buildingFromParsed(*pending.building);
+            }
+            else if (record.kind == ParsedRecordKind::Prop || record.kind == ParsedRecordKind::Flora) {
+                if (IsKnownEntity(record, seenPropKeys, seenFloraKeys)) {
+                    record.parsed = false;
+                }
+                else if (pending.prop) {
+                    record.prop = parser.propFromParsed(*pending.prop);
+                }
+                else if (pending.flora) {
+                    record.flora = parser.floraFromParsed(*pending.flora);
+                }
+            }
+        }
+
+        std::optional<DBPF::Tgi> modelTgi;
+        if (pending.building) {
+            modelTgi = pending.building->modelTgi;
+        }
+        else if (pending.prop) {
+            modelTgi = pending.prop->modelTgi;
+        }
+        else if (pending.flora) {
+            modelTgi = pending.flora->modelTgi;
+        }
+        const auto* thumbnail = RecordThumbnail(record);
+        if (modelTgi && thumbnail && *thumbnail && IsRenderedThumbnail(**thumbnail)) {
+            record.thumbnailModel = FlattenTgis(std::span(&*modelTgi, 1));
+        }
+
+        std::unordered_set<DBPF::Tgi, DBPF::TgiHash> uniqueDependencies;
+        std::erase_if(pending.dependencies, [&](const DBPF::Tgi& dep) {
+            return !uniqueDependencies.insert(dep).second;
+        });
+        record.dependencies = FlattenTgis(pending.dependencies);
+        pending.fresh = false;
+    }
+
+    // Parses the exemplars of one plugin file, taking records from the previous parse cache where the
+    // file and everything they depend on is unchanged. Runs on the parse workers.
+    FileParseResult ParsePluginFile(const DbpfIndexService& indexService,
+                                    const ExemplarParser& parser,
+                                    const fs::path& filePath,
+                                    const std::vector<DBPF::Tgi>& tgis,
+                                    std::unordered_map<std::string, ParseCacheFile>& previousParseCache,
+                                    const std::unordered_set<DBPF::Tgi, DBPF::TgiHash>* changedTgis,
+                                    spdlog::logger& logger) {
+        FileParseResult result;
+        result.fileInfo = indexService.fileInfo(filePath);
+
+        // Each worker only touches the cache entry of its own file, and the map itself is not modified
+        std::unordered_map<DBPF::Tgi, ParseCacheRecord*, DBPF::TgiHash> cachedRecords;
+        if (result.fileInfo && changedTgis) {
+            auto cacheIt = previousParseCache.find(result.fileInfo->filePath);
+            if (cacheIt != previousParseCache.end()
+                && cacheIt->second.fileSize == result.fileInfo->fileSize
+                && cacheIt->second.lastWriteTicks == result.fileInfo->lastWriteTicks) {
+                for (auto& record : cacheIt->second.records) {
+                    if (IsParseRecordCurrent(record, *changedTgis)) {
+                        cachedRecords.emplace(DBPF::Tgi{record.type, record.group, record.instance}, &record);
+                    }
+                }
+            }
+        }
+
+        // Only open the file when something in it has to be parsed
+        std::shared_ptr<DBPF::Reader> reader;
+        const bool fullyCached = std::ranges::all_of(tgis, [&](const DBPF::Tgi& tgi) {
+            return cachedRecords.contains(tgi);
+        });
+        if (!fullyCached) {
+            // Get cached reader from index service
+            reader = indexService.getReader(filePath);
+            if (!reader) {
+                logger.warn("Failed to get reader for file: {}", filePath.string());
+                result.readerFailed = true;
+                return result;
+            }
+        }
+
+        logger.debug("Processing {} exemplars from {} ({} cached)",
+                     tgis.size(), filePath.filename().string(), cachedRecords.size());
+
+        // Exemplars are classified from their raw Exemplar Type first, and only those the catalog needs
+        // are decoded. Those are loaded up front, so the names and descriptions they refer to can be read
+        // in one batch instead of one entry per exemplar. Those that fail to load are retried below.
+        std::vector<std::optional<PendingRecord>> classified(tgis.size());
+        std::vector<std::optional<Exemplar::Record>> exemplars(tgis.size());
+        if (reader) {
+            std::vector<const Exemplar::Record*> loaded;
+            loaded.reserve(tgis.size());
+            for (size_t i = 0; i < tgis.size(); ++i) {
+                if (cachedRecords.contains(tgis[i])) {
+                    continue;
+                }
+                try {
+                    // The entry read for classification is decoded from memory rather than read again
+                    std::optional<std::vector<uint8_t>> data;
+                    if (tgis[i].type == kTypeIdExemplar) {
+                        classified[i] = ClassifyExemplar(parser, *reader, tgis[i], result.classCounts, data);
+                        if (classified[i]) {
+                            continue;
+                        }
+                    }
+                    const auto loadStart = std::chrono::steady_clock::now();
+                    auto exemplar = data ? Exemplar::Parse(std::span<const uint8_t>(*data))
+                                         : reader->LoadExemplar(tgis[i]);
+                    result.classCounts.fullLoadTime += std::chrono::steady_clock::now() - loadStart;
+                    result.classCounts.fullLoads++;
+                    if (exemplar.has_value()) {
+                        loaded.push_back(&exemplars[i].emplace(std::move(*exemplar)));
+                    }
+                }
+                catch (const std::exception&) {
+                    // Loaded again and reported below
+                }
+            }
+            parser.prefetchLocalizedTexts(loaded);
+        }
+
+        result.records.reserve(tgis.size());
+        for (size_t i = 0; i < tgis.size(); ++i) {
+            const auto& tgi = tgis[i];
+            try {
+                if (auto cachedIt = cachedRecords.find(tgi); cachedIt != cachedRecords.end()) {
+                    result.records.push_back(PendingRecord{.record = std::move(*cachedIt->second)});
+                    result.cachedRecords++;
+                }
+                else if (classified[i]) {
+                    result.records.push_back(std::move(*classified[i]));
+                }
+                else if (exemplars[i]) {
+                    result.records.push_back(ParseExemplarRecord(parser, &*exemplars[i], tgi));
+                    exemplars[i].reset();
+                }
+                else {
+                    result.records.push_back(ParseExemplarRecord(parser, *reader, tgi));
+                }
+            }
+            catch (const std::exception& error) {
+                logger.debug("Error processing TGI {}/{}/{}: {}",
+                             tgi.type, tgi.group, tgi.instance, error.what());
+                result.parseErrors++;
+            }
+        }
+        return result;
+    }
+
+    // Counts a written cache file towards the write phase
+    void RecordWrite(ScanMetrics* metrics, const fs::path& path) {
+        if (!metrics) {
+            return;
+        }
+        std::error_code ec;
+        const auto size = fs::file_size(path, ec);
+        metrics->addItems(ScanPhase::Writes, 1);
+        metrics->addBytesWritten(ScanPhase::Writes, ec ? 0 : static_cast<uint64_t>(size));
+    }
+
+    bool AllOutputsExist(const fs::path& directory, const std::vector<std::string>& outputs) {
+        std::error_code ec;
+        return std::ranges::all_of(outputs, [&](const std::string& name) {
+            return fs::exists(directory / name, ec);
+        });
+    }
+
     void ScanAndAnalyzeExemplars(const PluginConfiguration& config,
                                  spdlog::logger& logger,
-                                 bool renderModelThumbnails,
-                                 const uint32_t thumbnailSize) {
+                                 const ScanOptions& options,
+                                 WarmScanState* warm = nullptr) {
+        const bool renderModelThumbnails = options.renderModelThumbnails;
+        const uint32_t thumbnailSize = options.thumbnailSize;
+
+        std::unique_ptr<ScanMetrics> metrics;
+        if (!options.metricsOut.empty()) {
+            metrics = std::make_unique<ScanMetrics>();
+        }
+        const auto writeMetrics = [&] {
+            if (metrics && metrics->write(options.metricsOut)) {
+                logger.info("Wrote scan metrics to {}", options.metricsOut.string());
+            }
+        };
+        // Times the top-level phase currently running, if metrics were requested
+        std::optional<ScanMetrics::Timer> phaseTimer;
+
         try {
             logger.info("Initializing plugin scanner...");
 
@@ -210,9 +712,45 @@ namespace {
             // Create locator to discover plugin files
             PluginLocator locator(config);
 
-            // Create and start the index service immediately for parallel indexing
-            DbpfIndexService indexService(locator);
+            // A previous index lets unchanged files skip indexing, and when nothing changed at all
+            // the existing caches are still valid and the scan can stop here.
+            const auto indexPath = config.userPluginsRoot / kPluginIndexFileName;
+            const auto cacheSignature = MakeCacheSignature(config, options);
+            std::optional<PluginIndex> previousIndex;
+            if (options.forceRescan) {
+                logger.info("Forced rescan requested, ignoring existing plugin index");
+            }
+            else if (warm && warm->pluginIndex) {
+                previousIndex = std::move(warm->pluginIndex);
+                warm->pluginIndex.reset();
+            }
+            else {
+                previousIndex = LoadPluginIndex(indexPath);
+            }
+
+            DbpfIndexService indexService(locator, options.indexThreads, options.readerCache);
+            if (previousIndex) {
+                if (previousIndex->cacheSignature == cacheSignature
+                    && AllOutputsExist(config.userPluginsRoot, previousIndex->outputs)
+                    && IsPluginIndexCurrent(*previousIndex, locator.ListDbpfFiles())) {
+                    logger.info("No plugin changes since {} ({} files), caches are up to date",
+                                previousIndex->buildTime.str(), previousIndex->files.size());
+                    if (warm) {
+                        warm->pluginIndex = std::move(previousIndex);
+                    }
+                    writeMetrics();
+                    return;
+                }
+                if (previousIndex->cacheSignature != cacheSignature) {
+                    logger.info("Scan options or property mapper changed, rebuilding caches");
+                }
+                indexService.setPreviousIndex(std::move(*previousIndex));
+                previousIndex.reset();
+            }
+
+            // Start the index service immediately for parallel indexing
             logger.info("Starting background indexing service...");
+            phaseTimer.emplace(metrics.get(), ScanPhase::Indexing);
             indexService.start();
 
             // While indexing happens in the background, load the property mapper
@@ -220,20 +758,12 @@ namespace {
             PropertyMapper propertyMapper;
             auto mapperLoaded = false;
 
-            // Try common locations for the property mapper XML
-            std::vector<fs::path> mapperLocations{
-                fs::path("PropertyMapper.xml"),
-                fs::current_path() / "PropertyMapper.xml",
-                config.gameRoot / "PropertyMapper.xml"
-            };
-
-            for (const auto& loc : mapperLocations) {
-                if (fs::exists(loc)) {
-                    if (propertyMapper.loadFromXml(loc)) {
-                        logger.info("Loaded property mapper from: {}", loc.string());
-                        mapperLoaded = true;
-                        break;
-                    }
+            // Try common locations for the property mapper, preferring its compiled dictionary to the XML
+            for (const auto& loc : PropertyMapperLocations(config)) {
+                if (propertyMapper.load(loc)) {
+                    logger.info("Loaded property mapper from: {}", loc.parent_path().string());
+                    mapperLoaded = true;
+                    break;
                 }
             }
 
@@ -264,20 +794,39 @@ namespace {
 
             // Log final indexing results
             auto finalProgress = indexService.snapshot();
-            logger.info("Indexing complete: {} files processed, {} entries indexed, {} errors",
-                        finalProgress.processedFiles, finalProgress.totalFiles, finalProgress.errorCount);
+            logger.info("Indexing complete: {} files processed ({} unchanged), {} entries indexed, {} errors",
+                        finalProgress.processedFiles, finalProgress.reusedFiles, finalProgress.entriesIndexed,
+                        finalProgress.errorCount);
+            phaseTimer.reset();
+            if (metrics) {
+                metrics->addItems(ScanPhase::Indexing, finalProgress.processedFiles);
+                metrics->addBytesRead(ScanPhase::Indexing, finalProgress.bytesRead);
+            }
+
+            // Report which files override entries loaded before them
+            if (const auto sealedIndex = indexService.indexSnapshot()) {
+                constexpr size_t kTopOverridingFiles = 10;
+                logger.info("{} entries are overridden by files loaded later", sealedIndex->overriddenTgis);
+                for (size_t i = 0; i < sealedIndex->overridesByFile.size(); ++i) {
+                    const auto& [fileIndex, count] = sealedIndex->overridesByFile[i];
+                    const auto level = i < kTopOverridingFiles ? spdlog::level::info : spdlog::level::debug;
+                    logger.log(level, "  {} overrides {} entries", sealedIndex->files[fileIndex].string(), count);
+                }
+            }
 
             uint32_t buildingsFound = 0;
             uint32_t lotsFound = 0;
             uint32_t parseErrors = 0;
             std::set<uint32_t> missingBuildingIds;
 
-            ExemplarParser parser(propertyMapper, &indexService, renderModelThumbnails, thumbnailSize);
-            std::vector<Building> allBuildings;
-            std::vector<Prop> allProps;
-            std::vector<Flora> allFlora;
+            ExemplarParser parser(propertyMapper, &indexService, renderModelThumbnails, thumbnailSize,
+                                  options.renderBackend);
+            parser.setMetrics(metrics.get());
+            phaseTimer.emplace(metrics.get(), ScanPhase::ExemplarPass);
+            const auto bytesOpenedBefore = indexService.readerCacheStats().bytesOpened;
             std::unordered_map<uint32_t, std::string> propFamilyNamesById;
-            std::unordered_map<uint32_t, ParsedBuildingExemplar> buildingMap;
+            std::unordered_set<uint32_t> referencedPropFamilyIds;
+            std::unordered_map<uint32_t, std::vector<uint32_t>> buildingFamilyIds;
             std::unordered_map<uint32_t, Building> builtBuildings;
             std::unordered_set<uint64_t> seenLotKeys;
             std::unordered_set<uint64_t> seenPropKeys;
@@ -286,8 +835,9 @@ namespace {
             // Use the index service to get exemplars and cohorts across all files.
             logger.info("Processing exemplar/cohort records using type index...");
 
-            // Group record TGIs by file for efficient batch processing.
-            std::unordered_map<fs::path, std::vector<DBPF::Tgi>> fileToExemplarTgis;
+            // Group record TGIs by the file the game loads them from, for efficient batch processing.
+            // Keyed by file index so files are processed in load order on every machine.
+            std::map<uint32_t, std::vector<DBPF::Tgi>> fileToExemplarTgis;
             {
                 auto exemplarTgis = indexService.typeIndex(kTypeIdExemplar);
                 auto cohortTgis = indexService.typeIndex(kTypeIdCohort);
@@ -300,10 +850,15 @@ namespace {
                 recordTgis.insert(recordTgis.end(), exemplarTgis.begin(), exemplarTgis.end());
                 recordTgis.insert(recordTgis.end(), cohortTgis.begin(), cohortTgis.end());
 
+                // The type index lists overridden TGIs once per file; only the winning copy is parsed
+                std::unordered_set<DBPF::Tgi, DBPF::TgiHash> queuedTgis;
+                queuedTgis.reserve(recordTgis.size());
                 for (const auto& tgi : recordTgis) {
-                    auto files = indexService.lookupFiles(tgi);
-                    if (!files.empty()) {
-                        fileToExemplarTgis[files[0]].push_back(tgi);
+                    if (!queuedTgis.insert(tgi).second) {
+                        continue;
+                    }
+                    if (const auto fileIndex = indexService.winningFile(tgi)) {
+                        fileToExemplarTgis[*fileIndex].push_back(tgi);
                     }
                 }
             }
@@ -311,222 +866,548 @@ namespace {
             size_t filesProcessed = 0;
 
             // Store lot config TGIs for second pass
-            std::vector<std::pair<fs::path, DBPF::Tgi>> lotConfigTgis;
+            std::vector<PendingLot> pendingLots;
+
+            // First-pass results of files that did not change since the last scan are taken from the parse
+            // cache, as long as none of the entries they looked up (parent cohorts, LTEXT, icons, models,
+            // textures) changed either. Records are merged in the same order as a full parse would.
+            const auto parseCachePath = config.userPluginsRoot / kParseCacheFileName;
+            const auto* changedTgis = indexService.changedTgis();
+            std::unordered_map<std::string, ParseCacheFile> previousParseCache;
+            if (changedTgis) {
+                if (warm && !warm->parseCache.empty() && warm->cacheSignature == cacheSignature) {
+                    previousParseCache = std::move(warm->parseCache);
+                }
+                else {
+                    previousParseCache = LoadParseCache(parseCachePath, cacheSignature);
+                }
+            }
+            if (warm) {
+                warm->parseCache.clear();
+                warm->cacheSignature = cacheSignature;
+            }
+            ParseCacheWriter parseCacheWriter(parseCachePath, cacheSignature);
+            size_t recordsReused = 0;
+            size_t recordsParsed = 0;
+            ExemplarClassCounts classCounts;
+
+            // Catalog records are written out as soon as they are final instead of being collected for the
+            // whole install: props and flora while merging the first pass, buildings once the lot-config pass
+            // gave them their lots. Thumbnails are normalised and spooled to disk on the way.
+            fs::create_directories(config.userPluginsRoot);
+
+            // Rendered thumbnails are addressed by content, so they stay valid across scans as long as the
+            // model and its textures are unchanged. --force starts over with an empty cache.
+            std::unique_ptr<thumb::RenderCache> renderCache;
+            if (renderModelThumbnails) {
+                const auto renderCachePath = config.userPluginsRoot / kRenderCacheFileName;
+                if (options.forceRescan) {
+                    std::error_code ec;
+                    fs::remove(renderCachePath, ec);
+                }
+                renderCache = std::make_unique<thumb::RenderCache>(renderCachePath);
+                parser.setRenderCache(renderCache.get());
+            }
 
-            for (const auto& [filePath, tgis] : fileToExemplarTgis) {
-                try {
-                    // Get cached reader from index service
-                    auto* reader = indexService.getReader(filePath);
-                    if (!reader) {
-                        logger.warn("Failed to get reader for file: {}", filePath.string());
-                        continue;
+            ThumbnailBin::Spool buildingThumbnails(config.userPluginsRoot / "lot_thumbnails.bin");
+            ThumbnailBin::Spool propThumbnails(config.userPluginsRoot / "prop_thumbnails.bin");
+            ThumbnailBin::Spool floraThumbnails(config.userPluginsRoot / "flora_thumbnails.bin");
+
+            CatalogWriter propsWriter(config.userPluginsRoot / "props.cbor");
+            propsWriter.beginMap<PropsCache>();
+            propsWriter.field("version", PropsCache{}.version);
+            propsWriter.key("props");
+            propsWriter.beginArray();
+
+            CatalogWriter floraWriter(config.userPluginsRoot / "flora.cbor");
+            floraWriter.beginMap<FloraCache>();
+            floraWriter.field("version", FloraCache{}.version);
+            floraWriter.key("floraItems");
+            floraWriter.beginArray();
+
+            size_t sanitizedFields = 0;
+
+            // Thumbnails are normalised in batches across all cores, then spooled in the order they came in
+            const size_t normaliseThreads = std::max<size_t>(
+                1, options.parseThreads > 0 ? options.parseThreads : std::thread::hardware_concurrency());
+            std::vector<PendingThumbnail> pendingThumbnails;
+            pendingThumbnails.reserve(kThumbnailNormaliseBatch);
+
+            const auto flushThumbnails = [&] {
+                if (pendingThumbnails.empty()) {
+                    return;
+                }
+                NormalizeThumbnails(pendingThumbnails, thumbnailSize, normaliseThreads, metrics.get());
+                if (metrics) {
+                    metrics->addItems(ScanPhase::Normalisation, pendingThumbnails.size());
+                }
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                for (const auto& pending : pendingThumbnails) {
+                    pending.spool->add(pending.key, pending.thumbnail);
+                }
+                pendingThumbnails.clear();
+            };
+
+            const auto spoolThumbnail = [&](ThumbnailBin::Spool& spool, const uint64_t key,
+                                            std::optional<Thumbnail>& thumbnail) {
+                if (!thumbnail) {
+                    return;
+                }
+                pendingThumbnails.push_back({&spool, key, std::move(*thumbnail)});
+                thumbnail.reset();
+                if (pendingThumbnails.size() >= kThumbnailNormaliseBatch) {
+                    flushThumbnails();
+                }
+            };
+
+            const auto writeProp = [&](Prop prop) {
+                spoolThumbnail(propThumbnails, MakeGIKey(prop.groupId.value(), prop.instanceId.value()),
+                               prop.thumbnail);
+                sanitizedFields += SanitizeStrings(prop);
+                for (const auto& familyId : prop.familyIds) {
+                    if (familyId.value() != 0) {
+                        referencedPropFamilyIds.insert(familyId.value());
                     }
+                }
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                propsWriter.append(prop);
+            };
 
-                    logger.debug("Processing {} exemplars from {}", tgis.size(), filePath.filename().string());
+            const auto writeFlora = [&](Flora flora) {
+                spoolThumbnail(floraThumbnails, MakeGIKey(flora.groupId.value(), flora.instanceId.value()),
+                               flora.thumbnail);
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                floraWriter.append(flora);
+            };
 
-                    // Process all exemplars in this file
-                    for (const auto& tgi : tgis) {
+            auto mergeRecord = [&](const ParseCacheRecord& record, const fs::path& filePath) {
+                const DBPF::Tgi tgi{record.type, record.group, record.instance};
+                const uint64_t giKey = MakeGIKey(tgi.group, tgi.instance);
+                switch (record.kind) {
+                case ParsedRecordKind::None:
+                    break;
+                case ParsedRecordKind::PropFamily: {
+                    const uint32_t familyId = record.propFamily->familyId.value();
+                    const auto& displayName = record.propFamily->displayName;
+                    auto [it, inserted] = propFamilyNamesById.emplace(familyId, displayName);
+                    if (!inserted && it->second != displayName) {
+                        spdlog::debug("Duplicate prop family name for 0x{:08X}: keeping '{}', ignoring '{}'",
+                                      familyId, it->second, displayName);
+                    }
+                    break;
+                }
+                case ParsedRecordKind::Building: {
+                    buildingFamilyIds[tgi.instance] = record.buildingFamilyIds;
+                    // Thumbnails are spooled now; those of buildings that end up without lots are dropped later
+                    auto [it, inserted] = builtBuildings.try_emplace(tgi.instance, *record.building);
+                    if (inserted) {
+                        auto& building = it->second;
+                        spoolThumbnail(buildingThumbnails,
+                                       MakeGIKey(building.groupId.value(), building.instanceId.value()),
+                                       building.thumbnail);
+                    }
+                    buildingsFound++;
+                    logger.trace("  Building: {} (0x{:08X})", record.building->name, tgi.instance);
+                    break;
+                }
+                case ParsedRecordKind::LotConfig:
+                    // Resolved against the buildings in the second pass
+                    if (record.lot) {
+                        pendingLots.push_back({*record.lot, record.lotBuildingReference});
+                    }
+                    break;
+                case ParsedRecordKind::Prop:
+                    if (seenPropKeys.contains(giKey)) {
+                        logger.warn("Duplicate prop skipped: (group=0x{:08X}, instance=0x{:08X})",
+                                    tgi.group, tgi.instance);
+                    }
+                    else if (record.prop) {
+                        logger.trace("  Prop: {} (0x{:08X})", record.prop->visibleName, tgi.instance);
+                        writeProp(*record.prop);
+                        seenPropKeys.insert(giKey);
+                    }
+                    break;
+                case ParsedRecordKind::Flora:
+                    if (seenFloraKeys.contains(giKey)) {
+                        logger.warn("Duplicate flora skipped: (group=0x{:08X}, instance=0x{:08X})",
+                                    tgi.group, tgi.instance);
+                    }
+                    else if (record.flora) {
+                        logger.trace("  Flora: {} (0x{:08X})", record.flora->visibleName, tgi.instance);
+                        writeFlora(*record.flora);
+                        seenFloraKeys.insert(giKey);
+                    }
+                    break;
+                }
+            };
+
+            // Files are parsed on a worker pool, and merged on this thread strictly in the order of
+            // fileTasks as soon as each file is ready. Merging in a fixed order keeps duplicate skipping and
+            // "first wins" identical to a serial scan, whichever thread rendered the thumbnails.
+            std::vector<std::pair<const fs::path*, const std::vector<DBPF::Tgi>*>> fileTasks;
+            fileTasks.reserve(fileToExemplarTgis.size());
+            for (const auto& [fileIndex, tgis] : fileToExemplarTgis) {
+                fileTasks.emplace_back(&indexService.filePath(fileIndex), &tgis);
+            }
+
+            std::vector<FileParseResult> fileResults(fileTasks.size());
+            std::vector<char> fileReady(fileTasks.size(), 0);
+            std::mutex fileReadyMutex;
+            std::condition_variable fileReadyCv;
+            std::atomic<size_t> nextFileTask{0};
+            size_t mergedTask = 0;     // Files before this one are merged; guarded by fileReadyMutex
+            bool mergeStopped = false; // Guarded by fileReadyMutex
+
+            size_t parseThreadCount = options.parseThreads > 0 ? options.parseThreads
+                                                               : std::thread::hardware_concurrency();
+            parseThreadCount = std::clamp<size_t>(parseThreadCount, 1, std::max<size_t>(1, fileTasks.size()));
+            const size_t parseWindow = parseThreadCount * kParseAheadFilesPerThread;
+
+            std::vector<std::jthread> parseWorkers;
+            parseWorkers.reserve(parseThreadCount);
+            for (size_t i = 0; i < parseThreadCount; ++i) {
+                parseWorkers.emplace_back([&] {
+                    while (true) {
+                        const size_t task = nextFileTask.fetch_add(1);
+                        if (task >= fileTasks.size()) {
+                            break;
+                        }
+                        {
+                            std::unique_lock lock(fileReadyMutex);
+                            fileReadyCv.wait(lock, [&] { return mergeStopped || task < mergedTask + parseWindow; });
+                            if (mergeStopped) {
+                                break;
+                            }
+                        }
+                        const auto& [filePath, tgis] = fileTasks[task];
                         try {
-                            auto exemplarResult = reader->LoadExemplar(tgi);
-                            if (!exemplarResult.has_value()) {
-                                continue;
+                            const auto fileStart = std::chrono::steady_clock::now();
+                            fileResults[task] = ParsePluginFile(indexService, parser, *filePath, *tgis,
+                                                                previousParseCache, changedTgis, logger);
+                            if (metrics) {
+                                metrics->recordFile(filePath->string(), std::chrono::duration<double, std::milli>(
+                                                        std::chrono::steady_clock::now() - fileStart).count());
                             }
+                        }
+                        catch (const std::exception& error) {
+                            logger.warn("Error processing file {}: {}", filePath->filename().string(), error.what());
+                            fileResults[task].readerFailed = true;
+                        }
+                        {
+                            std::lock_guard lock(fileReadyMutex);
+                            fileReady[task] = 1;
+                        }
+                        fileReadyCv.notify_all();
+                    }
+                });
+            }
 
-                            if (tgi.type == kTypeIdCohort) {
-                                if (auto parsedFamily = parser.parsePropFamilyFromCohort(*exemplarResult)) {
-                                    const uint32_t familyId = parsedFamily->familyId.value();
-                                    auto [it, inserted] = propFamilyNamesById.emplace(
-                                        familyId, parsedFamily->displayName);
-                                    if (!inserted && it->second != parsedFamily->displayName) {
-                                        spdlog::debug(
-                                            "Duplicate prop family name for 0x{:08X}: keeping '{}', ignoring '{}'",
-                                            familyId, it->second, parsedFamily->displayName);
-                                    }
-                                }
-                                continue;
-                            }
+            // Releases workers still waiting for the window if the merge stops early, so joining them
+            // cannot hang
+            struct ParseWindowRelease {
+                std::mutex& mutex;
+                std::condition_variable& cv;
+                bool& stopped;
+
+                ~ParseWindowRelease() {
+                    {
+                        std::lock_guard lock(mutex);
+                        stopped = true;
+                    }
+                    cv.notify_all();
+                }
+            } parseWindowRelease{fileReadyMutex, fileReadyCv, mergeStopped};
+
+            // The GPU renderer draws on this thread. Before merging, the models of this and any further files
+            // that are already parsed are rendered as one batch, so they share atlas passes and readbacks.
+            const bool batchThumbnails = parser.renderBackend() == thumb::RenderBackend::Gpu;
+            size_t prerenderedFiles = 0;
+            std::vector<DBPF::Tgi> prerenderModels;
+
+            for (size_t task = 0; task < fileTasks.size(); ++task) {
+                {
+                    // The previous file's results are gone, so one more file may be parsed ahead
+                    std::unique_lock lock(fileReadyMutex);
+                    mergedTask = task;
+                    fileReadyCv.notify_all();
+                    fileReadyCv.wait(lock, [&] { return fileReady[task] != 0; });
+                }
+                if (batchThumbnails && task >= prerenderedFiles) {
+                    size_t readyFiles = task + 1;
+                    {
+                        std::lock_guard lock(fileReadyMutex);
+                        while (readyFiles < fileTasks.size() && fileReady[readyFiles] != 0) {
+                            ++readyFiles;
+                        }
+                    }
+                    prerenderModels.clear();
+                    prerenderedFiles = task;
+                    while (prerenderedFiles < readyFiles && prerenderModels.size() < kThumbnailPrerenderBatch) {
+                        CollectThumbnailModels(fileResults[prerenderedFiles++], seenPropKeys, seenFloraKeys,
+                                               prerenderModels);
+                    }
+                    parser.prerenderThumbnails(prerenderModels);
+                }
+                const auto& filePath = *fileTasks[task].first;
+                auto fileResult = std::move(fileResults[task]);
+                parseErrors += fileResult.parseErrors;
+                classCounts.add(fileResult.classCounts);
+                if (fileResult.readerFailed) {
+                    continue;
+                }
 
-                            auto exemplarType = parser.getExemplarType(*exemplarResult);
-                            if (!exemplarType) {
-                                continue;
-                            }
+                ParseCacheFile parsedFile;
+                if (fileResult.fileInfo) {
+                    parsedFile.filePath = fileResult.fileInfo->filePath;
+                    parsedFile.fileSize = fileResult.fileInfo->fileSize;
+                    parsedFile.lastWriteTicks = fileResult.fileInfo->lastWriteTicks;
+                }
+                parsedFile.records.reserve(fileResult.records.size());
+                recordsReused += fileResult.cachedRecords;
+                recordsParsed += fileResult.records.size() - fileResult.cachedRecords;
+
+                for (auto& pending : fileResult.records) {
+                    const DBPF::Tgi tgi{pending.record.type, pending.record.group, pending.record.instance};
+                    try {
+                        if (pending.fresh) {
+                            FinishExemplarRecord(pending, parser, seenPropKeys, seenFloraKeys);
+                        }
 
-                            if (tgi.type != kTypeIdExemplar) {
+                        // Skipped as a duplicate when it was parsed, but no longer shadowed now
+                        if (!pending.record.parsed && !IsKnownEntity(pending.record, seenPropKeys, seenFloraKeys)) {
+                            const auto reader = indexService.getReader(filePath);
+                            if (!reader) {
+                                logger.warn("Failed to get reader for file: {}", filePath.string());
                                 continue;
                             }
+                            pending = ParseExemplarRecord(parser, *reader, tgi);
+                            FinishExemplarRecord(pending, parser, seenPropKeys, seenFloraKeys);
+                            recordsParsed++;
+                        }
 
-                            if (*exemplarType == ExemplarType::Building) {
-                                auto building = parser.parseBuilding(*exemplarResult, tgi);
-                                if (building) {
-                                    buildingMap[tgi.instance] = *building;
-                                    builtBuildings.try_emplace(tgi.instance, parser.buildingFromParsed(*building));
-                                    buildingsFound++;
-                                    logger.trace("  Building: {} (0x{:08X})", building->name, tgi.instance);
-                                }
-                            }
-                            else if (*exemplarType == ExemplarType::LotConfig) {
-                                // Queue for second pass
-                                lotConfigTgis.emplace_back(filePath, tgi);
-                            }
-                            else if (*exemplarType == ExemplarType::Prop) {
-                                if (seenPropKeys.contains(MakeGIKey(tgi.group, tgi.instance))) {
-                                    logger.warn("Duplicate prop skipped: (group=0x{:08X}, instance=0x{:08X})",
-                                                tgi.group, tgi.instance);
-                                    continue;
-                                }
-                                if (auto prop = parser.parseProp(*exemplarResult, tgi)) {
-                                    logger.trace("  Prop: {} (0x{:08X})", prop->visibleName, tgi.instance);
-                                    allProps.emplace_back(
-                                        parser.propFromParsed(*prop)
-                                    );
-                                    seenPropKeys.insert(MakeGIKey(tgi.group, tgi.instance));
-                                }
-                            }
-                            else if (*exemplarType == ExemplarType::Flora) {
-                                if (seenFloraKeys.contains(MakeGIKey(tgi.group, tgi.instance))) {
-                                    logger.warn("Duplicate flora skipped: (group=0x{:08X}, instance=0x{:08X})",
-                                                tgi.group, tgi.instance);
-                                    continue;
-                                }
-                                if (auto flora = parser.parseFlora(*exemplarResult, tgi)) {
-                                    logger.trace("  Flora: {} (0x{:08X})", flora->visibleName, tgi.instance);
-                                    allFlora.emplace_back(parser.floraFromParsed(*flora));
-                                    seenFloraKeys.insert(MakeGIKey(tgi.group, tgi.instance));
-                                }
-                            }
+                        auto* thumbnail = RecordThumbnail(pending.record);
+                        const auto& model = pending.record.thumbnailModel;
+                        if (thumbnail && !*thumbnail && model.size() == 3
+                            && !IsKnownEntity(pending.record, seenPropKeys, seenFloraKeys)) {
+                            *thumbnail = parser.modelThumbnail(DBPF::Tgi{model[0], model[1], model[2]});
                         }
-                        catch (const std::exception& error) {
-                            logger.debug("Error processing TGI {}/{}/{}: {}",
-                                         tgi.type, tgi.group, tgi.instance, error.what());
-                            parseErrors++;
+
+                        mergeRecord(pending.record, filePath);
+                        // The render cache holds rendered thumbnails, so the parse cache does not keep them
+                        if (thumbnail && model.size() == 3) {
+                            thumbnail->reset();
                         }
+                        parsedFile.records.push_back(std::move(pending.record));
                     }
+                    catch (const std::exception& error) {
+                        logger.debug("Error processing TGI {}/{}/{}: {}",
+                                     tgi.type, tgi.group, tgi.instance, error.what());
+                        parseErrors++;
+                    }
+                }
 
-                    filesProcessed++;
-
-                    // Log progress periodically
-                    if (filesProcessed % 100 == 0) {
-                        logger.info("  Processed {}/{} files ({} buildings found so far)",
-                                    filesProcessed, fileToExemplarTgis.size(), buildingsFound);
+                if (fileResult.fileInfo) {
+                    ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                    parseCacheWriter.add(parsedFile);
+                    if (warm) {
+                        auto key = parsedFile.filePath;
+                        warm->parseCache.insert_or_assign(std::move(key), std::move(parsedFile));
                     }
                 }
-                catch (const std::exception& error) {
-                    logger.warn("Error processing file {}: {}", filePath.filename().string(), error.what());
+
+                filesProcessed++;
+
+                // Log progress periodically
+                if (filesProcessed % 100 == 0) {
+                    logger.info("  Processed {}/{} files ({} buildings found so far)",
+                                filesProcessed, fileToExemplarTgis.size(), buildingsFound);
+                }
+            }
+            parseWorkers.clear();
+            fileResults.clear();
+            flushThumbnails();
+
+            logger.info("Parsed {} exemplars, reused {} from the parse cache", recordsParsed, recordsReused);
+            // Decoding the skipped exemplars would have cost about as much as the average full load
+            const auto classifyMs = std::chrono::duration<double, std::milli>(classCounts.classifyTime).count();
+            const auto fullLoadMs = std::chrono::duration<double, std::milli>(classCounts.fullLoadTime).count();
+            const auto avoidedMs = classCounts.fullLoads == 0
+                ? 0.0
+                : fullLoadMs / static_cast<double>(classCounts.fullLoads)
+                    * static_cast<double>(classCounts.skipped);
+            logger.info("Classified exemplars: {} buildings, {} lot configs, {} props, {} flora, {} skipped, "
+                        "{} decoded to classify", classCounts.buildings, classCounts.lotConfigs, classCounts.props,
+                        classCounts.flora, classCounts.skipped, classCounts.undecided);
+            logger.debug("Classification took {:.1f} ms; estimated saving {:.1f} ms of full loads, assuming skipped "
+                         "exemplars cost the average of {} loads ({:.1f} ms)",
+                         classifyMs, avoidedMs - classifyMs, classCounts.fullLoads, fullLoadMs);
+            if (metrics) {
+                metrics->recordEstimate("classificationSavings", avoidedMs - classifyMs,
+                                        "skipped exemplars times the average full load, less classification time");
+            }
+            const auto cohortStats = parser.cohortViewStats();
+            logger.debug("Cohort views: {} chains flattened from {} cohorts, {} hits, {} cycles",
+                         cohortStats.chainsFlattened, cohortStats.cohortsLoaded, cohortStats.viewHits,
+                         cohortStats.cyclesDetected);
+            const auto boundsStats = parser.modelBoundsStats();
+            logger.debug("Model bounds: {} models read, {} from vertices alone, {} lookups shared",
+                         boundsStats.modelsLoaded, boundsStats.fromVertices, boundsStats.hits);
+            const auto textStats = parser.localizedTextStats();
+            logger.debug("Localized text: {} entries decoded ahead, {} on demand, {} lookups shared",
+                         textStats.prefetched, textStats.textsDecoded, textStats.hits);
+            previousParseCache.clear();
+            phaseTimer.reset();
+            if (metrics) {
+                metrics->addItems(ScanPhase::ExemplarPass, recordsParsed + recordsReused);
+                metrics->addBytesRead(ScanPhase::ExemplarPass,
+                                      indexService.readerCacheStats().bytesOpened - bytesOpenedBefore);
+            }
+
+            {
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                if (!parseCacheWriter.commit()) {
+                    logger.warn("Could not save parse cache, the next scan will parse everything again");
+                }
+                else {
+                    RecordWrite(metrics.get(), parseCachePath);
                 }
             }
 
             fileToExemplarTgis.clear();
             seenPropKeys.clear();
 
+            phaseTimer.emplace(metrics.get(), ScanPhase::LotConfigPass);
+
             // Build family-to-buildings map for resolving growable lot references
             std::unordered_map<uint32_t, std::vector<uint32_t>> familyToBuildingsMap;
-            for (const auto& [instanceId, building] : buildingMap) {
-                for (uint32_t familyId : building.familyIds) {
+            for (const auto& [instanceId, familyIds] : buildingFamilyIds) {
+                for (uint32_t familyId : familyIds) {
                     familyToBuildingsMap[familyId].push_back(instanceId);
                 }
             }
 
-            for (const auto& [filePath, tgi] : lotConfigTgis) {
-                try {
-                    auto* reader = indexService.getReader(filePath);
-                    if (!reader) {
-                        continue;
+            for (const auto& [lot, buildingReference] : pendingLots) {
+                const auto resolved = ExemplarParser::resolveLotBuilding(buildingReference, buildingFamilyIds,
+                                                                         familyToBuildingsMap);
+                // Get building for this lot
+                auto buildingIt = builtBuildings.find(resolved.buildingInstanceId);
+                if (buildingIt != builtBuildings.end()) {
+                    if (resolved.isFamilyReference) {
+                        logger.trace("  Lot: {} (0x{:08X}) [family 0x{:08X} -> building 0x{:08X}]",
+                                     lot.name, lot.instanceId.get(),
+                                     resolved.buildingFamilyId, resolved.buildingInstanceId);
                     }
-
-                    auto exemplarResult = reader->LoadExemplar(tgi);
-                    if (!exemplarResult.has_value()) {
-                        continue;
+                    else {
+                        logger.trace("  Lot: {} (0x{:08X})", lot.name, lot.instanceId.get());
                     }
-
-                    if (auto parsedLot = parser.
-                        parseLotConfig(*exemplarResult, tgi, buildingMap, familyToBuildingsMap)) {
-                        // Get building for this lot
-                        auto buildingIt = builtBuildings.find(parsedLot->buildingInstanceId);
-                        if (buildingIt != builtBuildings.end()) {
-                            Lot lot = parser.lotFromParsed(*parsedLot);
-                            if (parsedLot->isFamilyReference) {
-                                logger.trace("  Lot: {} (0x{:08X}) [family 0x{:08X} -> building 0x{:08X}]",
-                                             lot.name, lot.instanceId.get(),
-                                             parsedLot->buildingFamilyId, parsedLot->buildingInstanceId);
-                            }
-                            else {
-                                logger.trace("  Lot: {} (0x{:08X})", lot.name, lot.instanceId.get());
-                            }
-                            const uint64_t lotKey = (static_cast<uint64_t>(lot.groupId.value()) << 32) |
-                                static_cast<uint64_t>(lot.instanceId.value());
-                            if (seenLotKeys.insert(lotKey).second) {
-                                buildingIt->second.lots.push_back(lot);
-                                lotsFound++;
-                            }
-                            else {
-                                logger.warn("Duplicate lot skipped: {} (group=0x{:08X}, instance=0x{:08X})",
-                                            lot.name, lot.groupId.value(), lot.instanceId.value());
-                            }
-                        }
-                        else {
-                            if (parsedLot->isFamilyReference) {
-                                logger.warn(
-                                    "  Lot {} references family 0x{:08X} but resolved building 0x{:08X} not found",
-                                    parsedLot->name, parsedLot->buildingFamilyId, parsedLot->buildingInstanceId);
-                            }
-                            else {
-                                logger.warn("  Lot {} references unknown building 0x{:08X}",
-                                            parsedLot->name, parsedLot->buildingInstanceId);
-                            }
-                            missingBuildingIds.insert(parsedLot->buildingInstanceId);
-                        }
+                    const uint64_t lotKey = (static_cast<uint64_t>(lot.groupId.value()) << 32) |
+                        static_cast<uint64_t>(lot.instanceId.value());
+                    if (seenLotKeys.insert(lotKey).second) {
+                        buildingIt->second.lots.push_back(lot);
+                        lotsFound++;
+                    }
+                    else {
+                        logger.warn("Duplicate lot skipped: {} (group=0x{:08X}, instance=0x{:08X})",
+                                    lot.name, lot.groupId.value(), lot.instanceId.value());
                     }
                 }
-                catch (const std::exception& error) {
-                    logger.debug("Error processing lot config TGI {}/{}/{}: {}",
-                                 tgi.type, tgi.group, tgi.instance, error.what());
-                    parseErrors++;
+                else {
+                    if (resolved.isFamilyReference) {
+                        logger.warn(
+                            "  Lot {} references family 0x{:08X} but resolved building 0x{:08X} not found",
+                            lot.name, resolved.buildingFamilyId, resolved.buildingInstanceId);
+                    }
+                    else {
+                        logger.warn("  Lot {} references unknown building 0x{:08X}",
+                                    lot.name, resolved.buildingInstanceId);
+                    }
+                    missingBuildingIds.insert(resolved.buildingInstanceId);
                 }
             }
 
-            buildingMap.clear();
+            buildingFamilyIds.clear();
+            phaseTimer.reset();
+            if (metrics) {
+                metrics->addItems(ScanPhase::LotConfigPass, pendingLots.size());
+            }
 
             if (!missingBuildingIds.empty()) {
                 logger.warn("Missing building references for {} lots:", missingBuildingIds.size());
             }
 
-            // Collect buildings that actually have lots
-            for (auto& [instanceId, building] : builtBuildings) {
-                if (!building.lots.empty()) {
-                    allBuildings.push_back(std::move(building));
+            // Outputs written by this run; the plugin index is only saved when all of them succeed
+            std::vector<std::string> writtenOutputs;
+            bool exportFailed = false;
+
+            // Write out the buildings that actually have lots
+            CatalogWriter lotsWriter(config.userPluginsRoot / "lots.cbor");
+            std::unordered_set<uint64_t> exportedBuildingKeys;
+            try {
+                lotsWriter.beginArray();
+                for (auto& building : builtBuildings | std::views::values) {
+                    if (building.lots.empty()) {
+                        continue;
+                    }
+                    exportedBuildingKeys.insert(MakeGIKey(building.groupId.value(), building.instanceId.value()));
+                    sanitizedFields += SanitizeStrings(building);
+                    ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                    lotsWriter.append(building);
                 }
+                lotsWriter.endArray();
+            }
+            catch (const std::exception& error) {
+                logger.error("Error exporting lot configs: {}", error.what());
+                lotsWriter.discard();
+                exportedBuildingKeys.clear();
+                exportFailed = true;
             }
 
             builtBuildings.clear();
 
             logger.info("Scan complete: {} buildings with lots, {} lots, {} parse errors",
-                        allBuildings.size(), lotsFound, parseErrors);
-
-            SanitizeStrings(allBuildings, allProps);
-
-            for (const auto& prop : allProps) {
-                for (const auto& familyIdHex : prop.familyIds) {
-                    const uint32_t familyId = familyIdHex.value();
-                    if (familyId == 0) {
-                        continue;
-                    }
+                        exportedBuildingKeys.size(), lotsFound, parseErrors);
+            if (const auto renderStats = parser.renderCacheStats(); renderStats.requests > 0) {
+                logger.info("Thumbnails: rendered {} models for {} exemplars ({:.1f}% deduplicated), {} evicted, "
+                            "{} renderer",
+                            renderStats.renders, renderStats.requests,
+                            100.0 * static_cast<double>(renderStats.hits) / static_cast<double>(renderStats.requests),
+                            renderStats.evictions,
+                            RenderBackendName(parser.renderBackend().value_or(options.renderBackend)));
+            }
+            if (const auto textureStats = parser.textureCacheStats(); textureStats.requests > 0) {
+                logger.info("Textures: decoded {} for {} material lookups ({:.1f}% shared), {} evicted",
+                            textureStats.requests - textureStats.hits, textureStats.requests,
+                            100.0 * static_cast<double>(textureStats.hits) / static_cast<double>(textureStats.requests),
+                            textureStats.evictions);
+            }
+            if (renderCache) {
+                parser.setRenderCache(nullptr);
+                renderCache->close();
+                const auto& cacheStats = renderCache->stats();
+                logger.info("Render cache: {} reused, {} rendered and stored, {} entries", cacheStats.hits,
+                            cacheStats.stored, cacheStats.entries);
+            }
 
-                    if (propFamilyNamesById.contains(familyId)) {
-                        continue;
-                    }
+            if (sanitizedFields > 0) {
+                logger.warn("Sanitized {} invalid UTF-8 fields before writing output", sanitizedFields);
+            }
 
-                    std::string displayName;
-                    if (const auto it = kBuiltinPropFamilyNames.find(familyId); it != kBuiltinPropFamilyNames.end()) {
-                        displayName = std::string(it->second);
-                    }
-                    else {
-                        char buf[32];
-                        std::snprintf(buf, sizeof(buf), "Family 0x%08X", familyId);
-                        displayName = buf;
-                    }
+            for (const uint32_t familyId : referencedPropFamilyIds) {
+                if (propFamilyNamesById.contains(familyId)) {
+                    continue;
+                }
 
-                    propFamilyNamesById.emplace(familyId, std::move(displayName));
+                std::string displayName;
+                if (const auto it = kBuiltinPropFamilyNames.find(familyId); it != kBuiltinPropFamilyNames.end()) {
+                    displayName = std::string(it->second);
+                }
+                else {
+                    char buf[32];
+                    std::snprintf(buf, sizeof(buf), "Family 0x%08X", familyId);
+                    displayName = buf;
                 }
+
+                propFamilyNamesById.emplace(familyId, std::move(displayName));
             }
 
             std::vector<PropFamilyInfo> propFamilies;
@@ -541,142 +1422,156 @@ namespace {
                 return a.familyId.value() < b.familyId.value();
             });
 
-            // Extract building thumbnails into a sidecar binary file, then strip them
-            // from allBuildings so the CBOR stays lean.
-            {
-                std::vector<std::pair<uint64_t, Thumbnail>> buildingThumbnails;
-                for (auto& b : allBuildings) {
-                    if (b.thumbnail.has_value()) {
-                        const uint64_t key = MakeGIKey(b.groupId.value(), b.instanceId.value());
-                        buildingThumbnails.emplace_back(key, std::move(*b.thumbnail));
-                        b.thumbnail.reset();
-                    }
+            const auto exportThumbnails = [&](ThumbnailBin::Spool& spool, const char* fileName, const char* kind) {
+                const auto count = spool.size();
+                if (count == 0) {
+                    spool.discard();
+                    return;
                 }
-                if (!buildingThumbnails.empty()) {
-                    NormalizeThumbnailEntries(buildingThumbnails, thumbnailSize);
-                    const auto binPath = config.userPluginsRoot / "lot_thumbnails.bin";
-                    const auto count = buildingThumbnails.size();
-                    ThumbnailBin::Write(binPath, std::move(buildingThumbnails));
-                    logger.info("Exported {} building thumbnails to {}", count, binPath.string());
+                const auto binPath = config.userPluginsRoot / fileName;
+                {
+                    ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                    if (!spool.finish()) {
+                        logger.error("Failed to write thumbnails to {}", binPath.string());
+                        exportFailed = true;
+                        return;
+                    }
                 }
-            }
+                RecordWrite(metrics.get(), binPath);
+                writtenOutputs.emplace_back(fileName);
+                logger.info("Exported {} {} thumbnails to {}", count, kind, binPath.string());
+            };
 
-            // Export grouped building/lot data to CBOR file in user plugins directory
-            if (!allBuildings.empty()) {
-                try {
-                    auto cborPath = config.userPluginsRoot / "lots.cbor";
-                    fs::create_directories(config.userPluginsRoot);
+            // Moves a finished catalog into place; returns false if it could not be written
+            const auto commitCatalog = [&](CatalogWriter& writer, const char* fileName) {
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                if (!writer.commit()) {
+                    logger.error("Failed to write {}", writer.path().string());
+                    exportFailed = true;
+                    return false;
+                }
+                RecordWrite(metrics.get(), writer.path());
+                writtenOutputs.emplace_back(fileName);
+                return true;
+            };
 
-                    logger.info("Exporting {} buildings ({} lots) to {}", allBuildings.size(), lotsFound,
-                                cborPath.string());
+            // Drop the thumbnails of buildings that ended up without lots
+            buildingThumbnails.retainIf([&](const uint64_t key) { return exportedBuildingKeys.contains(key); });
+            exportThumbnails(buildingThumbnails, "lot_thumbnails.bin", "building");
 
-                    if (std::ofstream file(cborPath, std::ios::binary); !file) {
-                        logger.error("Failed to open file for writing: {}", cborPath.string());
-                    }
-                    else {
-                        rfl::cbor::write(allBuildings, file);
-                        file.close();
-                        logger.info("Successfully exported lot configs");
-                    }
-                }
-                catch (const std::exception& error) {
-                    logger.error("Error exporting lot configs: {}", error.what());
+            if (!exportedBuildingKeys.empty()) {
+                logger.info("Exporting {} buildings ({} lots) to {}", exportedBuildingKeys.size(), lotsFound,
+                            lotsWriter.path().string());
+                if (commitCatalog(lotsWriter, "lots.cbor")) {
+                    logger.info("Successfully exported lot configs");
                 }
             }
-
-            // Extract prop thumbnails into a sidecar binary file, then strip them.
-            {
-                std::vector<std::pair<uint64_t, Thumbnail>> propThumbnails;
-                for (auto& p : allProps) {
-                    if (p.thumbnail.has_value()) {
-                        const uint64_t key = MakeGIKey(p.groupId.value(), p.instanceId.value());
-                        propThumbnails.emplace_back(key, std::move(*p.thumbnail));
-                        p.thumbnail.reset();
-                    }
-                }
-                if (!propThumbnails.empty()) {
-                    NormalizeThumbnailEntries(propThumbnails, thumbnailSize);
-                    const auto binPath = config.userPluginsRoot / "prop_thumbnails.bin";
-                    const auto count = propThumbnails.size();
-                    ThumbnailBin::Write(binPath, std::move(propThumbnails));
-                    logger.info("Exported {} prop thumbnails to {}", count, binPath.string());
-                }
+            else {
+                lotsWriter.discard();
             }
 
-            if (!allProps.empty() || !propFamilies.empty()) {
-                try {
-                    auto cborPath = config.userPluginsRoot / "props.cbor";
-                    fs::create_directories(config.userPluginsRoot);
-
-                    PropsCache propsCache;
-                    propsCache.props = std::move(allProps);
-                    propsCache.propFamilies = std::move(propFamilies);
+            exportThumbnails(propThumbnails, "prop_thumbnails.bin", "prop");
 
+            try {
+                const auto propCount = propsWriter.endArray();
+                if (propCount > 0 || !propFamilies.empty()) {
                     logger.info("Exporting {} props and {} prop families to {}",
-                                propsCache.props.size(), propsCache.propFamilies.size(), cborPath.string());
-
-                    if (std::ofstream file(cborPath, std::ios::binary); !file) {
-                        logger.error("Failed to open file for writing: {}", cborPath.string());
-                    }
-                    else {
-                        rfl::cbor::write(propsCache, file);
-                        file.close();
+                                propCount, propFamilies.size(), propsWriter.path().string());
+                    propsWriter.field("propFamilies", propFamilies);
+                    if (commitCatalog(propsWriter, "props.cbor")) {
                         logger.info("Successfully exported props");
                     }
                 }
-                catch (const std::exception& error) {
-                    logger.error("Error exporting props: {}", error.what());
+                else {
+                    propsWriter.discard();
                 }
             }
+            catch (const std::exception& error) {
+                logger.error("Error exporting props: {}", error.what());
+                propsWriter.discard();
+                exportFailed = true;
+            }
 
-            // Extract flora thumbnails into a sidecar binary file, then strip them.
-            {
-                std::vector<std::pair<uint64_t, Thumbnail>> floraThumbnails;
-                for (auto& f : allFlora) {
-                    if (f.thumbnail.has_value()) {
-                        const uint64_t key = MakeGIKey(f.groupId.value(), f.instanceId.value());
-                        floraThumbnails.emplace_back(key, std::move(*f.thumbnail));
-                        f.thumbnail.reset();
+            exportThumbnails(floraThumbnails, "flora_thumbnails.bin", "flora");
+
+            try {
+                if (const auto floraCount = floraWriter.endArray(); floraCount > 0) {
+                    logger.info("Exporting {} flora items to {}", floraCount, floraWriter.path().string());
+                    floraWriter.field("floraFamilies", FloraCache{}.floraFamilies);
+                    if (commitCatalog(floraWriter, "flora.cbor")) {
+                        logger.info("Successfully exported flora");
                     }
                 }
-                if (!floraThumbnails.empty()) {
-                    NormalizeThumbnailEntries(floraThumbnails, thumbnailSize);
-                    const auto binPath = config.userPluginsRoot / "flora_thumbnails.bin";
-                    const auto count = floraThumbnails.size();
-                    ThumbnailBin::Write(binPath, std::move(floraThumbnails));
-                    logger.info("Exported {} flora thumbnails to {}", count, binPath.string());
+                else {
+                    floraWriter.discard();
                 }
             }
+            catch (const std::exception& error) {
+                logger.error("Error exporting flora: {}", error.what());
+                floraWriter.discard();
+                exportFailed = true;
+            }
 
-            if (!allFlora.empty()) {
-                try {
-                    auto cborPath = config.userPluginsRoot / "flora.cbor";
-                    fs::create_directories(config.userPluginsRoot);
-
-                    FloraCache floraCache;
-                    floraCache.floraItems = std::move(allFlora);
-
-                    logger.info("Exporting {} flora items to {}", floraCache.floraItems.size(), cborPath.string());
-
-                    if (std::ofstream file(cborPath, std::ios::binary); !file) {
-                        logger.error("Failed to open file for writing: {}", cborPath.string());
-                    }
-                    else {
-                        rfl::cbor::write(floraCache, file);
-                        file.close();
-                        logger.info("Successfully exported flora");
-                    }
+            if (!exportFailed) {
+                auto pluginIndex = indexService.exportIndex();
+                pluginIndex.cacheSignature = cacheSignature;
+                pluginIndex.outputs = std::move(writtenOutputs);
+                ScanMetrics::Timer writeTimer(metrics.get(), ScanPhase::Writes);
+                if (SavePluginIndex(indexPath, pluginIndex)) {
+                    RecordWrite(metrics.get(), indexPath);
+                    logger.info("Saved plugin index ({} files) to {}", pluginIndex.files.size(), indexPath.string());
                 }
-                catch (const std::exception& error) {
-                    logger.error("Error exporting flora: {}", error.what());
+                if (warm) {
+                    warm->pluginIndex = std::move(pluginIndex);
                 }
             }
+            else {
+                logger.warn("Not saving plugin index because some caches failed to export");
+                if (warm) {
+                    *warm = {};
+                }
+            }
+
+            const auto readerStats = indexService.readerCacheStats();
+            logger.info("Reader cache: {} hits, {} misses, {} evictions, peak {} MiB open",
+                        readerStats.hits, readerStats.misses, readerStats.evictions,
+                        readerStats.peakOpenBytes / (1024 * 1024));
 
             // Shutdown the indexing service
             indexService.shutdown();
+            writeMetrics();
         }
         catch (const std::exception& error) {
             logger.error("Error during exemplar scan: {}", error.what());
+            if (warm) {
+                *warm = {};
+            }
+            phaseTimer.reset();
+            writeMetrics();
+        }
+    }
+
+    // Scans, then stays resident and rescans whenever plugins are added, changed or removed. The plugin
+    // index and parse cache stay in memory between scans, so a rescan only indexes and parses the files
+    // that changed, and the caches are replaced atomically for the DLL to pick up.
+    void WatchAndRescan(const PluginConfiguration& config, spdlog::logger& logger, ScanOptions options) {
+        std::error_code ec;
+        fs::create_directories(config.userPluginsRoot, ec);
+
+        // Watching starts before the first scan, so plugins copied in while it runs are not missed
+        PluginWatcher watcher(config, kWatchPollInterval);
+        WarmScanState warm;
+        ScanAndAnalyzeExemplars(config, logger, options, &warm);
+        options.forceRescan = false;
+
+        while (true) {
+            logger.info("Watching for plugin changes ({})...", watcher.usesInotify() ? "inotify" : "polling");
+            const auto changed = watcher.waitForChanges(kWatchDebounce);
+            logger.info("{} plugin files or folders changed, rescanning", changed.size());
+            for (const auto& path : changed) {
+                logger.debug("  {}", path.string());
+            }
+            ScanAndAnalyzeExemplars(config, logger, options, &warm);
         }
     }
 } // namespace
@@ -706,6 +1601,41 @@ int main(int argc, char* argv[]) {
             "px",
             "Square thumbnail size in pixels for cached thumbnails (22-176, default 44)",
             {"thumbnail-size"});
+        args::ValueFlag<std::string> rendererFlag(
+            parser,
+            "backend",
+            "Thumbnail renderer: gpu (default; falls back to cpu without a display) or cpu (multi-threaded, headless)",
+            {"renderer"});
+        args::ValueFlag<uint32_t> indexThreadsFlag(
+            parser,
+            "n",
+            "Number of threads used to index plugin files (default: one per CPU core)",
+            {"index-threads"});
+        args::ValueFlag<uint32_t> parseThreadsFlag(
+            parser,
+            "n",
+            "Number of threads used to parse exemplars (default: one per CPU core)",
+            {"parse-threads"});
+        args::ValueFlag<uint32_t> readerCacheMbFlag(
+            parser,
+            "MiB",
+            "Combined size of plugin files kept open between lookups (default 512)",
+            {"reader-cache-mb"});
+        args::ValueFlag<uint32_t> readerCacheFilesFlag(
+            parser,
+            "n",
+            "Number of plugin files kept open between lookups (default 256)",
+            {"reader-cache-files"});
+        args::Flag forceFlag(parser, "force", "Rebuild all caches even if no plugins changed since the last scan",
+                             {"force"});
+        args::Flag watchFlag(parser, "watch",
+                             "Keep running after the scan and rescan whenever plugins are added, changed or removed",
+                             {"watch"});
+        args::ValueFlag<std::string> metricsOutFlag(
+            parser,
+            "path",
+            "Write per-phase timings, memory and the slowest files and models of the scan to a JSON file",
+            {"metrics-out"});
 
         try {
             parser.ParseCLI(argc, argv);
@@ -728,9 +1658,11 @@ int main(int argc, char* argv[]) {
             return 0;
         }
 
-        if (scanFlag) {
+        if (scanFlag || watchFlag) {
             auto config = GetDefaultPluginConfiguration();
-            uint32_t thumbnailSize = kDefaultThumbnailSize;
+            ScanOptions options;
+            options.renderModelThumbnails = renderThumbnailsFlag;
+            options.forceRescan = forceFlag;
 
             // Override with command-line arguments if provided
             if (gameFlag) {
@@ -744,12 +1676,35 @@ int main(int argc, char* argv[]) {
                 config.userPluginsRoot = args::get(pluginsFlag);
             }
             if (thumbnailSizeFlag) {
-                thumbnailSize = args::get(thumbnailSizeFlag);
-                if (thumbnailSize < kMinThumbnailSize || thumbnailSize > kMaxThumbnailSize) {
+                options.thumbnailSize = args::get(thumbnailSizeFlag);
+                if (options.thumbnailSize < kMinThumbnailSize || options.thumbnailSize > kMaxThumbnailSize) {
                     logger->error("Invalid --thumbnail-size {}. Expected a value between {} and {}.",
-                                  thumbnailSize, kMinThumbnailSize, kMaxThumbnailSize);
+                                  options.thumbnailSize, kMinThumbnailSize, kMaxThumbnailSize);
+                    return 1;
+                }
+            }
+            if (rendererFlag) {
+                const auto backend = ParseRenderBackend(args::get(rendererFlag));
+                if (!backend) {
+                    logger->error("Invalid --renderer {}. Expected gpu or cpu.", args::get(rendererFlag));
                     return 1;
                 }
+                options.renderBackend = *backend;
+            }
+            if (indexThreadsFlag) {
+                options.indexThreads = args::get(indexThreadsFlag);
+            }
+            if (parseThreadsFlag) {
+                options.parseThreads = args::get(parseThreadsFlag);
+            }
+            if (readerCacheMbFlag) {
+                options.readerCache.maxBytes = static_cast<uint64_t>(args::get(readerCacheMbFlag)) * 1024 * 1024;
+            }
+            if (readerCacheFilesFlag) {
+                options.readerCache.maxReaders = args::get(readerCacheFilesFlag);
+            }
+            if (metricsOutFlag) {
+                options.metricsOut = args::get(metricsOutFlag);
             }
 
             logger->info("Using plugin configuration:");
@@ -757,12 +1712,26 @@ int main(int argc, char* argv[]) {
             logger->info("  Game Locale: {}", (config.gameRoot / config.localeDir).string());
             logger->info("  Game Plugins: {}", config.gamePluginsRoot.string());
             logger->info("  User Plugins: {}", config.userPluginsRoot.string());
-            logger->info("  Thumbnail Size: {} px", thumbnailSize);
+            logger->info("  Thumbnail Size: {} px", options.thumbnailSize);
+            if (options.indexThreads > 0) {
+                logger->info("  Index Threads: {}", options.indexThreads);
+            }
+            if (options.parseThreads > 0) {
+                logger->info("  Parse Threads: {}", options.parseThreads);
+            }
+            logger->info("  Reader Cache: {} files / {} MiB", options.readerCache.maxReaders,
+                         options.readerCache.maxBytes / (1024 * 1024));
 
-            if (renderThumbnailsFlag) {
-                logger->info("3D thumbnail rendering enabled");
+            if (options.renderModelThumbnails) {
+                logger->info("3D thumbnail rendering enabled ({} renderer)", RenderBackendName(options.renderBackend));
+            }
+            logger->debug("Pixel kernels: {}", thumb::PixelIsaName(thumb::PixelKernels::isa()));
+            if (watchFlag) {
+                WatchAndRescan(config, *logger, options);
+            }
+            else {
+                ScanAndAnalyzeExemplars(config, *logger, options);
             }
-            ScanAndAnalyzeExemplars(config, *logger, renderThumbnailsFlag, thumbnailSize);
             return 0;
         }
 
@@ -0,0 +1,251 @@
+#include <PixelKernels.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using thumb::PixelIsa;
+using thumb::PixelKernels;
+
+namespace {
+    std::vector<uint8_t> RandomPixels(const size_t pixelCount, const uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::vector<uint8_t> pixels(pixelCount * 4);
+        for (auto& value : pixels) {
+            value = static_cast<uint8_t>(byte(rng));
+        }
+        return pixels;
+    }
+
+    // Instruction sets the CPU running the tests supports, scalar first
+    std::vector<PixelIsa> SupportedIsas() {
+        std::vector<PixelIsa> isas;
+        for (const auto isa : {PixelIsa::Scalar, PixelIsa::Sse2, PixelIsa::Avx2}) {
+            if (isa <= PixelKernels::supportedIsa()) {
+                isas.push_back(isa);
+            }
+        }
+        return isas;
+    }
+
+    // Restores the default instruction set when a test ends
+    struct IsaGuard {
+        ~IsaGuard() { PixelKernels::setIsa(PixelKernels::supportedIsa()); }
+    };
+
+    // Pixel counts that cover empty input, vector tails and several full vectors
+    constexpr size_t kPixelCounts[] = {0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 64, 1001};
+}
+
+TEST_CASE("swapRedBlue swaps the first and third channel", "[pixels]") {
+    IsaGuard guard;
+    const std::vector<uint8_t> source{1, 2, 3, 4, 10, 20, 30, 40};
+    for (const auto isa : SupportedIsas()) {
+        PixelKernels::setIsa(isa);
+        std::vector<uint8_t> swapped(source.size());
+        PixelKernels::swapRedBlue(source.data(), swapped.data(), 2);
+        REQUIRE(swapped == std::vector<uint8_t>{3, 2, 1, 4, 30, 20, 10, 40});
+    }
+}
+
+TEST_CASE("swapRedBlue matches the scalar kernel in and out of place", "[pixels]") {
+    IsaGuard guard;
+    for (const size_t count : kPixelCounts) {
+        const auto source = RandomPixels(count, static_cast<uint32_t>(count));
+        PixelKernels::setIsa(PixelIsa::Scalar);
+        std::vector<uint8_t> expected(source.size());
+        PixelKernels::swapRedBlue(source.data(), expected.data(), count);
+
+        for (const auto isa : SupportedIsas()) {
+            PixelKernels::setIsa(isa);
+            std::vector<uint8_t> actual(source.size());
+            PixelKernels::swapRedBlue(source.data(), actual.data(), count);
+            REQUIRE(actual == expected);
+
+            auto inPlace = source;
+            PixelKernels::swapRedBlue(inPlace.data(), inPlace.data(), count);
+            REQUIRE(inPlace == expected);
+        }
+    }
+}
+
+TEST_CASE("blendOverlay matches the scalar kernel", "[pixels]") {
+    IsaGuard guard;
+    for (const size_t count : kPixelCounts) {
+        const auto base = RandomPixels(count, 100 + static_cast<uint32_t>(count));
+        const auto overlay = RandomPixels(count, 200 + static_cast<uint32_t>(count));
+        PixelKernels::setIsa(PixelIsa::Scalar);
+        auto expected = base;
+        PixelKernels::blendOverlay(expected.data(), overlay.data(), count);
+
+        for (const auto isa : SupportedIsas()) {
+            PixelKernels::setIsa(isa);
+            auto actual = base;
+            PixelKernels::blendOverlay(actual.data(), overlay.data(), count);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("blendOverlay matches the scalar kernel for every base, overlay and alpha", "[pixels]") {
+    IsaGuard guard;
+    constexpr size_t pixelCount = 256 * 256;
+    std::vector<uint8_t> base(pixelCount * 4);
+    std::vector<uint8_t> overlay(pixelCount * 4);
+    for (int alpha = 0; alpha < 256; ++alpha) {
+        for (size_t i = 0; i < pixelCount; ++i) {
+            base[i * 4 + 0] = static_cast<uint8_t>(i);
+            base[i * 4 + 1] = static_cast<uint8_t>(i >> 8);
+            base[i * 4 + 2] = static_cast<uint8_t>(i + 85);
+            base[i * 4 + 3] = static_cast<uint8_t>(i >> 8);
+            overlay[i * 4 + 0] = static_cast<uint8_t>(i >> 8);
+            overlay[i * 4 + 1] = static_cast<uint8_t>(i);
+            overlay[i * 4 + 2] = static_cast<uint8_t>((i >> 8) + 170);
+            overlay[i * 4 + 3] = static_cast<uint8_t>(alpha);
+        }
+        PixelKernels::setIsa(PixelIsa::Scalar);
+        auto expected = base;
+        PixelKernels::blendOverlay(expected.data(), overlay.data(), pixelCount);
+
+        for (const auto isa : SupportedIsas()) {
+            PixelKernels::setIsa(isa);
+            auto actual = base;
+            PixelKernels::blendOverlay(actual.data(), overlay.data(), pixelCount);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("blendOverlay covers the base by the overlay alpha and keeps the larger alpha", "[pixels]") {
+    IsaGuard guard;
+    for (const auto isa : SupportedIsas()) {
+        PixelKernels::setIsa(isa);
+        std::vector<uint8_t> base{200, 100, 50, 255, 200, 100, 50, 10};
+        const std::vector<uint8_t> overlay{10, 20, 30, 0, 10, 20, 30, 255};
+        PixelKernels::blendOverlay(base.data(), overlay.data(), 2);
+        REQUIRE(base == std::vector<uint8_t>{200, 100, 50, 255, 10, 20, 30, 255});
+    }
+}
+
+TEST_CASE("findAlphaBounds matches the scalar kernel", "[pixels]") {
+    IsaGuard guard;
+    std::mt19937 rng(7);
+    for (const int width : {1, 3, 4, 5, 8, 9, 17, 40}) {
+        for (const int height : {1, 2, 13}) {
+            for (int trial = 0; trial < 20; ++trial) {
+                std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4, 0);
+                // A few visible pixels at random places, and faint ones below the threshold
+                std::uniform_int_distribution<int> pick(0, width * height - 1);
+                for (int i = 0; i < trial % 4; ++i) {
+                    pixels[static_cast<size_t>(pick(rng)) * 4 + 3] = 200;
+                }
+                pixels[static_cast<size_t>(pick(rng)) * 4 + 3] = 11;
+
+                PixelKernels::setIsa(PixelIsa::Scalar);
+                const auto expected = PixelKernels::findAlphaBounds(pixels.data(), width, height, 12);
+                for (const auto isa : SupportedIsas()) {
+                    PixelKernels::setIsa(isa);
+                    const auto actual = PixelKernels::findAlphaBounds(pixels.data(), width, height, 12);
+                    REQUIRE(actual.has_value() == expected.has_value());
+                    if (expected) {
+                        REQUIRE(actual->minX == expected->minX);
+                        REQUIRE(actual->minY == expected->minY);
+                        REQUIRE(actual->maxX == expected->maxX);
+                        REQUIRE(actual->maxY == expected->maxY);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("findAlphaBounds boxes the visible pixels", "[pixels]") {
+    IsaGuard guard;
+    constexpr int width = 19;
+    constexpr int height = 6;
+    std::vector<uint8_t> pixels(width * height * 4, 0);
+    pixels[(1 * width + 15) * 4 + 3] = 12;
+    pixels[(4 * width + 2) * 4 + 3] = 255;
+    pixels[(5 * width + 18) * 4 + 3] = 11;
+
+    for (const auto isa : SupportedIsas()) {
+        PixelKernels::setIsa(isa);
+        const auto bounds = PixelKernels::findAlphaBounds(pixels.data(), width, height, 12);
+        REQUIRE(bounds.has_value());
+        REQUIRE(bounds->minX == 2);
+        REQUIRE(bounds->minY == 1);
+        REQUIRE(bounds->maxX == 15);
+        REQUIRE(bounds->maxY == 4);
+
+        const auto opaque = PixelKernels::findAlphaBounds(pixels.data(), width, height, 255);
+        REQUIRE(opaque.has_value());
+        REQUIRE(opaque->minX == 2);
+        REQUIRE(opaque->maxX == 2);
+        REQUIRE(opaque->minY == 4);
+        REQUIRE(opaque->maxY == 4);
+
+        const std::vector<uint8_t> empty(width * height * 4, 0);
+        REQUIRE_FALSE(PixelKernels::findAlphaBounds(empty.data(), width, height, 1).has_value());
+    }
+}
+
+TEST_CASE("resizeArea matches the scalar kernel", "[pixels]") {
+    IsaGuard guard;
+    const auto source = RandomPixels(37 * 23, 99);
+    for (const auto& [width, height] : {std::pair{37u, 23u}, std::pair{18u, 11u}, std::pair{80u, 50u},
+                                        std::pair{1u, 1u}, std::pair{9u, 40u}, std::pair{12u, 7u}}) {
+        const size_t stride = static_cast<size_t>(width + 3) * 4;
+        PixelKernels::setIsa(PixelIsa::Scalar);
+        std::vector<uint8_t> expected(stride * height, 0xCD);
+        PixelKernels::resizeArea(source.data(), 37, 23, expected.data(), width, height, stride);
+
+        for (const auto isa : SupportedIsas()) {
+            PixelKernels::setIsa(isa);
+            std::vector<uint8_t> actual(expected.size(), 0xCD);
+            PixelKernels::resizeArea(source.data(), 37, 23, actual.data(), width, height, stride);
+            REQUIRE(actual == expected);
+        }
+    }
+}
+
+TEST_CASE("resizeArea averages the covered pixels by alpha", "[pixels]") {
+    IsaGuard guard;
+    // An opaque red and a transparent white pixel above two opaque blue ones
+    const std::vector<uint8_t> source{
+        255, 0, 0, 255,   255, 255, 255, 0,
+        0, 0, 255, 255,   0, 0, 255, 255,
+    };
+    for (const auto isa : SupportedIsas()) {
+        PixelKernels::setIsa(isa);
+        std::vector<uint8_t> resized(4);
+        PixelKernels::resizeArea(source.data(), 2, 2, resized.data(), 1, 1, 4);
+        // The transparent pixel lends no colour, only its share of the coverage
+        REQUIRE(resized == std::vector<uint8_t>{85, 0, 170, 191});
+
+        std::vector<uint8_t> column(2 * 4);
+        PixelKernels::resizeArea(source.data(), 2, 2, column.data(), 1, 2, 4);
+        REQUIRE(column == std::vector<uint8_t>{255, 0, 0, 128, 0, 0, 255, 255});
+    }
+}
+
+TEST_CASE("resizeArea copies at the same size and keeps the target stride", "[pixels]") {
+    IsaGuard guard;
+    const auto source = RandomPixels(5 * 3, 5);
+    for (const auto isa : SupportedIsas()) {
+        PixelKernels::setIsa(isa);
+        std::vector<uint8_t> target(7 * 3 * 4, 0);
+        PixelKernels::resizeArea(source.data(), 5, 3, target.data() + 4, 5, 3, 7 * 4);
+        for (size_t y = 0; y < 3; ++y) {
+            const auto* row = target.data() + y * 7 * 4;
+            REQUIRE(std::vector<uint8_t>(row + 4, row + 24)
+                    == std::vector<uint8_t>(source.begin() + y * 20, source.begin() + (y + 1) * 20));
+            REQUIRE(row[0] == 0);
+            REQUIRE(row[27] == 0);
+        }
+    }
+}
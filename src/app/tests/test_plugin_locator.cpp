@@ -0,0 +1,86 @@
+#include <PluginLocator.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+    std::vector<std::string> SortedNames(std::vector<fs::path> paths) {
+        std::ranges::sort(paths, LoadOrderLess);
+        std::vector<std::string> names;
+        for (const auto& path : paths) {
+            names.push_back(path.filename().string());
+        }
+        return names;
+    }
+
+    void Touch(const fs::path& path) {
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << "DBPF";
+    }
+
+    // A fresh directory under the system temp directory, removed again when the test ends
+    struct TempDirectory {
+        TempDirectory() : path(fs::temp_directory_path() / "sc4pp_plugin_locator_test") {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+        ~TempDirectory() {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+        fs::path path;
+    };
+}
+
+TEST_CASE("LoadOrderLess sorts punctuation after the letters, like the game", "[plugin-locator]") {
+    // Folded to upper case, _ [ \ ] ^ and ` (0x5B-0x60) come after Z, while digits come before A
+    REQUIRE(SortedNames({"z___NAM.dat", "zzz_Last.dat", "Zebra.dat", "_override.dat", "[Mods].dat", "^caret.dat",
+                         "0001.dat", "9.dat", "a.dat", "B.dat"})
+        == std::vector<std::string>{"0001.dat", "9.dat", "a.dat", "B.dat", "Zebra.dat", "zzz_Last.dat",
+                                    "z___NAM.dat", "[Mods].dat", "^caret.dat", "_override.dat"});
+
+    REQUIRE(LoadOrderLess("zzz.dat", "z___NAM.dat"));
+    REQUIRE_FALSE(LoadOrderLess("z___NAM.dat", "zzz.dat"));
+    REQUIRE(LoadOrderLess("zz.dat", "z_.dat"));
+    REQUIRE(LoadOrderLess("Z.dat", "[.dat"));
+    REQUIRE(LoadOrderLess("z.dat", "^.dat"));
+}
+
+TEST_CASE("LoadOrderLess ignores case and compares only file names", "[plugin-locator]") {
+    REQUIRE_FALSE(LoadOrderLess("ABC.dat", "abc.dat"));
+    REQUIRE_FALSE(LoadOrderLess("abc.dat", "ABC.dat"));
+    REQUIRE(LoadOrderLess("abc.dat", "ABD.dat"));
+    REQUIRE(LoadOrderLess("MixedCase.dat", "mixedcasez.dat"));
+    REQUIRE(LoadOrderLess("abc", "abcd"));
+    REQUIRE(LoadOrderLess(fs::path("zzz") / "a.dat", fs::path("aaa") / "b.dat"));
+}
+
+TEST_CASE("ListDbpfFiles lists a folder's files before its subfolders", "[plugin-locator]") {
+    const TempDirectory temp;
+    const auto plugins = temp.path / "Plugins";
+    Touch(plugins / "b.dat");
+    Touch(plugins / "_Z.SC4Lot");
+    Touch(plugins / "A" / "z.dat");
+    Touch(plugins / "A" / "Nested" / "a.sc4desc");
+    Touch(plugins / "A" / "c.dat");
+    Touch(plugins / "_Overrides" / "a.dat");
+    Touch(plugins / "notes.txt");
+
+    PluginConfiguration config;
+    config.userPluginsRoot = plugins;
+    const auto files = PluginLocator(config).ListDbpfFiles();
+
+    std::vector<std::string> relative;
+    for (const auto& file : files) {
+        relative.push_back(fs::relative(file, plugins).generic_string());
+    }
+    REQUIRE(relative == std::vector<std::string>{"b.dat", "_Z.SC4Lot", "A/c.dat", "A/z.dat", "A/Nested/a.sc4desc",
+                                                 "_Overrides/a.dat"});
+}
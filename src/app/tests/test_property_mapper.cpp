@@ -0,0 +1,97 @@
+#include <PropertyMapper.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../shared/property_xml.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // IDs with and without 0x and with surrounding whitespace, decimal, hex and symbolic option values,
+    // a property whose ID does not parse, and one without a Type or Count
+    constexpr auto kPropertiesXml = R"(<?xml version="1.0"?>
+<ExemplarProperties>
+  <PROPERTIES>
+    <PROPERTY ID="0x10" Name="Exemplar Type" Type="Uint32" Count="1">
+      <OPTION Value="0x02" Name="Buildings"/>
+      <OPTION Value="30" Name="Prop"/>
+      <OPTION Value=" 0x0F " Name="Flora"/>
+      <OPTION Value="Col:0" Name="Symbolic"/>
+    </PROPERTY>
+    <PROPERTY ID="88EDC900" Name="LotConfigPropertyLotObject" Type="Uint32" Count="-1"/>
+    <PROPERTY ID=" 0x20 " Name="Exemplar Name" Type="String"/>
+    <PROPERTY ID="Item" Name="Not An ID" Type="Uint32"/>
+    <PROPERTY ID="0x05" Name="Bulldoze Cost"/>
+  </PROPERTIES>
+</ExemplarProperties>
+)";
+
+    // A fresh directory under the system temp directory, removed again when the test ends
+    struct TempDirectory {
+        TempDirectory() : path(fs::temp_directory_path() / "sc4pp_property_mapper_test") {
+            fs::remove_all(path);
+            fs::create_directories(path);
+        }
+        ~TempDirectory() {
+            std::error_code ec;
+            fs::remove_all(path, ec);
+        }
+        fs::path path;
+    };
+
+    // What tools/convert_properties writes for the XML
+    void WriteDictionary(const std::string& xml, const fs::path& path) {
+        const auto definitions = ReadPropertyXml(xml);
+        REQUIRE(definitions);
+        PropertyDictionaryBuilder builder;
+        for (const auto& definition : *definitions) {
+            builder.add(definition.id, definition.name, definition.type, definition.count, definition.options);
+        }
+        const auto bytes = builder.build();
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                                    static_cast<std::streamsize>(bytes.size()));
+    }
+}
+
+TEST_CASE("PropertyMapper reads the same properties from the XML and its compiled dictionary", "[properties]") {
+    const TempDirectory temp;
+    const auto xmlPath = temp.path / "PropertyMapper.xml";
+    const auto binaryPath = temp.path / "PropertyMapper.bin";
+    std::ofstream(xmlPath, std::ios::binary) << kPropertiesXml;
+    WriteDictionary(kPropertiesXml, binaryPath);
+
+    PropertyMapper fromXml;
+    PropertyMapper fromBinary;
+    REQUIRE(fromXml.loadFromXml(xmlPath));
+    REQUIRE(fromBinary.loadFromBinary(binaryPath));
+
+    for (const uint32_t id : {0x10u, 0x88EDC900u, 0x20u, 0x05u}) {
+        CAPTURE(id);
+        const auto xmlInfo = fromXml.propertyInfo(id);
+        const auto binaryInfo = fromBinary.propertyInfo(id);
+        REQUIRE(xmlInfo);
+        REQUIRE(binaryInfo);
+        REQUIRE(xmlInfo->name == binaryInfo->name);
+        REQUIRE(xmlInfo->type == binaryInfo->type);
+        REQUIRE(xmlInfo->count == binaryInfo->count);
+        REQUIRE(xmlInfo->optionNames_ == binaryInfo->optionNames_);
+        REQUIRE(fromXml.propertyId(xmlInfo->name) == id);
+        REQUIRE(fromBinary.propertyId(binaryInfo->name) == id);
+    }
+
+    for (const auto* mapper : {&fromXml, &fromBinary}) {
+        REQUIRE(mapper->propertyOptionId("Exemplar Type", "Buildings") == 0x02u);
+        REQUIRE(mapper->propertyOptionId("Exemplar Type", "Prop") == 30u);
+        REQUIRE(mapper->propertyOptionId("Exemplar Type", "Flora") == 0x0Fu);
+        REQUIRE_FALSE(mapper->propertyOptionId("Exemplar Type", "Symbolic"));
+        REQUIRE(mapper->propertyInfo(0x88EDC900u)->count == -1);
+        REQUIRE(mapper->propertyInfo(0x05u)->type == Exemplar::ValueType::UInt32);
+        REQUIRE(mapper->propertyInfo(0x05u)->count == 1);
+        REQUIRE_FALSE(mapper->propertyId("Not An ID"));
+        REQUIRE_FALSE(mapper->propertyInfo(0u));
+    }
+}
@@ -0,0 +1,170 @@
+#include <RenderCache.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+using thumb::ContentHash;
+using thumb::RenderCache;
+using thumb::RenderedImage;
+
+namespace fs = std::filesystem;
+
+namespace {
+    uint64_t Fnv1a(const std::string_view text) {
+        ContentHash hash;
+        hash.add(std::span(reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+        return hash.value();
+    }
+
+    RenderedImage MakeImage(const uint32_t width, const uint32_t height, const uint8_t fill) {
+        RenderedImage image;
+        image.width = width;
+        image.height = height;
+        image.pixels.assign(static_cast<size_t>(width) * height * 4, std::byte{fill});
+        return image;
+    }
+
+    std::vector<uint8_t> ReadFile(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    template<typename T>
+    T ReadLe(const std::vector<uint8_t>& bytes, const size_t offset) {
+        T value{};
+        std::memcpy(&value, bytes.data() + offset, sizeof(T));
+        return value;
+    }
+
+    // A path for a cache that does not exist yet, removed again when the test ends
+    struct TempCachePath {
+        TempCachePath() : path(fs::temp_directory_path() / "sc4pp_render_cache_test.bin") {
+            fs::remove(path);
+        }
+        ~TempCachePath() {
+            std::error_code ec;
+            fs::remove(path, ec);
+        }
+        fs::path path;
+    };
+}
+
+TEST_CASE("ContentHash is 64-bit FNV-1a", "[render-cache]") {
+    REQUIRE(ContentHash{}.value() == 0xCBF29CE484222325ull);
+    REQUIRE(Fnv1a("a") == 0xAF63DC4C8601EC8Cull);
+    REQUIRE(Fnv1a("foobar") == 0x85944171F73967E8ull);
+
+    // Integers are hashed as their 8 little-endian bytes
+    ContentHash number;
+    number.add(uint64_t{0x0807060504030201ull});
+    ContentHash bytes;
+    const uint8_t expected[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    bytes.add(expected);
+    REQUIRE(number.value() == bytes.value());
+
+    // Order matters, so a key changes when its parts move between model and textures
+    ContentHash ab;
+    ab.add(uint64_t{1});
+    ab.add(uint64_t{2});
+    ContentHash ba;
+    ba.add(uint64_t{2});
+    ba.add(uint64_t{1});
+    REQUIRE(ab.value() != ba.value());
+}
+
+TEST_CASE("RenderCache writes the documented file format", "[render-cache]") {
+    const TempCachePath temp;
+    {
+        RenderCache cache(temp.path);
+        REQUIRE(cache.isOpen());
+        cache.store(0x1122334455667788ull, MakeImage(2, 1, 0xAB), false);
+        cache.store(0x99ull, std::nullopt, false);
+        cache.close();
+    }
+
+    const auto bytes = ReadFile(temp.path);
+    // Header, one record with 2x1 pixels, one failure record without pixels
+    REQUIRE(bytes.size() == 8 + (16 + 8) + 16);
+    REQUIRE(std::memcmp(bytes.data(), "SPRC", 4) == 0);
+    REQUIRE(ReadLe<uint32_t>(bytes, 4) == 1);
+
+    REQUIRE(ReadLe<uint64_t>(bytes, 8) == 0x1122334455667788ull);
+    REQUIRE(ReadLe<uint32_t>(bytes, 16) == 2);
+    REQUIRE(ReadLe<uint32_t>(bytes, 20) == 1);
+    for (size_t i = 24; i < 32; ++i) {
+        REQUIRE(bytes[i] == 0xAB);
+    }
+
+    REQUIRE(ReadLe<uint64_t>(bytes, 32) == 0x99ull);
+    REQUIRE(ReadLe<uint32_t>(bytes, 40) == 0);
+    REQUIRE(ReadLe<uint32_t>(bytes, 44) == 0);
+}
+
+TEST_CASE("RenderCache remembers model failures but not renderer failures", "[render-cache]") {
+    const TempCachePath temp;
+    constexpr uint64_t kRendered = 1;
+    constexpr uint64_t kModelFailed = 2;
+    constexpr uint64_t kRenderFailed = 3;
+    {
+        RenderCache cache(temp.path);
+        cache.store(kRendered, MakeImage(1, 1, 7), false);
+        cache.store(kModelFailed, std::nullopt, false);
+        cache.store(kRenderFailed, std::nullopt, true);
+        REQUIRE(cache.stats().stored == 2);
+    }
+
+    RenderCache cache(temp.path);
+    REQUIRE(cache.stats().entries == 2);
+
+    const auto rendered = cache.find(kRendered);
+    REQUIRE(rendered.found);
+    REQUIRE(rendered.image);
+    REQUIRE(rendered.image->width == 1);
+    REQUIRE(rendered.image->pixels == MakeImage(1, 1, 7).pixels);
+
+    const auto modelFailed = cache.find(kModelFailed);
+    REQUIRE(modelFailed.found);
+    REQUIRE_FALSE(modelFailed.image);
+
+    // Not found, so the next scan renders it again; once it works, the image is kept
+    REQUIRE_FALSE(cache.find(kRenderFailed).found);
+    cache.store(kRenderFailed, MakeImage(1, 1, 9), true);
+    const auto retried = cache.find(kRenderFailed);
+    REQUIRE(retried.found);
+    REQUIRE(retried.image);
+}
+
+TEST_CASE("RenderCache drops a partial record at the end of the file", "[render-cache]") {
+    const TempCachePath temp;
+    {
+        RenderCache cache(temp.path);
+        cache.store(1, MakeImage(2, 2, 1), false);
+    }
+    const auto wholeSize = fs::file_size(temp.path);
+    {
+        // A record header whose pixels were never written, as an interrupted scan leaves it
+        std::ofstream file(temp.path, std::ios::binary | std::ios::app);
+        const uint64_t key = 2;
+        const uint32_t size = 64;
+        file.write(reinterpret_cast<const char*>(&key), 8);
+        file.write(reinterpret_cast<const char*>(&size), 4);
+        file.write(reinterpret_cast<const char*>(&size), 4);
+        file.write("xx", 2);
+    }
+
+    RenderCache cache(temp.path);
+    REQUIRE(cache.stats().entries == 1);
+    REQUIRE(cache.find(1).image);
+    REQUIRE_FALSE(cache.find(2).found);
+    cache.store(3, std::nullopt, false);
+    cache.close();
+    REQUIRE(fs::file_size(temp.path) == wholeSize + 16);
+}
@@ -0,0 +1,118 @@
+#include <TgiIndex.hpp>
+
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+    using Reference = std::unordered_map<DBPF::Tgi, std::vector<uint32_t>, DBPF::TgiHash>;
+
+    Reference BuildReference(const std::vector<TgiIndex::Entry>& entries) {
+        Reference reference;
+        for (const auto& entry : entries) {
+            reference[entry.tgi].push_back(entry.fileIndex);
+        }
+        return reference;
+    }
+
+    // Every key of the reference is found with the same files in the same order, and nothing else is
+    void RequireMatches(const TgiIndex& index, const Reference& reference) {
+        REQUIRE(index.size() == reference.size());
+        for (const auto& [tgi, files] : reference) {
+            const auto found = index.find(tgi);
+            REQUIRE(std::vector<uint32_t>(found.begin(), found.end()) == files);
+            REQUIRE(index.winner(tgi) == files.back());
+        }
+
+        size_t visited = 0;
+        index.forEach([&](const DBPF::Tgi& tgi, const std::span<const uint32_t> files) {
+            const auto it = reference.find(tgi);
+            REQUIRE(it != reference.end());
+            REQUIRE(files.size() == it->second.size());
+            ++visited;
+        });
+        REQUIRE(visited == reference.size());
+    }
+
+    // Entries spread over files in load order, some TGIs repeated in later files as overrides
+    std::vector<TgiIndex::Entry> RandomEntries(const size_t keyCount, const uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<uint32_t> word;
+        std::vector<DBPF::Tgi> keys(keyCount);
+        for (auto& key : keys) {
+            key = {word(rng) % 8, word(rng) % 64, word(rng)};
+        }
+
+        std::vector<TgiIndex::Entry> entries;
+        std::uniform_int_distribution<size_t> pick(0, keyCount - 1);
+        for (uint32_t file = 0; file < 8; ++file) {
+            for (size_t i = file; i < keyCount; i += 8) {
+                entries.push_back({keys[i], file});
+            }
+            for (size_t i = 0; i < keyCount / 16; ++i) {
+                entries.push_back({keys[pick(rng)], file});
+            }
+        }
+        return entries;
+    }
+}
+
+TEST_CASE("TgiIndex matches a map of vectors across table sizes", "[tgi-index]") {
+    // From the minimum table of 16 slots up to large ones, including sizes either side of a doubling
+    for (const size_t keyCount : {size_t{1}, size_t{7}, size_t{8}, size_t{9}, size_t{1000}, size_t{43690},
+                                  size_t{43691}}) {
+        const auto entries = RandomEntries(keyCount, static_cast<uint32_t>(keyCount));
+        const TgiIndex index(entries);
+        RequireMatches(index, BuildReference(entries));
+        REQUIRE_FALSE(index.contains({0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF}));
+    }
+}
+
+TEST_CASE("TgiIndex finds keys that differ only by type or only by instance", "[tgi-index]") {
+    // Exemplars, cohorts, LTEXT and models commonly share a group and instance and differ only in type;
+    // these keys hash close together and form long probe runs
+    std::vector<TgiIndex::Entry> entries;
+    for (uint32_t type = 0; type < 2000; ++type) {
+        entries.push_back({{0x6534284A + type, 0xA8FBD372, 0x12345678}, type % 5});
+        entries.push_back({{0x6534284A + type, 0xA8FBD372, 0x12345678}, 5 + type % 3});
+    }
+    for (uint32_t instance = 0; instance < 2000; ++instance) {
+        entries.push_back({{0x6534284A, 0xA8FBD372, instance << 16}, instance % 7});
+    }
+    const TgiIndex index(entries);
+    RequireMatches(index, BuildReference(entries));
+
+    // Misses walk the same runs and must still stop at an empty slot
+    for (uint32_t type = 2000; type < 2100; ++type) {
+        REQUIRE(index.find({0x6534284A + type, 0xA8FBD372, 0x12345678}).empty());
+    }
+}
+
+TEST_CASE("TgiIndex can be cleared and rebuilt in place", "[tgi-index]") {
+    const auto large = RandomEntries(5000, 1);
+    const auto small = RandomEntries(20, 2);
+
+    TgiIndex index(large);
+    RequireMatches(index, BuildReference(large));
+
+    // A rebuild replaces every slot, so keys of the previous build are gone
+    index.build(small);
+    const auto smallReference = BuildReference(small);
+    RequireMatches(index, smallReference);
+    for (const auto& entry : large) {
+        REQUIRE(index.contains(entry.tgi) == smallReference.contains(entry.tgi));
+    }
+
+    index.clear();
+    REQUIRE(index.empty());
+    REQUIRE(index.find(small.front().tgi).empty());
+    REQUIRE_FALSE(index.winner(small.front().tgi));
+
+    index.build({});
+    REQUIRE(index.empty());
+    index.build(large);
+    RequireMatches(index, BuildReference(large));
+}
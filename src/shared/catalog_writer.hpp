@@ -0,0 +1,186 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include <rfl/cbor.hpp>
+#include <rfl/fields.hpp>
+
+// Writes a CBOR cache file piece by piece, so the records of a full install never have to be held in
+// memory at once.
+//
+// The outer map and array headers are written here; every record is encoded on its own with
+// rfl::cbor and appended as soon as it is final. Arrays are definite-length, with an 8-byte count
+// placeholder that is patched once the array is closed. The result decodes with rfl::cbor::load
+// exactly as if the whole struct had been written in one call.
+//
+// Output goes to "<path>.tmp" and only replaces the target in commit(), so an interrupted scan
+// leaves the previous file in place.
+class CatalogWriter {
+public:
+    explicit CatalogWriter(std::filesystem::path path)
+        : path_(std::move(path)) {
+        tempPath_ = path_;
+        tempPath_ += ".tmp";
+        file_.open(tempPath_, std::ios::binary | std::ios::trunc);
+    }
+
+    ~CatalogWriter() {
+        discard();
+    }
+
+    CatalogWriter(const CatalogWriter&) = delete;
+    CatalogWriter& operator=(const CatalogWriter&) = delete;
+
+    [[nodiscard]] bool isOpen() const {
+        return file_.is_open() && file_.good();
+    }
+
+    [[nodiscard]] const std::filesystem::path& path() const {
+        return path_;
+    }
+
+    // Opens the map of struct T. Every field of T must then be written, with field() or key() followed by
+    // an array, or commit() fails; the count comes from T, so a field added to it cannot be forgotten here.
+    template<typename T>
+    void beginMap() {
+        const auto fieldCount = rfl::fields<T>().size();
+        writeHead_(kMajorMap, fieldCount);
+        mapFieldsLeft_ = static_cast<int64_t>(fieldCount);
+    }
+
+    void key(const std::string_view name) {
+        writeHead_(kMajorText, name.size());
+        file_.write(name.data(), static_cast<std::streamsize>(name.size()));
+        --mapFieldsLeft_;
+    }
+
+    template<typename T>
+    void field(const std::string_view name, const T& value) {
+        key(name);
+        rfl::cbor::write(value, file_);
+    }
+
+    void beginArray() {
+        if (arrayStart_ >= 0) {
+            throw std::logic_error("CatalogWriter arrays cannot be nested");
+        }
+        arrayStart_ = static_cast<std::streamoff>(file_.tellp());
+        arrayCount_ = 0;
+        file_.put(static_cast<char>(kMajorArray | kAdditional64));
+        constexpr char placeholder[8] = {};
+        file_.write(placeholder, sizeof(placeholder));
+    }
+
+    template<typename T>
+    void append(const T& record) {
+        rfl::cbor::write(record, file_);
+        ++arrayCount_;
+    }
+
+    // Patches the element count of the open array; returns it
+    uint64_t endArray() {
+        if (arrayStart_ < 0) {
+            throw std::logic_error("CatalogWriter::endArray without beginArray");
+        }
+        const auto end = file_.tellp();
+        file_.seekp(arrayStart_ + 1);
+        char count[8];
+        for (int i = 0; i < 8; ++i) {
+            count[i] = static_cast<char>(arrayCount_ >> (56 - 8 * i));
+        }
+        file_.write(count, sizeof(count));
+        file_.seekp(end);
+        arrayStart_ = -1;
+        return arrayCount_;
+    }
+
+    [[nodiscard]] uint64_t arrayCount() const {
+        return arrayCount_;
+    }
+
+    // Closes the file and moves it over the target. Returns false, and keeps the previous target, if
+    // anything failed to write or an array or map is incomplete.
+    bool commit() {
+        if (!file_.is_open() || arrayStart_ >= 0 || mapFieldsLeft_ != 0) {
+            discard();
+            return false;
+        }
+        file_.close();
+        if (!file_) {
+            discard();
+            return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath_, path_, ec);
+        if (ec) {
+            discard();
+            return false;
+        }
+        return true;
+    }
+
+    // Drops everything written so far; the target is left untouched
+    void discard() {
+        if (file_.is_open()) {
+            file_.close();
+        }
+        arrayStart_ = -1;
+        mapFieldsLeft_ = 0;
+        std::error_code ec;
+        std::filesystem::remove(tempPath_, ec);
+    }
+
+private:
+    static constexpr uint8_t kMajorArray = 4 << 5;
+    static constexpr uint8_t kMajorText = 3 << 5;
+    static constexpr uint8_t kMajorMap = 5 << 5;
+    static constexpr uint8_t kAdditional64 = 27;
+
+    // Initial byte and argument of a data item header, in the shortest form
+    void writeHead_(const uint8_t major, const uint64_t value) {
+        char head[9];
+        size_t size;
+        if (value < 24) {
+            head[0] = static_cast<char>(major | value);
+            size = 1;
+        }
+        else if (value <= 0xFF) {
+            head[0] = static_cast<char>(major | 24);
+            head[1] = static_cast<char>(value);
+            size = 2;
+        }
+        else if (value <= 0xFFFF) {
+            head[0] = static_cast<char>(major | 25);
+            head[1] = static_cast<char>(value >> 8);
+            head[2] = static_cast<char>(value);
+            size = 3;
+        }
+        else if (value <= 0xFFFFFFFF) {
+            head[0] = static_cast<char>(major | 26);
+            for (int i = 0; i < 4; ++i) {
+                head[1 + i] = static_cast<char>(value >> (24 - 8 * i));
+            }
+            size = 5;
+        }
+        else {
+            head[0] = static_cast<char>(major | kAdditional64);
+            for (int i = 0; i < 8; ++i) {
+                head[1 + i] = static_cast<char>(value >> (56 - 8 * i));
+            }
+            size = 9;
+        }
+        file_.write(head, static_cast<std::streamsize>(size));
+    }
+
+    std::filesystem::path path_;
+    std::filesystem::path tempPath_;
+    std::ofstream file_;
+    std::streamoff arrayStart_ = -1;
+    uint64_t arrayCount_ = 0;
+    int64_t mapFieldsLeft_ = 0;  // Keys still owed to the map opened by beginMap()
+};
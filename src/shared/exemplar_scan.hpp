@@ -0,0 +1,131 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+// Reads a single property out of a raw binary exemplar or cohort entry without decoding the others,
+// so a scan can tell what an exemplar is before paying for a full load.
+//
+// Binary exemplar layout (little-endian):
+//   [0-7]   char[8]  "EQZB1###" (exemplar) or "CQZB1###" (cohort)
+//   [8-19]  uint32_t parent cohort type, group, instance
+//   [20-23] uint32_t property count
+//   Properties:
+//     uint32_t id
+//     uint16_t value type (0x0100 Uint8, 0x0200 Uint16, 0x0300 Uint32, 0x0700 Sint32, 0x0800 Sint64,
+//                          0x0900 Float32, 0x0B00 Bool, 0x0C00 String)
+//     uint16_t key type (0x0000 single value, 0x0080 list)
+//     uint8_t  unused
+//     list:   uint32_t value count, then the values (a string is a list of its bytes)
+//     single: one value
+
+struct ExemplarPropertyScan {
+    std::array<uint32_t, 3> parent{}; // Parent cohort type, group and instance; instance 0 when none
+    bool found = false;
+    std::optional<uint32_t> value; // First value, when the property has one
+};
+
+namespace ExemplarScanFormat {
+    constexpr size_t kHeaderSize = 24;
+    constexpr size_t kPropertyHeaderSize = 9;
+    constexpr uint16_t kKeyTypeList = 0x0080;
+
+    // Bytes per value, or 0 for a type the scan does not know
+    inline size_t ValueSize(const uint16_t valueType) {
+        switch (valueType) {
+        case 0x0100: // Uint8
+        case 0x0B00: // Bool
+        case 0x0C00: // String
+            return 1;
+        case 0x0200: // Uint16
+            return 2;
+        case 0x0300: // Uint32
+        case 0x0700: // Sint32
+        case 0x0900: // Float32
+            return 4;
+        case 0x0800: // Sint64
+            return 8;
+        default:
+            return 0;
+        }
+    }
+
+    inline uint32_t ReadU32(const uint8_t* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint16_t ReadU16(const uint8_t* data) {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+} // namespace ExemplarScanFormat
+
+// The first property with propertyId and the parent cohort of the entry. Nullopt when the entry is a
+// text exemplar, is malformed, or stores the property as anything but an unsigned integer; a full
+// load is the only way to read those the way Exemplar::Property::GetScalarAs does.
+inline std::optional<ExemplarPropertyScan> ScanExemplarProperty(const std::span<const uint8_t> data,
+                                                                const uint32_t propertyId) {
+    using namespace ExemplarScanFormat;
+    if (data.size() < kHeaderSize || (data[0] != 'E' && data[0] != 'C')
+        || std::memcmp(data.data() + 1, "QZB1###", 7) != 0) {
+        return std::nullopt;
+    }
+
+    ExemplarPropertyScan scan;
+    scan.parent = {ReadU32(data.data() + 8), ReadU32(data.data() + 12), ReadU32(data.data() + 16)};
+    const uint32_t propertyCount = ReadU32(data.data() + 20);
+
+    size_t offset = kHeaderSize;
+    for (uint32_t i = 0; i < propertyCount; ++i) {
+        if (data.size() - offset < kPropertyHeaderSize) {
+            return std::nullopt;
+        }
+        const uint32_t id = ReadU32(data.data() + offset);
+        const uint16_t valueType = ReadU16(data.data() + offset + 4);
+        const bool isList = ReadU16(data.data() + offset + 6) == kKeyTypeList;
+        offset += kPropertyHeaderSize;
+
+        const size_t valueSize = ValueSize(valueType);
+        if (valueSize == 0) {
+            return std::nullopt;
+        }
+        uint64_t valueCount = 1;
+        if (isList) {
+            if (data.size() - offset < sizeof(uint32_t)) {
+                return std::nullopt;
+            }
+            valueCount = ReadU32(data.data() + offset);
+            offset += sizeof(uint32_t);
+        }
+        if (valueCount * valueSize > data.size() - offset) {
+            return std::nullopt;
+        }
+
+        if (id == propertyId) {
+            if (valueType != 0x0100 && valueType != 0x0200 && valueType != 0x0300) {
+                return std::nullopt;
+            }
+            scan.found = true;
+            if (valueCount > 0) {
+                if (valueSize == 1) {
+                    scan.value = data[offset];
+                }
+                else if (valueSize == 2) {
+                    scan.value = ReadU16(data.data() + offset);
+                }
+                else {
+                    scan.value = ReadU32(data.data() + offset);
+                }
+            }
+            return scan;
+        }
+        offset += static_cast<size_t>(valueCount * valueSize);
+    }
+    return scan;
+}
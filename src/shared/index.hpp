@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "rfl/Timestamp.hpp"
 
@@ -9,12 +13,19 @@ struct PluginFileInfo {
     uint64_t fileSize;
     rfl::Timestamp<"%FT%TZ"> lastModified;
     uint32_t resourceCount;
+    int64_t lastWriteTicks = 0;     // Raw filesystem write time, compared exactly to detect changes
+    std::vector<uint32_t> tgis;     // Indexed entries as flattened (type, group, instance) triples
 };
 
 struct PluginIndex {
+    uint32_t version = 1;
     rfl::Timestamp<"%FT%TZ"> buildTime;
     std::string pluginsDirectory;
     std::vector<PluginFileInfo> files;
+    // Builder version and options that affect the generated caches
+    std::optional<std::string> cacheSignature;
+    // Cache files written by the run that produced this index
+    std::vector<std::string> outputs;
 };
 
 struct PluginConfiguration {
@@ -0,0 +1,460 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Compact binary form of PropertyMapper.xml, written by tools/convert_properties and read in place
+// from a memory-mapped file, so a scan does not have to parse the XML before it can start.
+//
+// Format (little-endian; every section starts on a 4-byte boundary):
+//   Header (32 bytes):
+//     [0-3]   char[4]  magic = "SPPD"
+//     [4-5]   uint16_t version = 1
+//     [6-7]   uint16_t reserved = 0
+//     [8-11]  uint32_t property_count P
+//     [12-15] uint32_t option_count O
+//     [16-19] uint32_t name_slot_count H   (power of two, at least twice P)
+//     [20-23] uint32_t string_bytes S
+//     [24-31] reserved = 0
+//
+//   Properties (P x 24 bytes, sorted ascending by id):
+//     uint32_t id, name_offset, name_length, first_option, option_count
+//     int16_t  count (-1 for variable-length arrays)
+//     uint8_t  value_type, reserved
+//
+//   Options (O x 12 bytes; each property's options are contiguous and sorted by name):
+//     uint32_t value, name_offset, name_length
+//
+//   Name index (H x 16 bytes, open addressing with linear probing on the FNV-1a hash of the name):
+//     uint32_t hash, name_offset, name_length, property_index (0xFFFFFFFF when empty)
+//
+//   Strings (S bytes): UTF-8 names, referenced by offset and length, not terminated
+
+// Value types as named by the Type attribute of PropertyMapper.xml
+enum class PropertyValueType : uint8_t {
+    UInt8,
+    UInt16,
+    UInt32,
+    SInt32,
+    SInt64,
+    Float32,
+    Bool,
+    String,
+};
+
+// Unknown names are read as UInt32, as the XML loader has always done
+inline PropertyValueType ParsePropertyValueType(const std::string_view name) {
+    constexpr std::pair<std::string_view, PropertyValueType> kTypes[] = {
+        {"Uint8", PropertyValueType::UInt8},
+        {"Uint16", PropertyValueType::UInt16},
+        {"Uint32", PropertyValueType::UInt32},
+        {"Sint32", PropertyValueType::SInt32},
+        {"Sint64", PropertyValueType::SInt64},
+        {"Float32", PropertyValueType::Float32},
+        {"Bool", PropertyValueType::Bool},
+        {"String", PropertyValueType::String},
+    };
+    for (const auto& [typeName, type] : kTypes) {
+        if (typeName == name) {
+            return type;
+        }
+    }
+    return PropertyValueType::UInt32;
+}
+
+// How PropertyMapper.xml spells IDs, option values and counts. The XML loader and tools/convert_properties
+// both read them through these, so the XML and the dictionary compiled from it hold the same properties.
+namespace PropertyXmlValue {
+    inline std::string_view Trim(std::string_view text) {
+        constexpr std::string_view kWhitespace = " \t\r\n";
+        const auto first = text.find_first_not_of(kWhitespace);
+        if (first == std::string_view::npos) {
+            return {};
+        }
+        return text.substr(first, text.find_last_not_of(kWhitespace) - first + 1);
+    }
+
+    inline std::optional<uint32_t> ParseU32(const std::string_view text, const int base) {
+        uint32_t value = 0;
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+        if (text.empty() || ec != std::errc{} || ptr != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    inline bool HasHexPrefix(const std::string_view text) {
+        return text.starts_with("0x") || text.starts_with("0X");
+    }
+} // namespace PropertyXmlValue
+
+// Property IDs are hex, with or without 0x. Nullopt for anything else, and the property is skipped.
+inline std::optional<uint32_t> ParsePropertyId(const std::string_view text) {
+    using namespace PropertyXmlValue;
+    const auto id = Trim(text);
+    return ParseU32(HasHexPrefix(id) ? id.substr(2) : id, 16);
+}
+
+// Option values are hex with 0x and decimal without. Nullopt for symbolic values such as "Col:0", and
+// the option is skipped.
+inline std::optional<uint32_t> ParsePropertyOptionValue(const std::string_view text) {
+    using namespace PropertyXmlValue;
+    const auto value = Trim(text);
+    return HasHexPrefix(value) ? ParseU32(value.substr(2), 16) : ParseU32(value, 10);
+}
+
+// The Count attribute; 1 when it is absent or not a number, -1 for variable-length arrays
+inline int ParsePropertyCount(const std::optional<std::string_view> text) {
+    if (!text) {
+        return 1;
+    }
+    const auto count = PropertyXmlValue::Trim(*text);
+    int value = 1;
+    const auto [ptr, ec] = std::from_chars(count.data(), count.data() + count.size(), value);
+    if (count.empty() || ec != std::errc{} || ptr != count.data() + count.size()) {
+        return 1;
+    }
+    return value;
+}
+
+namespace PropertyDictionaryFormat {
+    constexpr char kMagic[4] = {'S', 'P', 'P', 'D'};
+    constexpr uint16_t kVersion = 1;
+    constexpr size_t kHeaderSize = 32;
+    constexpr size_t kPropertySize = 24;
+    constexpr size_t kOptionSize = 12;
+    constexpr size_t kNameSlotSize = 16;
+    constexpr uint32_t kEmptySlot = 0xFFFFFFFFu;
+
+    inline uint32_t HashName(const std::string_view name) {
+        uint32_t hash = 2166136261u;
+        for (const char c : name) {
+            hash ^= static_cast<uint8_t>(c);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    inline uint32_t ReadU32(const std::byte* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint16_t ReadU16(const std::byte* data) {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline void WriteU32(std::vector<std::byte>& out, const uint32_t value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(value));
+    }
+
+    inline void WriteU16(std::vector<std::byte>& out, const uint16_t value) {
+        const auto* bytes = reinterpret_cast<const std::byte*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(value));
+    }
+} // namespace PropertyDictionaryFormat
+
+// Read-only view of a compiled dictionary. Does not own the bytes, which must outlive it; names it
+// returns point into them.
+class PropertyDictionary {
+public:
+    struct Property {
+        uint32_t id;
+        std::string_view name;
+        PropertyValueType type;
+        int count;
+        uint32_t index; // Position in the id-sorted table, for options()
+    };
+
+    // Checks the header and that every table and name lies within bytes; nullopt if it does not
+    static std::optional<PropertyDictionary> fromBytes(std::span<const std::byte> bytes) {
+        using namespace PropertyDictionaryFormat;
+        if (bytes.size() < kHeaderSize || std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) != 0
+            || ReadU16(bytes.data() + 4) != kVersion) {
+            return std::nullopt;
+        }
+
+        PropertyDictionary dictionary;
+        dictionary.bytes_ = bytes;
+        dictionary.propertyCount_ = ReadU32(bytes.data() + 8);
+        dictionary.optionCount_ = ReadU32(bytes.data() + 12);
+        dictionary.slotCount_ = ReadU32(bytes.data() + 16);
+        const uint64_t stringBytes = ReadU32(bytes.data() + 20);
+        if (dictionary.slotCount_ == 0 || (dictionary.slotCount_ & (dictionary.slotCount_ - 1)) != 0) {
+            return std::nullopt;
+        }
+
+        dictionary.propertiesOffset_ = kHeaderSize;
+        dictionary.optionsOffset_ = dictionary.propertiesOffset_ + uint64_t{dictionary.propertyCount_} * kPropertySize;
+        dictionary.slotsOffset_ = dictionary.optionsOffset_ + uint64_t{dictionary.optionCount_} * kOptionSize;
+        dictionary.stringsOffset_ = dictionary.slotsOffset_ + uint64_t{dictionary.slotCount_} * kNameSlotSize;
+        if (dictionary.stringsOffset_ + stringBytes > bytes.size()) {
+            return std::nullopt;
+        }
+        dictionary.stringBytes_ = static_cast<uint32_t>(stringBytes);
+
+        // Validated once here, so lookups can trust every offset
+        for (uint32_t i = 0; i < dictionary.propertyCount_; ++i) {
+            const auto* record = dictionary.propertyRecord_(i);
+            const uint64_t firstOption = ReadU32(record + 12);
+            if (!dictionary.validName_(record + 4) || firstOption + ReadU32(record + 16) > dictionary.optionCount_
+                || (i > 0 && ReadU32(record) <= ReadU32(dictionary.propertyRecord_(i - 1)))) {
+                return std::nullopt;
+            }
+        }
+        for (uint32_t i = 0; i < dictionary.optionCount_; ++i) {
+            if (!dictionary.validName_(dictionary.optionRecord_(i) + 4)) {
+                return std::nullopt;
+            }
+        }
+        for (uint32_t i = 0; i < dictionary.slotCount_; ++i) {
+            const auto* slot = dictionary.slotRecord_(i);
+            const uint32_t propertyIndex = ReadU32(slot + 12);
+            if (propertyIndex != kEmptySlot
+                && (propertyIndex >= dictionary.propertyCount_ || !dictionary.validName_(slot + 4))) {
+                return std::nullopt;
+            }
+        }
+        return dictionary;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return propertyCount_;
+    }
+
+    [[nodiscard]] std::optional<Property> find(const uint32_t id) const {
+        uint32_t low = 0;
+        uint32_t high = propertyCount_;
+        while (low < high) {
+            const uint32_t mid = low + (high - low) / 2;
+            if (PropertyDictionaryFormat::ReadU32(propertyRecord_(mid)) < id) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (low == propertyCount_ || PropertyDictionaryFormat::ReadU32(propertyRecord_(low)) != id) {
+            return std::nullopt;
+        }
+        return property_(low);
+    }
+
+    [[nodiscard]] std::optional<Property> findByName(const std::string_view name) const {
+        using namespace PropertyDictionaryFormat;
+        const uint32_t hash = HashName(name);
+        for (uint32_t probe = 0, slot = hash & (slotCount_ - 1); probe < slotCount_;
+             ++probe, slot = (slot + 1) & (slotCount_ - 1)) {
+            const auto* record = slotRecord_(slot);
+            const uint32_t propertyIndex = ReadU32(record + 12);
+            if (propertyIndex == kEmptySlot) {
+                break;
+            }
+            if (ReadU32(record) == hash && string_(record + 4) == name) {
+                return property_(propertyIndex);
+            }
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<uint32_t> optionValue(const Property& property, const std::string_view name) const {
+        const auto* record = propertyRecord_(property.index);
+        const uint32_t first = PropertyDictionaryFormat::ReadU32(record + 12);
+        const uint32_t end = first + PropertyDictionaryFormat::ReadU32(record + 16);
+        uint32_t low = first;
+        uint32_t high = end;
+        while (low < high) {
+            const uint32_t mid = low + (high - low) / 2;
+            if (string_(optionRecord_(mid) + 4) < name) {
+                low = mid + 1;
+            }
+            else {
+                high = mid;
+            }
+        }
+        if (low == end || string_(optionRecord_(low) + 4) != name) {
+            return std::nullopt;
+        }
+        return PropertyDictionaryFormat::ReadU32(optionRecord_(low));
+    }
+
+    // Every option of a property as (name, value), sorted by name
+    [[nodiscard]] std::vector<std::pair<std::string_view, uint32_t>> options(const Property& property) const {
+        const auto* record = propertyRecord_(property.index);
+        const uint32_t first = PropertyDictionaryFormat::ReadU32(record + 12);
+        const uint32_t count = PropertyDictionaryFormat::ReadU32(record + 16);
+        std::vector<std::pair<std::string_view, uint32_t>> result;
+        result.reserve(count);
+        for (uint32_t i = first; i < first + count; ++i) {
+            result.emplace_back(string_(optionRecord_(i) + 4), PropertyDictionaryFormat::ReadU32(optionRecord_(i)));
+        }
+        return result;
+    }
+
+private:
+    PropertyDictionary() = default;
+
+    [[nodiscard]] const std::byte* propertyRecord_(const uint32_t index) const {
+        return bytes_.data() + propertiesOffset_ + static_cast<size_t>(index) * PropertyDictionaryFormat::kPropertySize;
+    }
+
+    [[nodiscard]] const std::byte* optionRecord_(const uint32_t index) const {
+        return bytes_.data() + optionsOffset_ + static_cast<size_t>(index) * PropertyDictionaryFormat::kOptionSize;
+    }
+
+    [[nodiscard]] const std::byte* slotRecord_(const uint32_t index) const {
+        return bytes_.data() + slotsOffset_ + static_cast<size_t>(index) * PropertyDictionaryFormat::kNameSlotSize;
+    }
+
+    // Name stored as an offset and a length at reference
+    [[nodiscard]] bool validName_(const std::byte* reference) const {
+        const uint64_t offset = PropertyDictionaryFormat::ReadU32(reference);
+        return offset + PropertyDictionaryFormat::ReadU32(reference + 4) <= stringBytes_;
+    }
+
+    [[nodiscard]] std::string_view string_(const std::byte* reference) const {
+        const auto* strings = reinterpret_cast<const char*>(bytes_.data() + stringsOffset_);
+        return {strings + PropertyDictionaryFormat::ReadU32(reference),
+                PropertyDictionaryFormat::ReadU32(reference + 4)};
+    }
+
+    [[nodiscard]] Property property_(const uint32_t index) const {
+        const auto* record = propertyRecord_(index);
+        return Property{
+            .id = PropertyDictionaryFormat::ReadU32(record),
+            .name = string_(record + 4),
+            .type = static_cast<PropertyValueType>(record[22]),
+            .count = static_cast<int16_t>(PropertyDictionaryFormat::ReadU16(record + 20)),
+            .index = index,
+        };
+    }
+
+    std::span<const std::byte> bytes_;
+    uint32_t propertyCount_ = 0;
+    uint32_t optionCount_ = 0;
+    uint32_t slotCount_ = 0;
+    uint32_t stringBytes_ = 0;
+    uint64_t propertiesOffset_ = 0;
+    uint64_t optionsOffset_ = 0;
+    uint64_t slotsOffset_ = 0;
+    uint64_t stringsOffset_ = 0;
+};
+
+// Collects property definitions in the order the XML lists them and writes the binary dictionary.
+// Later definitions replace earlier ones with the same ID, name or option name, as they do when the
+// XML is loaded directly.
+class PropertyDictionaryBuilder {
+public:
+    void add(const uint32_t id, std::string name, const PropertyValueType type, const int count,
+             const std::vector<std::pair<std::string, uint32_t>>& options) {
+        auto& definition = definitions_[id];
+        definition.name = name;
+        definition.type = type;
+        definition.count = count;
+        definition.options.clear();
+        for (const auto& [optionName, value] : options) {
+            definition.options[optionName] = value;
+        }
+        names_[std::move(name)] = id;
+    }
+
+    [[nodiscard]] std::vector<std::byte> build() const {
+        using namespace PropertyDictionaryFormat;
+
+        std::string strings;
+        std::map<std::string_view, uint32_t> stringOffsets;
+        const auto intern = [&](const std::string& value) {
+            const auto [it, inserted] = stringOffsets.try_emplace(value, static_cast<uint32_t>(strings.size()));
+            if (inserted) {
+                strings += value;
+            }
+            return it->second;
+        };
+
+        std::vector<std::byte> properties;
+        std::vector<std::byte> options;
+        std::map<uint32_t, uint32_t> propertyIndices;
+        uint32_t optionCount = 0;
+        for (const auto& [id, definition] : definitions_) {
+            propertyIndices[id] = static_cast<uint32_t>(propertyIndices.size());
+            WriteU32(properties, id);
+            WriteU32(properties, intern(definition.name));
+            WriteU32(properties, static_cast<uint32_t>(definition.name.size()));
+            WriteU32(properties, optionCount);
+            WriteU32(properties, static_cast<uint32_t>(definition.options.size()));
+            WriteU16(properties, static_cast<uint16_t>(static_cast<int16_t>(definition.count)));
+            properties.push_back(static_cast<std::byte>(definition.type));
+            properties.push_back(std::byte{0});
+            for (const auto& [optionName, value] : definition.options) {
+                WriteU32(options, value);
+                WriteU32(options, intern(optionName));
+                WriteU32(options, static_cast<uint32_t>(optionName.size()));
+                ++optionCount;
+            }
+        }
+
+        // Power of two, at most half full, so probes stay short
+        uint32_t slotCount = 1;
+        while (slotCount < names_.size() * 2) {
+            slotCount *= 2;
+        }
+        std::vector<std::array<uint32_t, 4>> slots(slotCount, {0, 0, 0, kEmptySlot});
+        for (const auto& [name, id] : names_) {
+            const uint32_t hash = HashName(name);
+            uint32_t slot = hash & (slotCount - 1);
+            while (slots[slot][3] != kEmptySlot) {
+                slot = (slot + 1) & (slotCount - 1);
+            }
+            slots[slot] = {hash, intern(name), static_cast<uint32_t>(name.size()), propertyIndices.at(id)};
+        }
+
+        std::vector<std::byte> out;
+        out.reserve(kHeaderSize + properties.size() + options.size() + slots.size() * kNameSlotSize
+                    + strings.size());
+        out.insert(out.end(), reinterpret_cast<const std::byte*>(kMagic),
+                   reinterpret_cast<const std::byte*>(kMagic) + sizeof(kMagic));
+        WriteU16(out, kVersion);
+        WriteU16(out, 0);
+        WriteU32(out, static_cast<uint32_t>(definitions_.size()));
+        WriteU32(out, optionCount);
+        WriteU32(out, slotCount);
+        WriteU32(out, static_cast<uint32_t>(strings.size()));
+        out.resize(kHeaderSize, std::byte{0});
+        out.insert(out.end(), properties.begin(), properties.end());
+        out.insert(out.end(), options.begin(), options.end());
+        for (const auto& slot : slots) {
+            for (const uint32_t value : slot) {
+                WriteU32(out, value);
+            }
+        }
+        const auto* stringData = reinterpret_cast<const std::byte*>(strings.data());
+        out.insert(out.end(), stringData, stringData + strings.size());
+        return out;
+    }
+
+private:
+    struct Definition {
+        std::string name;
+        PropertyValueType type = PropertyValueType::UInt32;
+        int count = 1;
+        std::map<std::string, uint32_t> options; // Sorted by name, as the file stores them
+    };
+
+    std::map<uint32_t, Definition> definitions_;
+    std::map<std::string, uint32_t> names_;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <rfl/Rename.hpp>
+#include <rfl/xml.hpp>
+
+#include "property_dictionary.hpp"
+
+// Reads PropertyMapper.xml for both PropertyMapper::loadFromXml and tools/convert_properties, so the
+// CLI sees the same properties whether it loads the XML or the dictionary compiled from it.
+//
+// <ExemplarProperties>
+//   <PROPERTIES>
+//     <PROPERTY ID="..." Name="..." Type="..." Count="...">
+//       <OPTION Value="..." Name="..."/>
+//     </PROPERTY>
+//   </PROPERTIES>
+// </ExemplarProperties>
+
+namespace PropertyXml {
+    struct Option {
+        rfl::Rename<"Value", std::string> value; // Hex, decimal or symbolic
+        rfl::Rename<"Name", std::string> name;
+    };
+
+    struct Property {
+        rfl::Rename<"ID", std::string> id;
+        rfl::Rename<"Name", std::string> name;
+        rfl::Rename<"Type", std::optional<std::string>> type;
+        rfl::Rename<"Count", std::optional<std::string>> count;
+        rfl::Rename<"OPTION", std::vector<Option>> options;
+    };
+
+    struct Properties {
+        rfl::Rename<"PROPERTY", std::vector<Property>> properties;
+    };
+
+    struct ExemplarProperties {
+        rfl::Rename<"PROPERTIES", Properties> properties;
+    };
+
+    struct Definition {
+        uint32_t id;
+        std::string name;
+        PropertyValueType type;
+        int count;
+        std::vector<std::pair<std::string, uint32_t>> options;
+    };
+} // namespace PropertyXml
+
+// The properties of the XML in file order. Properties whose ID does not parse and options whose value
+// does not parse are left out.
+inline rfl::Result<std::vector<PropertyXml::Definition>> ReadPropertyXml(const std::string& xml) {
+    return rfl::xml::read<PropertyXml::ExemplarProperties>(xml).transform([](const auto& document) {
+        std::vector<PropertyXml::Definition> definitions;
+        for (const auto& property : document.properties().properties()) {
+            const auto id = ParsePropertyId(property.id());
+            if (!id) {
+                continue;
+            }
+
+            PropertyXml::Definition definition{
+                *id, property.name(), ParsePropertyValueType(property.type().value_or("")),
+                ParsePropertyCount(property.count()), {}
+            };
+            for (const auto& option : property.options()) {
+                if (const auto value = ParsePropertyOptionValue(option.value())) {
+                    definition.options.emplace_back(option.name(), *value);
+                }
+            }
+            definitions.push_back(std::move(definition));
+        }
+        return definitions;
+    });
+}
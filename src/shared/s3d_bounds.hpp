@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <span>
+
+// Reads the bounding box of an S3D model from its vertex positions alone, without decoding indices,
+// primitives, materials or animation, so a scan that only needs a model's size does not pay for a
+// full load.
+//
+// S3D layout (little-endian), as far as this reader needs it:
+//   [0-7]   char[4] "3DMD", uint32_t file size
+//   HEAD:   char[4] "HEAD", uint32_t section size (12), uint16_t major version (1), uint16_t minor version
+//   VERT:   char[4] "VERT", uint32_t section size, uint32_t vertex buffer count
+//     Per buffer:
+//       uint16_t flags, uint16_t vertex count, uint32_t format (minor version 4 and later)
+//       vertex count vertices of VertexStride(format) bytes, each starting with float x, y, z
+//   Section sizes count their own tag and size.
+//
+// Only vertex formats with a known stride are read, and the buffers have to fill the VERT section
+// exactly; anything else returns nullopt so the caller falls back to a full decode.
+
+namespace S3DBoundsFormat {
+    constexpr size_t kFileHeaderSize = 8;
+    constexpr size_t kSectionHeaderSize = 8;
+    constexpr size_t kHeadSectionSize = 12;
+    constexpr size_t kBufferHeaderSize = 8;
+    constexpr uint16_t kMinMinorVersion = 4;
+
+    // Bytes per vertex, or 0 for a format this reader does not know
+    inline size_t VertexStride(const uint32_t format) {
+        switch (format) {
+        case 0x80000001: // Position, one texture coordinate
+            return 20;
+        case 0x80004001: // Position, colour, one texture coordinate
+            return 24;
+        case 0x80000002: // Position, two texture coordinates
+            return 28;
+        case 0x80004002: // Position, colour, two texture coordinates
+            return 32;
+        default:
+            return 0;
+        }
+    }
+
+    inline uint32_t ReadU32(const uint8_t* data) {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline uint16_t ReadU16(const uint8_t* data) {
+        uint16_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    inline float ReadF32(const uint8_t* data) {
+        float value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+} // namespace S3DBoundsFormat
+
+// The box around every vertex position of the model as {minX, maxX, minY, maxY, minZ, maxZ}. Nullopt
+// when the entry is not an S3D model this reader understands, or has no vertices.
+inline std::optional<std::array<float, 6>> ReadS3DBounds(const std::span<const uint8_t> data) {
+    using namespace S3DBoundsFormat;
+    const size_t vertOffset = kFileHeaderSize + kHeadSectionSize;
+    if (data.size() < vertOffset + kSectionHeaderSize + sizeof(uint32_t)
+        || std::memcmp(data.data(), "3DMD", 4) != 0
+        || std::memcmp(data.data() + kFileHeaderSize, "HEAD", 4) != 0
+        || ReadU32(data.data() + kFileHeaderSize + 4) != kHeadSectionSize
+        || ReadU16(data.data() + kFileHeaderSize + 8) != 1
+        || ReadU16(data.data() + kFileHeaderSize + 10) < kMinMinorVersion
+        || std::memcmp(data.data() + vertOffset, "VERT", 4) != 0) {
+        return std::nullopt;
+    }
+
+    const uint32_t sectionSize = ReadU32(data.data() + vertOffset + 4);
+    if (sectionSize < kSectionHeaderSize + sizeof(uint32_t) || sectionSize > data.size() - vertOffset) {
+        return std::nullopt;
+    }
+    const size_t sectionEnd = vertOffset + sectionSize;
+    const uint32_t bufferCount = ReadU32(data.data() + vertOffset + kSectionHeaderSize);
+
+    std::array<float, 6> bounds{
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()
+    };
+    bool anyVertex = false;
+
+    size_t offset = vertOffset + kSectionHeaderSize + sizeof(uint32_t);
+    for (uint32_t i = 0; i < bufferCount; ++i) {
+        if (offset > sectionEnd || sectionEnd - offset < kBufferHeaderSize) {
+            return std::nullopt;
+        }
+        const uint16_t vertexCount = ReadU16(data.data() + offset + 2);
+        const size_t stride = VertexStride(ReadU32(data.data() + offset + 4));
+        offset += kBufferHeaderSize;
+        if (stride == 0 || static_cast<size_t>(vertexCount) * stride > sectionEnd - offset) {
+            return std::nullopt;
+        }
+
+        for (uint16_t v = 0; v < vertexCount; ++v, offset += stride) {
+            for (size_t axis = 0; axis < 3; ++axis) {
+                const float value = ReadF32(data.data() + offset + axis * sizeof(float));
+                bounds[axis * 2] = std::min(bounds[axis * 2], value);
+                bounds[axis * 2 + 1] = std::max(bounds[axis * 2 + 1], value);
+            }
+        }
+        anyVertex = anyVertex || vertexCount > 0;
+    }
+
+    // A stride guessed wrong for some format would not end exactly at the next section
+    if (offset != sectionEnd || !anyVertex) {
+        return std::nullopt;
+    }
+    return bounds;
+}
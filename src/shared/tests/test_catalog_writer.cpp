@@ -0,0 +1,185 @@
+#include <catalog_writer.hpp>
+#include <entities.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <rfl/cbor.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+namespace fs = std::filesystem;
+
+namespace {
+    fs::path TempPath(const std::string& name) {
+        return fs::temp_directory_path() / ("sc4pp_catalog_writer_" + name);
+    }
+
+    Prop MakeProp(const uint32_t i) {
+        return Prop{
+            .groupId = rfl::Hex<uint32_t>(0x11223344),
+            .instanceId = rfl::Hex<uint32_t>(0x50000000 + i),
+            .exemplarName = "Prop " + std::to_string(i),
+            .visibleName = "Visible Prop " + std::to_string(i),
+            .width = 1.5f,
+            .height = 2.0f + static_cast<float>(i),
+            .depth = 3.25f,
+            .familyIds = {rfl::Hex<uint32_t>(0xAABBCCDD), rfl::Hex<uint32_t>(i)},
+            .nighttimeStateChange = i % 2 == 0 ? std::optional(true) : std::nullopt,
+            .timeOfDay = i % 3 == 0 ? std::optional(PropTimeOfDay{6.0f, 18.5f}) : std::nullopt,
+            .randomChance = static_cast<uint8_t>(i % 100),
+            .thumbnail = i % 2 == 0
+                ? std::optional(Thumbnail{Icon{
+                    .data = rfl::Bytestring(std::vector<std::byte>(16, std::byte{static_cast<uint8_t>(i)})),
+                    .width = 2,
+                    .height = 2
+                }})
+                : std::nullopt
+        };
+    }
+
+    Flora MakeFlora(const uint32_t i) {
+        Flora flora;
+        flora.groupId = rfl::Hex<uint32_t>(0x55667788);
+        flora.instanceId = rfl::Hex<uint32_t>(0x60000000 + i);
+        flora.exemplarName = "Flora " + std::to_string(i);
+        flora.visibleName = "Visible Flora " + std::to_string(i);
+        flora.height = 4.0f + static_cast<float>(i);
+        return flora;
+    }
+
+    // A single occupant group, since the order of an unordered_set may change across a round trip
+    Building MakeBuilding(const uint32_t i) {
+        return Building{
+            .instanceId = rfl::Hex<uint32_t>(0x70000000 + i),
+            .groupId = rfl::Hex<uint32_t>(0x87654321),
+            .name = "Building " + std::to_string(i),
+            .description = "Streamed building",
+            .occupantGroups = {0x1000 + i},
+            .thumbnail = std::nullopt,
+            .lots = {Lot{
+                .instanceId = rfl::Hex<uint32_t>(0x80000000 + i),
+                .groupId = rfl::Hex<uint32_t>(0x11111111),
+                .name = "Lot " + std::to_string(i),
+                .sizeX = 1,
+                .sizeZ = 2
+            }}
+        };
+    }
+
+    // rfl::cbor::write would encode these array lengths inline or in 1, 2 or 4 bytes; the writer always
+    // patches in an 8-byte length, which has to decode the same
+    const std::vector<uint32_t> kRecordCounts = {0, 1, 23, 24, 255, 256, 70000};
+
+    // Reloads path the way the DLL does and compares the result, re-encoded, with original
+    template<typename T>
+    void RequireLoadsAs(const fs::path& path, const T& original) {
+        auto loaded = rfl::cbor::load<T>(path.string());
+        REQUIRE(loaded);
+        REQUIRE(rfl::cbor::write(*loaded) == rfl::cbor::write(original));
+        fs::remove(path);
+    }
+}
+
+TEST_CASE("CatalogWriter streams a PropsCache that rfl reads back", "[catalog-writer]") {
+    for (const auto count : kRecordCounts) {
+        CAPTURE(count);
+        PropsCache original;
+        for (uint32_t i = 0; i < count; ++i) {
+            original.props.push_back(MakeProp(i));
+        }
+        original.propFamilies = {PropFamilyInfo{rfl::Hex<uint32_t>(0xAABBCCDD), "Family"}};
+
+        const auto path = TempPath("props.cbor");
+        CatalogWriter writer(path);
+        writer.beginMap<PropsCache>();
+        writer.field("version", original.version);
+        writer.key("props");
+        writer.beginArray();
+        for (const auto& prop : original.props) {
+            writer.append(prop);
+        }
+        REQUIRE(writer.endArray() == count);
+        writer.field("propFamilies", original.propFamilies);
+        REQUIRE(writer.commit());
+
+        RequireLoadsAs(path, original);
+    }
+}
+
+TEST_CASE("CatalogWriter streams a FloraCache and a bare array of buildings", "[catalog-writer]") {
+    for (const auto count : {uint32_t{0}, uint32_t{3}, uint32_t{300}}) {
+        CAPTURE(count);
+        FloraCache flora;
+        std::vector<Building> buildings;
+        for (uint32_t i = 0; i < count; ++i) {
+            flora.floraItems.push_back(MakeFlora(i));
+            buildings.push_back(MakeBuilding(i));
+        }
+
+        const auto floraPath = TempPath("flora.cbor");
+        CatalogWriter floraWriter(floraPath);
+        floraWriter.beginMap<FloraCache>();
+        floraWriter.field("version", flora.version);
+        floraWriter.key("floraItems");
+        floraWriter.beginArray();
+        for (const auto& item : flora.floraItems) {
+            floraWriter.append(item);
+        }
+        floraWriter.endArray();
+        floraWriter.field("floraFamilies", flora.floraFamilies);
+        REQUIRE(floraWriter.commit());
+        RequireLoadsAs(floraPath, flora);
+
+        const auto lotsPath = TempPath("lots.cbor");
+        CatalogWriter lotsWriter(lotsPath);
+        lotsWriter.beginArray();
+        for (const auto& building : buildings) {
+            lotsWriter.append(building);
+        }
+        lotsWriter.endArray();
+        REQUIRE(lotsWriter.commit());
+        RequireLoadsAs(lotsPath, buildings);
+    }
+}
+
+TEST_CASE("CatalogWriter refuses to commit an incomplete file and keeps the previous one", "[catalog-writer]") {
+    const auto path = TempPath("incomplete.cbor");
+    {
+        CatalogWriter writer(path);
+        writer.beginArray();
+        writer.append(MakeBuilding(1));
+        writer.endArray();
+        REQUIRE(writer.commit());
+    }
+    const auto previous = std::vector{MakeBuilding(1)};
+
+    {
+        // A field of FloraCache is missing
+        CatalogWriter writer(path);
+        writer.beginMap<FloraCache>();
+        writer.field("version", FloraCache{}.version);
+        writer.key("floraItems");
+        writer.beginArray();
+        writer.endArray();
+        REQUIRE_FALSE(writer.commit());
+    }
+    {
+        // The array is still open
+        CatalogWriter writer(path);
+        writer.beginArray();
+        writer.append(MakeBuilding(2));
+        REQUIRE_FALSE(writer.commit());
+    }
+    {
+        // Dropped without a commit
+        CatalogWriter writer(path);
+        writer.beginArray();
+        writer.endArray();
+    }
+
+    REQUIRE_FALSE(fs::exists(fs::path(path) += ".tmp"));
+    RequireLoadsAs(path, previous);
+}
@@ -0,0 +1,125 @@
+#include <exemplar_scan.hpp>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+    constexpr uint32_t kExemplarTypeId = 0x00000010;
+
+    void AppendU32(std::vector<uint8_t>& out, const uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void AppendU16(std::vector<uint8_t>& out, const uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    std::vector<uint8_t> Header(const std::string_view signature, const uint32_t parentInstance,
+                                const uint32_t propertyCount) {
+        std::vector<uint8_t> out(signature.begin(), signature.end());
+        AppendU32(out, 0x05342861);
+        AppendU32(out, 0x12345678);
+        AppendU32(out, parentInstance);
+        AppendU32(out, propertyCount);
+        return out;
+    }
+
+    void AppendPropertyHeader(std::vector<uint8_t>& out, const uint32_t id, const uint16_t valueType,
+                              const bool isList) {
+        AppendU32(out, id);
+        AppendU16(out, valueType);
+        AppendU16(out, isList ? 0x0080 : 0x0000);
+        out.push_back(0);
+    }
+
+    // An exemplar with a string name, a Uint32 list and a single Uint32 Exemplar Type, in that order
+    std::vector<uint8_t> BuildSample(const uint32_t exemplarType) {
+        auto out = Header("EQZB1###", 0xAABBCCDD, 3);
+        AppendPropertyHeader(out, 0x00000020, 0x0C00, true);
+        AppendU32(out, 5);
+        for (const char c : std::string_view("Plaza")) {
+            out.push_back(static_cast<uint8_t>(c));
+        }
+        AppendPropertyHeader(out, 0x88EDC900, 0x0300, true);
+        AppendU32(out, 2);
+        AppendU32(out, 7);
+        AppendU32(out, 8);
+        AppendPropertyHeader(out, kExemplarTypeId, 0x0300, false);
+        AppendU32(out, exemplarType);
+        return out;
+    }
+}
+
+TEST_CASE("ScanExemplarProperty reads one property past the others", "[exemplar]") {
+    const auto bytes = BuildSample(0x02);
+    const auto scan = ScanExemplarProperty(bytes, kExemplarTypeId);
+    REQUIRE(scan);
+    REQUIRE(scan->found);
+    REQUIRE(scan->value == 0x02u);
+    REQUIRE(scan->parent[0] == 0x05342861u);
+    REQUIRE(scan->parent[1] == 0x12345678u);
+    REQUIRE(scan->parent[2] == 0xAABBCCDDu);
+
+    const auto list = ScanExemplarProperty(bytes, 0x88EDC900);
+    REQUIRE(list);
+    REQUIRE(list->value == 7u);
+
+    const auto missing = ScanExemplarProperty(bytes, 0x99);
+    REQUIRE(missing);
+    REQUIRE_FALSE(missing->found);
+    REQUIRE_FALSE(missing->value);
+}
+
+TEST_CASE("ScanExemplarProperty takes the first of repeated properties and reads small integers",
+          "[exemplar]") {
+    auto bytes = Header("CQZB1###", 0, 3);
+    AppendPropertyHeader(bytes, kExemplarTypeId, 0x0100, false);
+    bytes.push_back(0x0F);
+    AppendPropertyHeader(bytes, kExemplarTypeId, 0x0300, false);
+    AppendU32(bytes, 0x1E);
+    AppendPropertyHeader(bytes, 0x30, 0x0200, true);
+    AppendU32(bytes, 0);
+
+    const auto scan = ScanExemplarProperty(bytes, kExemplarTypeId);
+    REQUIRE(scan);
+    REQUIRE(scan->value == 0x0Fu);
+    REQUIRE(scan->parent[2] == 0u);
+
+    const auto empty = ScanExemplarProperty(bytes, 0x30);
+    REQUIRE(empty);
+    REQUIRE(empty->found);
+    REQUIRE_FALSE(empty->value);
+}
+
+TEST_CASE("ScanExemplarProperty leaves text, malformed and non-integer entries to a full load", "[exemplar]") {
+    auto text = BuildSample(0x02);
+    text[3] = 'T';
+    REQUIRE_FALSE(ScanExemplarProperty(text, kExemplarTypeId));
+
+    const auto bytes = BuildSample(0x02);
+    for (size_t size : {size_t{0}, size_t{23}, size_t{30}, bytes.size() - 1}) {
+        REQUIRE_FALSE(ScanExemplarProperty(std::span(bytes).first(size), kExemplarTypeId));
+    }
+
+    auto hugeList = Header("EQZB1###", 0, 1);
+    AppendPropertyHeader(hugeList, 0x20, 0x0300, true);
+    AppendU32(hugeList, 0xFFFFFFFF);
+    REQUIRE_FALSE(ScanExemplarProperty(hugeList, kExemplarTypeId));
+
+    auto floatType = Header("EQZB1###", 0, 1);
+    AppendPropertyHeader(floatType, kExemplarTypeId, 0x0900, false);
+    AppendU32(floatType, 0);
+    REQUIRE_FALSE(ScanExemplarProperty(floatType, kExemplarTypeId));
+
+    auto unknownType = Header("EQZB1###", 0, 1);
+    AppendPropertyHeader(unknownType, 0x20, 0x0500, false);
+    AppendU32(unknownType, 0);
+    REQUIRE_FALSE(ScanExemplarProperty(unknownType, kExemplarTypeId));
+}
@@ -0,0 +1,51 @@
+#include <index.hpp>
+#include <rfl/cbor.hpp>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("PluginIndex CBOR serialization and deserialization", "[cbor][index]") {
+    PluginIndex original;
+    original.version = 1;
+    original.buildTime = rfl::Timestamp<"%FT%TZ">("2024-05-01T12:30:00Z");
+    original.pluginsDirectory = "C:/Users/Mayor/Documents/SimCity 4/Plugins";
+    original.cacheSignature = "1.0.0;render=0;size=44";
+    original.outputs = {"lots.cbor", "props.cbor", "lot_thumbnails.bin"};
+
+    PluginFileInfo file;
+    file.filePath = "C:/Users/Mayor/Documents/SimCity 4/Plugins/BSC/lots.dat";
+    file.fileSize = 123456789012ull;
+    file.lastModified = rfl::Timestamp<"%FT%TZ">("2023-11-20T08:15:42Z");
+    file.resourceCount = 2;
+    file.lastWriteTicks = -133456789012345678ll;
+    file.tgis = {0x6534284Au, 0xA8FBD372u, 0x12345678u, 0x05342861u, 0xB03697D1u, 0xFFFFFFFFu};
+    original.files.push_back(file);
+
+    PluginFileInfo emptyFile;
+    emptyFile.filePath = "C:/Users/Mayor/Documents/SimCity 4/Plugins/readme.dat";
+    emptyFile.fileSize = 0;
+    emptyFile.resourceCount = 0;
+    original.files.push_back(emptyFile);
+
+    auto cbor_bytes = rfl::cbor::write(original);
+    REQUIRE(!cbor_bytes.empty());
+
+    auto deserialized = rfl::cbor::read<PluginIndex>(cbor_bytes);
+    REQUIRE(deserialized);
+    REQUIRE(deserialized->version == original.version);
+    REQUIRE(deserialized->buildTime.str() == original.buildTime.str());
+    REQUIRE(deserialized->pluginsDirectory == original.pluginsDirectory);
+    REQUIRE(deserialized->cacheSignature == original.cacheSignature);
+    REQUIRE(deserialized->outputs == original.outputs);
+    REQUIRE(deserialized->files.size() == original.files.size());
+
+    for (size_t i = 0; i < original.files.size(); ++i) {
+        const auto& expected = original.files[i];
+        const auto& actual = deserialized->files[i];
+        REQUIRE(actual.filePath == expected.filePath);
+        REQUIRE(actual.fileSize == expected.fileSize);
+        REQUIRE(actual.resourceCount == expected.resourceCount);
+        REQUIRE(actual.lastWriteTicks == expected.lastWriteTicks);
+        REQUIRE(actual.tgis == expected.tgis);
+    }
+}
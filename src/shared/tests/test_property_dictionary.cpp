@@ -0,0 +1,137 @@
+#include <property_dictionary.hpp>
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+    std::vector<std::byte> BuildSample() {
+        PropertyDictionaryBuilder builder;
+        builder.add(0x10, "Exemplar Type", PropertyValueType::UInt32, 1,
+                    {{"Buildings", 0x02}, {"Prop", 0x1E}, {"LotConfigurations", 0x10}, {"Flora", 0x0F}});
+        builder.add(0x20, "Exemplar Name", PropertyValueType::String, 1, {});
+        builder.add(0x88EDC900, "LotConfigPropertyLotObject", PropertyValueType::UInt32, -1, {});
+        builder.add(0x05, "Bulldoze Cost", PropertyValueType::SInt64, 1, {});
+        return builder.build();
+    }
+}
+
+TEST_CASE("PropertyDictionary finds properties by ID and by name", "[properties]") {
+    const auto bytes = BuildSample();
+    const auto dictionary = PropertyDictionary::fromBytes(bytes);
+    REQUIRE(dictionary);
+    REQUIRE(dictionary->size() == 4);
+
+    const auto lotObject = dictionary->find(0x88EDC900);
+    REQUIRE(lotObject);
+    REQUIRE(lotObject->name == "LotConfigPropertyLotObject");
+    REQUIRE(lotObject->type == PropertyValueType::UInt32);
+    REQUIRE(lotObject->count == -1);
+
+    const auto byName = dictionary->findByName("Bulldoze Cost");
+    REQUIRE(byName);
+    REQUIRE(byName->id == 0x05);
+    REQUIRE(byName->type == PropertyValueType::SInt64);
+
+    REQUIRE_FALSE(dictionary->find(0x11));
+    REQUIRE_FALSE(dictionary->find(0xFFFFFFFF));
+    REQUIRE_FALSE(dictionary->findByName("Exemplar"));
+    REQUIRE_FALSE(dictionary->findByName(""));
+}
+
+TEST_CASE("PropertyDictionary looks up options by name", "[properties]") {
+    const auto bytes = BuildSample();
+    const auto dictionary = PropertyDictionary::fromBytes(bytes);
+    REQUIRE(dictionary);
+
+    const auto exemplarType = dictionary->findByName("Exemplar Type");
+    REQUIRE(exemplarType);
+    REQUIRE(dictionary->optionValue(*exemplarType, "Buildings") == 0x02u);
+    REQUIRE(dictionary->optionValue(*exemplarType, "Flora") == 0x0Fu);
+    REQUIRE(dictionary->optionValue(*exemplarType, "Prop") == 0x1Eu);
+    REQUIRE_FALSE(dictionary->optionValue(*exemplarType, "Props"));
+    REQUIRE(dictionary->options(*exemplarType).size() == 4);
+
+    const auto exemplarName = dictionary->findByName("Exemplar Name");
+    REQUIRE(exemplarName);
+    REQUIRE_FALSE(dictionary->optionValue(*exemplarName, "Buildings"));
+    REQUIRE(dictionary->options(*exemplarName).empty());
+}
+
+TEST_CASE("PropertyDictionaryBuilder keeps the last definition of an ID, name or option", "[properties]") {
+    PropertyDictionaryBuilder builder;
+    builder.add(0x01, "Old Name", PropertyValueType::UInt8, 1, {{"A", 1}, {"A", 2}});
+    builder.add(0x01, "New Name", PropertyValueType::Bool, 2, {{"B", 3}});
+    builder.add(0x02, "Shared", PropertyValueType::UInt32, 1, {});
+    builder.add(0x03, "Shared", PropertyValueType::Float32, 1, {});
+    const auto bytes = builder.build();
+    const auto dictionary = PropertyDictionary::fromBytes(bytes);
+    REQUIRE(dictionary);
+
+    const auto redefined = dictionary->find(0x01);
+    REQUIRE(redefined);
+    REQUIRE(redefined->name == "New Name");
+    REQUIRE(redefined->type == PropertyValueType::Bool);
+    REQUIRE(redefined->count == 2);
+    REQUIRE_FALSE(dictionary->optionValue(*redefined, "A"));
+    REQUIRE(dictionary->optionValue(*redefined, "B") == 3u);
+
+    REQUIRE(dictionary->findByName("Shared")->id == 0x03);
+    REQUIRE(dictionary->findByName("Old Name")->id == 0x01);
+}
+
+TEST_CASE("PropertyDictionary rejects truncated or foreign files", "[properties]") {
+    const auto bytes = BuildSample();
+    REQUIRE_FALSE(PropertyDictionary::fromBytes(std::span(bytes).first(bytes.size() - 1)));
+    REQUIRE_FALSE(PropertyDictionary::fromBytes(std::span(bytes).first(16)));
+
+    auto foreign = bytes;
+    foreign[0] = std::byte{'X'};
+    REQUIRE_FALSE(PropertyDictionary::fromBytes(foreign));
+
+    auto badName = bytes;
+    // Name length of the first property, past the end of the string table
+    badName[32 + 8] = std::byte{0xFF};
+    badName[32 + 9] = std::byte{0xFF};
+    REQUIRE_FALSE(PropertyDictionary::fromBytes(badName));
+
+    PropertyDictionaryBuilder empty;
+    const auto emptyBytes = empty.build();
+    const auto emptyDictionary = PropertyDictionary::fromBytes(emptyBytes);
+    REQUIRE(emptyDictionary);
+    REQUIRE(emptyDictionary->size() == 0);
+    REQUIRE_FALSE(emptyDictionary->findByName("Exemplar Type"));
+}
+
+TEST_CASE("ParsePropertyValueType reads the XML type names", "[properties]") {
+    REQUIRE(ParsePropertyValueType("Uint8") == PropertyValueType::UInt8);
+    REQUIRE(ParsePropertyValueType("Sint64") == PropertyValueType::SInt64);
+    REQUIRE(ParsePropertyValueType("String") == PropertyValueType::String);
+    REQUIRE(ParsePropertyValueType("Unknown") == PropertyValueType::UInt32);
+}
+
+TEST_CASE("Property XML values parse the same for the loader and the converter", "[properties]") {
+    REQUIRE(ParsePropertyId("0x88EDC900") == 0x88EDC900u);
+    REQUIRE(ParsePropertyId("88edc900") == 0x88EDC900u);
+    REQUIRE(ParsePropertyId(" 0X10\t") == 0x10u);
+    REQUIRE_FALSE(ParsePropertyId(""));
+    REQUIRE_FALSE(ParsePropertyId("0x"));
+    REQUIRE_FALSE(ParsePropertyId("Item"));
+    REQUIRE_FALSE(ParsePropertyId("0x10 0x20"));
+    REQUIRE_FALSE(ParsePropertyId("0x100000000"));
+
+    REQUIRE(ParsePropertyOptionValue("0x1E") == 0x1Eu);
+    REQUIRE(ParsePropertyOptionValue("30") == 30u);
+    REQUIRE(ParsePropertyOptionValue(" 4294967295 ") == 0xFFFFFFFFu);
+    REQUIRE_FALSE(ParsePropertyOptionValue("1E"));
+    REQUIRE_FALSE(ParsePropertyOptionValue("Col:0"));
+    REQUIRE_FALSE(ParsePropertyOptionValue("-1"));
+    REQUIRE_FALSE(ParsePropertyOptionValue(""));
+
+    REQUIRE(ParsePropertyCount(std::nullopt) == 1);
+    REQUIRE(ParsePropertyCount("") == 1);
+    REQUIRE(ParsePropertyCount("4") == 4);
+    REQUIRE(ParsePropertyCount("-1") == -1);
+    REQUIRE(ParsePropertyCount("many") == 1);
+}
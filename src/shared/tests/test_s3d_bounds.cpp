@@ -0,0 +1,144 @@
+#include <s3d_bounds.hpp>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+    struct Vertex {
+        float x;
+        float y;
+        float z;
+    };
+
+    void AppendU32(std::vector<uint8_t>& out, const uint32_t value) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            out.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+
+    void AppendU16(std::vector<uint8_t>& out, const uint16_t value) {
+        out.push_back(static_cast<uint8_t>(value));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+    }
+
+    void AppendF32(std::vector<uint8_t>& out, const float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        AppendU32(out, bits);
+    }
+
+    void AppendTag(std::vector<uint8_t>& out, const std::string_view tag) {
+        out.insert(out.end(), tag.begin(), tag.end());
+    }
+
+    void PatchU32(std::vector<uint8_t>& out, const size_t offset, const uint32_t value) {
+        for (size_t i = 0; i < 4; ++i) {
+            out[offset + i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    // A v1.5 model with the given vertex buffers, each in format 0x80004001, followed by an INDX section
+    // the reader has to skip
+    std::vector<uint8_t> BuildModel(const std::vector<std::vector<Vertex>>& buffers,
+                                    const uint16_t minorVersion = 5) {
+        std::vector<uint8_t> out;
+        AppendTag(out, "3DMD");
+        AppendU32(out, 0); // File size, patched below
+        AppendTag(out, "HEAD");
+        AppendU32(out, 12);
+        AppendU16(out, 1);
+        AppendU16(out, minorVersion);
+
+        const size_t vertStart = out.size();
+        AppendTag(out, "VERT");
+        AppendU32(out, 0); // Section size, patched below
+        AppendU32(out, static_cast<uint32_t>(buffers.size()));
+        for (const auto& buffer : buffers) {
+            AppendU16(out, 0);
+            AppendU16(out, static_cast<uint16_t>(buffer.size()));
+            AppendU32(out, 0x80004001);
+            for (const auto& [x, y, z] : buffer) {
+                AppendF32(out, x);
+                AppendF32(out, y);
+                AppendF32(out, z);
+                AppendU32(out, 0xFFFFFFFF); // Colour
+                AppendF32(out, 0.25f);      // Texture coordinate
+                AppendF32(out, 0.75f);
+            }
+        }
+        PatchU32(out, vertStart + 4, static_cast<uint32_t>(out.size() - vertStart));
+
+        AppendTag(out, "INDX");
+        AppendU32(out, 12);
+        AppendU32(out, 0);
+        PatchU32(out, 4, static_cast<uint32_t>(out.size()));
+        return out;
+    }
+}
+
+TEST_CASE("ReadS3DBounds spans the vertices of every buffer", "[s3d]") {
+    const auto model = BuildModel({
+        {{-1.0f, 0.0f, 2.0f}, {3.0f, 5.0f, -4.0f}},
+        {{0.5f, -2.5f, 1.0f}},
+    });
+
+    const auto bounds = ReadS3DBounds(model);
+    REQUIRE(bounds);
+    REQUIRE(*bounds == std::array{-1.0f, 3.0f, -2.5f, 5.0f, -4.0f, 2.0f});
+}
+
+TEST_CASE("ReadS3DBounds defers to a full decode for what it does not understand", "[s3d]") {
+    const std::vector<std::vector<Vertex>> buffers = {{{1.0f, 2.0f, 3.0f}}};
+    REQUIRE(ReadS3DBounds(BuildModel(buffers)));
+
+    SECTION("Not an S3D model") {
+        auto model = BuildModel(buffers);
+        model[0] = 'X';
+        REQUIRE_FALSE(ReadS3DBounds(model));
+    }
+
+    SECTION("A version before vertex formats were 32-bit") {
+        REQUIRE_FALSE(ReadS3DBounds(BuildModel(buffers, 3)));
+    }
+
+    SECTION("An unknown vertex format") {
+        auto model = BuildModel(buffers);
+        PatchU32(model, 8 + 12 + 12 + 4, 0x00000001);
+        REQUIRE_FALSE(ReadS3DBounds(model));
+    }
+
+    SECTION("Buffers that do not fill the section, as a wrong stride would leave them") {
+        auto model = BuildModel(buffers);
+        PatchU32(model, 8 + 12 + 4, 12 + 8 + 24 + 4);
+        REQUIRE_FALSE(ReadS3DBounds(model));
+    }
+
+    SECTION("A section too small for its own buffer count") {
+        auto model = BuildModel(buffers);
+        for (const uint32_t size : {0u, 8u, 11u}) {
+            CAPTURE(size);
+            PatchU32(model, 8 + 12 + 4, size);
+            REQUIRE_FALSE(ReadS3DBounds(model));
+            // The same declared size with nothing after the section
+            REQUIRE_FALSE(ReadS3DBounds(std::span(model.data(), 8 + 12 + 12)));
+        }
+    }
+
+    SECTION("A truncated entry") {
+        const auto model = BuildModel(buffers);
+        for (size_t size = 0; size < 8 + 12 + 12 + 8 + 24; ++size) {
+            CAPTURE(size);
+            REQUIRE_FALSE(ReadS3DBounds(std::span(model.data(), size)));
+        }
+    }
+
+    SECTION("No vertices") {
+        REQUIRE_FALSE(ReadS3DBounds(BuildModel({})));
+        REQUIRE_FALSE(ReadS3DBounds(BuildModel({{}})));
+    }
+}
@@ -1,51 +1,19 @@
-#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <optional>
 
 #include <rfl/Hex.hpp>
-#include <rfl/Rename.hpp>
 #include <rfl/json.hpp>
-#include <rfl/xml.hpp>
 #include "../src/shared/properties.hpp"
-
-// Structures matching the new_properties.xml format
-// <ExemplarProperties>
-//   <PROPERTIES>
-//     <PROPERTY ID="..." Name="...">
-//       <OPTION Value="..." Name="..."/>
-//     </PROPERTY>
-//   </PROPERTIES>
-// </ExemplarProperties>
-
-namespace XmlFormat {
-
-struct Option {
-    rfl::Rename<"Value", std::string> value;  // Parse as string - can be hex, decimal, or symbolic
-    rfl::Rename<"Name", std::string> name;
-};
-
-struct Property {
-    rfl::Rename<"ID", std::string> id;
-    rfl::Rename<"Name", std::string> name;
-    rfl::Rename<"OPTION", std::vector<Option>> options;
-};
-
-struct Properties {
-    rfl::Rename<"PROPERTY", std::vector<Property>> properties;
-};
-
-struct ExemplarProperties {
-    rfl::Rename<"PROPERTIES", Properties> properties;
-};
-
-} // namespace XmlFormat
+#include "../src/shared/property_dictionary.hpp"
+#include "../src/shared/property_xml.hpp"
 
 int main(int argc, char* argv[]) {
     try {
         if (argc < 2) {
-            std::cerr << "Usage: " << argv[0] << " <input.xml> [output.json]\n";
+            std::cerr << "Usage: " << argv[0] << " <input.xml> [output.json | output.bin]\n"
+                      << "A .bin output is the binary dictionary the CLI loads instead of the XML.\n";
             return 1;
         }
 
@@ -65,87 +33,30 @@ int main(int argc, char* argv[]) {
 
         std::cout << "File size: " << xmlContent.size() << " bytes\n";
 
-        // Read XML using reflect-cpp
-        auto xmlData = rfl::xml::read<XmlFormat::ExemplarProperties>(xmlContent);
-        if (!xmlData) {
-            std::cerr << "XML parsing failed: " << xmlData.error().what() << "\n";
-            throw std::runtime_error("Failed to parse XML: " + xmlData.error().what());
+        // Read XML through the same reader as PropertyMapper::loadFromXml
+        const auto definitions = ReadPropertyXml(xmlContent);
+        if (!definitions) {
+            std::cerr << "XML parsing failed: " << definitions.error().what() << "\n";
+            throw std::runtime_error("Failed to parse XML: " + definitions.error().what());
         }
 
         std::cout << "XML parsed successfully\n";
-        std::cout << "Properties found: " << xmlData->properties().properties().size() << "\n";
-
-        // Helper to parse hex string (property IDs)
-        auto parseHex = [](const std::string& hex) -> std::optional<uint32_t> {
-            if (hex.empty()) return std::nullopt;
-
-            try {
-                // Remove any whitespace
-                std::string cleaned = hex;
-                cleaned.erase(std::remove_if(cleaned.begin(), cleaned.end(), ::isspace), cleaned.end());
-
-                if (cleaned.empty()) return std::nullopt;
-
-                // Parse as hex
-                return static_cast<uint32_t>(std::stoul(cleaned, nullptr, 16));
-            } catch (const std::exception& e) {
-                std::cerr << "Warning: Failed to parse property ID '" << hex << "': " << e.what() << "\n";
-                return std::nullopt;
-            }
-        };
-
-        // Helper to parse option value (can be hex, decimal, or symbolic)
-        auto parseOptionValue = [](const std::string& value) -> std::optional<uint32_t> {
-            if (value.empty()) return std::nullopt;
-
-            // Skip symbolic values like "Col:0"
-            if (value.find(':') != std::string::npos) {
-                return std::nullopt;
-            }
-
-            // Remove whitespace
-            std::string cleaned = value;
-            cleaned.erase(std::remove_if(cleaned.begin(), cleaned.end(), ::isspace), cleaned.end());
-
-            if (cleaned.empty()) return std::nullopt;
-
-            try {
-                // Try to parse as hex (0x prefix) or decimal
-                if (cleaned.find("0x") == 0 || cleaned.find("0X") == 0) {
-                    return static_cast<uint32_t>(std::stoul(cleaned, nullptr, 16));
-                } else {
-                    return static_cast<uint32_t>(std::stoul(cleaned, nullptr, 10));
-                }
-            } catch (const std::exception& e) {
-                // Silently skip unparseable values
-                return std::nullopt;
-            }
-        };
 
         // Convert to simplified format
         PropertiesData data;
-        for (const auto& xmlProp : xmlData->properties().properties()) {
-            auto propId = parseHex(xmlProp.id());
-            if (!propId) {
-                // Skip properties with unparseable IDs
-                continue;
-            }
-
+        PropertyDictionaryBuilder dictionary;
+        for (const auto& definition : *definitions) {
             PropertyDef prop;
-            prop.id = rfl::Hex(*propId);
-            prop.name = xmlProp.name();
-
-            for (const auto& xmlOpt : xmlProp.options()) {
-                auto optValue = parseOptionValue(xmlOpt.value());
-                if (optValue) {
-                    PropertyOption opt;
-                    opt.value = rfl::Hex(*optValue);
-                    opt.name = xmlOpt.name();
-                    prop.options.push_back(std::move(opt));
-                }
-                // Skip symbolic/unparseable options
+            prop.id = rfl::Hex(definition.id);
+            prop.name = definition.name;
+            for (const auto& [name, value] : definition.options) {
+                PropertyOption opt;
+                opt.value = rfl::Hex(value);
+                opt.name = name;
+                prop.options.push_back(std::move(opt));
             }
 
+            dictionary.add(definition.id, definition.name, definition.type, definition.count, definition.options);
             data.properties.push_back(std::move(prop));
         }
 
@@ -155,14 +66,28 @@ int main(int argc, char* argv[]) {
                       << std::dec << " Name=" << data.properties[0].name << "\n";
         }
 
-        // Write JSON with pretty printing
-        std::ofstream output(outputPath);
-        if (!output) {
-            throw std::runtime_error("Failed to open output: " + outputPath.string());
+        if (outputPath.extension() == ".bin") {
+            const auto bytes = dictionary.build();
+            std::ofstream output(outputPath, std::ios::binary);
+            if (!output) {
+                throw std::runtime_error("Failed to open output: " + outputPath.string());
+            }
+            output.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            if (!output) {
+                throw std::runtime_error("Failed to write output: " + outputPath.string());
+            }
+            std::cout << "Binary dictionary: " << bytes.size() << " bytes\n";
         }
+        else {
+            // Write JSON with pretty printing
+            std::ofstream output(outputPath);
+            if (!output) {
+                throw std::runtime_error("Failed to open output: " + outputPath.string());
+            }
 
-        rfl::json::write(data, output);
-        output.close();
+            rfl::json::write(data, output);
+            output.close();
+        }
 
         std::cout << "Conversion complete!\n";
         std::cout << "Output written to: " << outputPath << "\n";
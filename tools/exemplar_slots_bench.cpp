@@ -0,0 +1,219 @@
+// Compares the ways ExemplarParser has looked up the properties it reads, on synthetic exemplars:
+// one FindProperty call per wanted property plus a probe of every ID in the lot object range, as the
+// parsers did before, a binary search over the wanted IDs, and the single walk into slots through an
+// open-addressed table that projectProperties_ does now.
+//
+// The exemplars are synthetic and FindProperty is whatever the linked DBPFKit implements, so the times
+// are indicative of how the lookups compare, not of what a scan of real plugins spends on them.
+//
+// Usage: exemplar_slots_bench [exemplars] [repeats]
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ExemplarReader.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kLotObjectsStart = 0x88EDC900u;
+    constexpr uint32_t kLotObjectsEnd = 0x88EDCFF0u;
+    // As ExemplarParser::kSlotTableSize and slotTableIndex_
+    constexpr size_t kSlotTableSize = 128;
+    constexpr uint8_t kNoSlot = 0xFF;
+
+    size_t SlotTableIndex(const uint32_t propertyId) {
+        return ((propertyId * 0x9E3779B1u) >> 16) % kSlotTableSize;
+    }
+
+    // 24 properties from the mapper and the six RKT IDs, as ExemplarParser's slots
+    std::vector<uint32_t> MakeWantedIds() {
+        std::mt19937 rng(99);
+        std::uniform_int_distribution<uint32_t> any;
+        std::vector<uint32_t> ids;
+        for (int i = 0; i < 24; ++i) {
+            ids.push_back(any(rng));
+        }
+        for (uint32_t i = 0; i < 6; ++i) {
+            ids.push_back(0x27812820u + i);
+        }
+        return ids;
+    }
+
+    // Exemplars of 20 to 60 properties, a third of them wanted. Lot configs also carry 2 to 40 lot
+    // objects, in file order rather than ID order.
+    std::vector<Exemplar::Record> MakeExemplars(const size_t count, const std::vector<uint32_t>& wanted,
+                                                const bool lotConfigs) {
+        std::mt19937 rng(4711);
+        std::uniform_int_distribution<uint32_t> any;
+        std::uniform_int_distribution<size_t> propertyCount(20, 60);
+        std::uniform_int_distribution<size_t> lotObjectCount(2, 40);
+        std::uniform_int_distribution<size_t> wantedIndex(0, wanted.size() - 1);
+
+        std::vector<Exemplar::Record> exemplars(count);
+        for (auto& exemplar : exemplars) {
+            const size_t properties = propertyCount(rng);
+            for (size_t i = 0; i < properties; ++i) {
+                Exemplar::Property property;
+                property.id = i % 3 == 0 ? wanted[wantedIndex(rng)] : any(rng);
+                exemplar.properties.push_back(std::move(property));
+            }
+            if (lotConfigs) {
+                const size_t lotObjects = lotObjectCount(rng);
+                for (size_t i = 0; i < lotObjects; ++i) {
+                    Exemplar::Property property;
+                    property.id = kLotObjectsStart + any(rng) % (kLotObjectsEnd - kLotObjectsStart + 1);
+                    exemplar.properties.push_back(std::move(property));
+                }
+            }
+        }
+        return exemplars;
+    }
+
+    uint64_t ByFindProperty(const Exemplar::Record& exemplar, const std::vector<uint32_t>& wanted,
+                            const bool lotConfig) {
+        uint64_t checksum = 0;
+        for (const auto id : wanted) {
+            if (const auto* property = exemplar.FindProperty(id)) {
+                checksum += property->id;
+            }
+        }
+        if (lotConfig) {
+            for (uint32_t id = kLotObjectsStart; id <= kLotObjectsEnd; ++id) {
+                if (const auto* property = exemplar.FindProperty(id)) {
+                    checksum += property->id;
+                }
+            }
+        }
+        return checksum;
+    }
+
+    // Sums the IDs found, counting each lot object ID once after sorting them as lotObjects_ does, so all
+    // three lookups have to agree
+    uint64_t Checksum(const std::array<const Exemplar::Property*, 64>& slots, const size_t slotCount,
+                      std::vector<const Exemplar::Property*>& lotObjects, const bool lotConfig) {
+        uint64_t checksum = 0;
+        for (size_t slot = 0; slot < slotCount; ++slot) {
+            if (slots[slot]) {
+                checksum += slots[slot]->id;
+            }
+        }
+        if (lotConfig) {
+            std::ranges::stable_sort(lotObjects, {}, &Exemplar::Property::id);
+            const auto duplicates = std::ranges::unique(lotObjects, {}, &Exemplar::Property::id);
+            lotObjects.erase(duplicates.begin(), duplicates.end());
+            for (const auto* property : lotObjects) {
+                checksum += property->id;
+            }
+        }
+        return checksum;
+    }
+
+    uint64_t ByBinarySearch(const Exemplar::Record& exemplar,
+                            const std::vector<std::pair<uint32_t, uint8_t>>& sortedWanted, const size_t slotCount,
+                            const bool lotConfig) {
+        std::array<const Exemplar::Property*, 64> slots{};
+        std::vector<const Exemplar::Property*> lotObjects;
+        for (const auto& property : exemplar.properties) {
+            if (property.id >= kLotObjectsStart && property.id <= kLotObjectsEnd) {
+                lotObjects.push_back(&property);
+            }
+            const auto it = std::ranges::lower_bound(sortedWanted, property.id, {},
+                                                     &std::pair<uint32_t, uint8_t>::first);
+            if (it != sortedWanted.end() && it->first == property.id && !slots[it->second]) {
+                slots[it->second] = &property;
+            }
+        }
+        return Checksum(slots, slotCount, lotObjects, lotConfig);
+    }
+
+    uint64_t BySlotTable(const Exemplar::Record& exemplar,
+                         const std::array<std::pair<uint32_t, uint8_t>, kSlotTableSize>& table, const size_t slotCount,
+                         const bool lotConfig) {
+        std::array<const Exemplar::Property*, 64> slots{};
+        std::vector<const Exemplar::Property*> lotObjects;
+        for (const auto& property : exemplar.properties) {
+            if (property.id >= kLotObjectsStart && property.id <= kLotObjectsEnd) {
+                lotObjects.push_back(&property);
+            }
+            for (size_t index = SlotTableIndex(property.id); table[index].second != kNoSlot;
+                 index = (index + 1) % kSlotTableSize) {
+                auto& slot = slots[table[index].second];
+                if (table[index].first == property.id && !slot) {
+                    slot = &property;
+                }
+            }
+        }
+        return Checksum(slots, slotCount, lotObjects, lotConfig);
+    }
+
+    double Microseconds(const Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t exemplarCount = argc > 1 ? std::stoull(argv[1]) : 20'000;
+    const int repeats = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    const auto wanted = MakeWantedIds();
+    std::vector<std::pair<uint32_t, uint8_t>> sortedWanted;
+    std::array<std::pair<uint32_t, uint8_t>, kSlotTableSize> table;
+    table.fill({0, kNoSlot});
+    for (size_t slot = 0; slot < wanted.size(); ++slot) {
+        sortedWanted.emplace_back(wanted[slot], static_cast<uint8_t>(slot));
+        size_t index = SlotTableIndex(wanted[slot]);
+        while (table[index].second != kNoSlot) {
+            index = (index + 1) % kSlotTableSize;
+        }
+        table[index] = {wanted[slot], static_cast<uint8_t>(slot)};
+    }
+    std::ranges::sort(sortedWanted);
+
+    std::cout << "Exemplars: " << exemplarCount << ", wanted properties: " << wanted.size()
+              << ", best of " << repeats << " runs\n"
+              << "Indicative only: synthetic exemplars, with FindProperty from the linked DBPFKit\n";
+
+    for (const bool lotConfigs : {false, true}) {
+        const auto exemplars = MakeExemplars(exemplarCount, wanted, lotConfigs);
+        const auto time = [&](const auto& lookup) {
+            uint64_t checksum = 0;
+            auto best = Clock::duration::max();
+            for (int run = 0; run < repeats; ++run) {
+                checksum = 0;
+                const auto start = Clock::now();
+                for (const auto& exemplar : exemplars) {
+                    checksum += lookup(exemplar);
+                }
+                best = std::min(best, Clock::now() - start);
+            }
+            return std::pair{Microseconds(best) / static_cast<double>(exemplars.size()), checksum};
+        };
+
+        const auto [findTime, findChecksum] = time([&](const Exemplar::Record& exemplar) {
+            return ByFindProperty(exemplar, wanted, lotConfigs);
+        });
+        const auto [searchTime, searchChecksum] = time([&](const Exemplar::Record& exemplar) {
+            return ByBinarySearch(exemplar, sortedWanted, wanted.size(), lotConfigs);
+        });
+        const auto [tableTime, tableChecksum] = time([&](const Exemplar::Record& exemplar) {
+            return BySlotTable(exemplar, table, wanted.size(), lotConfigs);
+        });
+
+        std::cout << (lotConfigs ? "Lot configs" : "Other exemplars") << ": FindProperty " << findTime
+                  << " us, binary search " << searchTime << " us, slot table " << tableTime << " us per exemplar\n";
+        if (findChecksum != searchChecksum || findChecksum != tableChecksum) {
+            std::cerr << "Lookup results differ: " << findChecksum << ", " << searchChecksum << ", "
+                      << tableChecksum << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Times the thumbnail pixel kernels with every instruction set this CPU supports, on renders of the size
+// the cache builder post-processes.
+//
+// Usage: pixel_kernels_bench [size] [iterations]
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "app/PixelKernels.hpp"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using thumb::PixelIsa;
+    using thumb::PixelKernels;
+
+    // A render with a transparent border around an opaque silhouette, as FitThumbnail crops it
+    std::vector<uint8_t> MakeRender(const uint32_t size) {
+        std::mt19937 rng(4242);
+        std::uniform_int_distribution<int> byte(0, 255);
+        std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4, 0);
+        const uint32_t margin = size / 5;
+        for (uint32_t y = margin; y < size - margin; ++y) {
+            for (uint32_t x = margin; x < size - margin; ++x) {
+                auto* pixel = pixels.data() + (static_cast<size_t>(y) * size + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    pixel[c] = static_cast<uint8_t>(byte(rng));
+                }
+                pixel[3] = 255;
+            }
+        }
+        return pixels;
+    }
+
+    template<typename Fn>
+    double NanosecondsPerPixel(const size_t pixelCount, const size_t iterations, Fn&& fn) {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        return elapsed / static_cast<double>(iterations * pixelCount);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const auto size = static_cast<uint32_t>(argc > 1 ? std::stoul(argv[1]) : 352);
+    const size_t iterations = argc > 2 ? std::stoull(argv[2]) : 2'000;
+    const size_t pixelCount = static_cast<size_t>(size) * size;
+
+    const auto render = MakeRender(size);
+    auto overlay = MakeRender(size);
+    for (size_t i = 3; i < overlay.size(); i += 4) {
+        overlay[i] = static_cast<uint8_t>(i * 7);
+    }
+    const uint32_t half = size / 2;
+    std::vector<uint8_t> scratch(render.size());
+    uint64_t checksum = 0;
+
+    std::cout << size << "x" << size << " px, " << iterations << " iterations, ns/pixel\n";
+    for (const auto requested : {PixelIsa::Scalar, PixelIsa::Sse2, PixelIsa::Avx2}) {
+        if (requested > PixelKernels::supportedIsa()) {
+            continue;
+        }
+        const auto isa = PixelKernels::setIsa(requested);
+
+        const auto swap = NanosecondsPerPixel(pixelCount, iterations, [&] {
+            PixelKernels::swapRedBlue(render.data(), scratch.data(), pixelCount);
+            checksum += scratch[pixelCount * 2];
+        });
+        const auto blend = NanosecondsPerPixel(pixelCount, iterations, [&] {
+            scratch = render;
+            PixelKernels::blendOverlay(scratch.data(), overlay.data(), pixelCount);
+            checksum += scratch[pixelCount * 2];
+        });
+        const auto bounds = NanosecondsPerPixel(pixelCount, iterations, [&] {
+            const auto box = PixelKernels::findAlphaBounds(render.data(), static_cast<int>(size),
+                                                           static_cast<int>(size), 12);
+            checksum += box ? static_cast<uint64_t>(box->maxX) : 0;
+        });
+        const auto resize = NanosecondsPerPixel(static_cast<size_t>(half) * half, iterations, [&] {
+            PixelKernels::resizeArea(render.data(), size, size, scratch.data(), half, half,
+                                     static_cast<size_t>(half) * 4);
+            checksum += scratch[half];
+        });
+
+        std::cout << thumb::PixelIsaName(isa) << ": swapRedBlue " << swap << ", blendOverlay " << blend
+                  << ", findAlphaBounds " << bounds << ", resizeArea " << resize << "\n";
+    }
+
+    // Keeps the loops from being optimised away
+    std::cout << "checksum " << checksum << "\n";
+    return 0;
+}
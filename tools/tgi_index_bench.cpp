@@ -0,0 +1,163 @@
+// Compares the flat TgiIndex against the map of vectors it replaced, on a synthetic plugin index.
+//
+// Usage: tgi_index_bench [entries] [files] [lookups]
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "TGI.h"
+#include "app/TgiIndex.hpp"
+
+namespace {
+    std::atomic<uint64_t> gAllocatedBytes{0};
+    std::atomic<uint64_t> gAllocations{0};
+}
+
+void* operator new(const std::size_t size) {
+    gAllocatedBytes += size;
+    ++gAllocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using MapIndex = std::unordered_map<DBPF::Tgi, std::vector<uint32_t>, DBPF::TgiHash>;
+
+    constexpr uint32_t kTypes[] = {
+        0x6534284Au, // Exemplar
+        0x05342861u, // Cohort
+        0x5AD0E817u, // S3D
+        0x7AB50E44u, // FSH
+        0x2026960Bu, // LTEXT
+        0x856DDBACu, // PNG
+    };
+
+    // Builds entries in load order. Most TGIs are unique; about one in twelve overrides an entry of
+    // an earlier file, as mods and patches do.
+    std::vector<TgiIndex::Entry> MakeEntries(const size_t entryCount, const uint32_t fileCount) {
+        std::mt19937 rng(12345);
+        std::uniform_int_distribution<uint32_t> any;
+        std::uniform_int_distribution<size_t> typeDist(0, std::size(kTypes) - 1);
+        std::uniform_int_distribution<uint32_t> groupDist(0, 63);
+
+        std::vector<TgiIndex::Entry> entries;
+        entries.reserve(entryCount);
+        const size_t perFile = std::max<size_t>(1, entryCount / fileCount);
+        for (size_t i = 0; i < entryCount; ++i) {
+            const auto fileIndex = static_cast<uint32_t>(std::min<size_t>(i / perFile, fileCount - 1));
+            if (i > 0 && any(rng) % 12 == 0) {
+                const auto& earlier = entries[std::uniform_int_distribution<size_t>(0, i - 1)(rng)];
+                entries.push_back({earlier.tgi, fileIndex});
+                continue;
+            }
+            const DBPF::Tgi tgi{kTypes[typeDist(rng)], 0xA0000000u + groupDist(rng), any(rng)};
+            entries.push_back({tgi, fileIndex});
+        }
+        return entries;
+    }
+
+    double Milliseconds(const Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t entryCount = argc > 1 ? std::stoull(argv[1]) : 3'000'000;
+    const auto fileCount = static_cast<uint32_t>(argc > 2 ? std::stoul(argv[2]) : 20'000);
+    const size_t lookupCount = argc > 3 ? std::stoull(argv[3]) : 5'000'000;
+
+    const auto entries = MakeEntries(entryCount, fileCount);
+
+    // Half of the probes hit, half miss, as containsTgi calls for optional entries do
+    std::vector<DBPF::Tgi> probes;
+    probes.reserve(lookupCount);
+    std::mt19937 rng(777);
+    std::uniform_int_distribution<size_t> entryDist(0, entries.size() - 1);
+    for (size_t i = 0; i < lookupCount; ++i) {
+        auto tgi = entries[entryDist(rng)].tgi;
+        if (i % 2 == 1) {
+            tgi.instance = ~tgi.instance;
+        }
+        probes.push_back(tgi);
+    }
+
+    std::cout << "Entries: " << entries.size() << ", files: " << fileCount << ", lookups: " << lookupCount << "\n";
+
+    uint64_t mapChecksum = 0;
+    {
+        const auto bytesBefore = gAllocatedBytes.load();
+        const auto allocationsBefore = gAllocations.load();
+        const auto buildStart = Clock::now();
+        MapIndex map;
+        for (const auto& [tgi, fileIndex] : entries) {
+            map[tgi].push_back(fileIndex);
+        }
+        const auto buildTime = Clock::now() - buildStart;
+        const auto bytes = gAllocatedBytes.load() - bytesBefore;
+        const auto allocations = gAllocations.load() - allocationsBefore;
+
+        const auto lookupStart = Clock::now();
+        for (const auto& tgi : probes) {
+            if (const auto it = map.find(tgi); it != map.end()) {
+                mapChecksum += it->second.front() + it->second.size();
+            }
+        }
+        const auto lookupTime = Clock::now() - lookupStart;
+
+        std::cout << "unordered_map<Tgi, vector<uint32_t>>: " << map.size() << " keys, "
+                  << bytes / (1024 * 1024) << " MiB allocated in " << allocations << " allocations, build "
+                  << Milliseconds(buildTime) << " ms, " << Milliseconds(lookupTime) * 1e6 / lookupCount
+                  << " ns/lookup\n";
+    }
+
+    uint64_t flatChecksum = 0;
+    {
+        const auto bytesBefore = gAllocatedBytes.load();
+        const auto allocationsBefore = gAllocations.load();
+        const auto buildStart = Clock::now();
+        const TgiIndex index(entries);
+        const auto buildTime = Clock::now() - buildStart;
+        const auto bytes = gAllocatedBytes.load() - bytesBefore;
+        const auto allocations = gAllocations.load() - allocationsBefore;
+
+        const auto lookupAllocations = gAllocations.load();
+        const auto lookupStart = Clock::now();
+        for (const auto& tgi : probes) {
+            if (const auto files = index.find(tgi); !files.empty()) {
+                flatChecksum += files.front() + files.size();
+            }
+        }
+        const auto lookupTime = Clock::now() - lookupStart;
+
+        std::cout << "TgiIndex: " << index.size() << " keys, " << index.memoryBytes() / (1024 * 1024)
+                  << " MiB resident (" << bytes / (1024 * 1024) << " MiB allocated incl. build scratch) in "
+                  << allocations << " allocations, build " << Milliseconds(buildTime) << " ms, "
+                  << Milliseconds(lookupTime) * 1e6 / lookupCount << " ns/lookup, "
+                  << gAllocations.load() - lookupAllocations << " allocations during lookups\n";
+    }
+
+    if (mapChecksum != flatChecksum) {
+        std::cerr << "Lookup results differ: " << mapChecksum << " != " << flatChecksum << "\n";
+        return 1;
+    }
+    return 0;
+}